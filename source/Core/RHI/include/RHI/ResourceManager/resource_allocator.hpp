@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <iterator>
 
@@ -8,6 +10,7 @@
 #ifndef RESOURCE_ALLOCATOR_STATIC_ONLY
 #include "nodes/core/api.hpp"
 #endif
+#include "RHI/ResourceManager/resource_cache.hpp"
 #include "RHI/ShaderFactory/shader.hpp"
 #include "RHI/api.h"
 #include "RHI/internal/nvrhi_equality.hpp"
@@ -31,43 +34,72 @@ using desc = typename ResouceDesc<RESOURCE>::Desc;
 template<typename DESC>
 using resc = typename DescResouce<DESC>::Resource;
 
+// A larger buffer can serve a smaller request when everything else matches.
+// Buffers more than twice the requested size are not used, to keep the waste
+// bounded.
+template<>
+struct ResourceBestFit<nvrhi::BufferDesc> {
+    static constexpr bool supported = true;
+
+    static bool fits(
+        const nvrhi::BufferDesc& cached,
+        const nvrhi::BufferDesc& request)
+    {
+        if (cached.byteSize < request.byteSize ||
+            cached.byteSize > 2 * request.byteSize) {
+            return false;
+        }
+        auto resized = request;
+        resized.byteSize = cached.byteSize;
+        return resized == cached;
+    }
+
+    // Buffers are classed by the power of two below their size, so a fitting
+    // buffer is in the class of the request or the one above.
+    static nvrhi::BufferDesc size_class(const nvrhi::BufferDesc& desc)
+    {
+        auto size_class = desc;
+        size_class.byteSize = std::bit_floor(desc.byteSize);
+        return size_class;
+    }
+
+    static std::array<nvrhi::BufferDesc, 2> candidate_classes(
+        const nvrhi::BufferDesc& request)
+    {
+        auto lower = size_class(request);
+        auto upper = lower;
+        upper.byteSize *= 2;
+        return { lower, upper };
+    }
+};
+
 class ResourceAllocator {
-#define CACHE_NAME(RESOURCE)   m##RESOURCE##Cache
-#define INUSE_NAME(RESOURCE)   mInUse##RESOURCE
-#define PAYLOAD_NAME(RESOURCE) RESOURCE##CachePayload
-#define CACHE_SIZE(RESOURCE)   m##RESOURCE##CacheSize
+#define CACHE_NAME(RESOURCE) m##RESOURCE##Cache
+#define INUSE_NAME(RESOURCE) mInUse##RESOURCE
 
 #define JUDGE_RESOURCE_DYNAMIC(RSC) \
     if (entt::type_hash<RSC##Handle>() == handle.type().id())
 #define JUDGE_RESOURCE(RSC) if constexpr (std::is_same_v<RSC##Handle, RESOURCE>)
 
-#define RESOLVE_DESTROY_DYNAMIC(RESOURCE)             \
-    RESOURCE##Handle h;                               \
-    h = handle.cast<RESOURCE##Handle>();              \
-    if (h) {                                          \
-        PAYLOAD_NAME(RESOURCE) payload{ h, mAge, 0 }; \
-        resolveCacheDestroy(                          \
-            h,                                        \
-            CACHE_SIZE(RESOURCE),                     \
-            payload,                                  \
-            CACHE_NAME(RESOURCE),                     \
-            INUSE_NAME(RESOURCE));                    \
+#define RESOLVE_DESTROY_DYNAMIC(RESOURCE)                   \
+    RESOURCE##Handle h;                                     \
+    h = handle.cast<RESOURCE##Handle>();                    \
+    if (h) {                                                \
+        resolveCacheDestroy(                                \
+            h, CACHE_NAME(RESOURCE), INUSE_NAME(RESOURCE)); \
     }
 
-#define RESOLVE_DESTROY(RESOURCE)                       \
-    PAYLOAD_NAME(RESOURCE) payload { handle, mAge, 0 }; \
-    resolveCacheDestroy(                                \
-        handle,                                         \
-        CACHE_SIZE(RESOURCE),                           \
-        payload,                                        \
-        CACHE_NAME(RESOURCE),                           \
-        INUSE_NAME(RESOURCE));
+#define RESOLVE_DESTROY(RESOURCE) \
+    resolveCacheDestroy(handle, CACHE_NAME(RESOURCE), INUSE_NAME(RESOURCE));
 
    public:
     explicit ResourceAllocator() noexcept;
 
+    ResourceAllocator(const ResourceAllocator&) = delete;
+    ResourceAllocator& operator=(const ResourceAllocator&) = delete;
+
 #define CHECK_EMPTY(RESOURCE)             \
-    assert(!CACHE_NAME(RESOURCE).size()); \
+    assert(CACHE_NAME(RESOURCE).empty()); \
     assert(!INUSE_NAME(RESOURCE).size());
 
     ~ResourceAllocator() noexcept
@@ -78,13 +110,8 @@ class ResourceAllocator {
         }
     }
 
-#define CLEAR_CACHE(RESOURCE)                    \
-    assert(!INUSE_NAME(RESOURCE).size());        \
-    for (auto it = CACHE_NAME(RESOURCE).begin(); \
-         it != CACHE_NAME(RESOURCE).end();       \
-         it++) {                                 \
-        it->second.handle = nullptr;             \
-    }                                            \
+#define CLEAR_CACHE(RESOURCE)             \
+    assert(!INUSE_NAME(RESOURCE).size()); \
     CACHE_NAME(RESOURCE).clear();
 
     void terminate() noexcept { MACRO_MAP(CLEAR_CACHE, RESOURCE_LIST) }
@@ -127,15 +154,72 @@ class ResourceAllocator {
         }
     }
 
-#define GC_TYPE(RSC) gc_type<RSC##Handle>(CACHE_SIZE(RSC), CACHE_NAME(RSC));
+    // Trims every type to its own budget, then evicts the least recently
+    // released resources of any type until the global budget is met.
+    void gc() noexcept
+    {
+        size_t cached_size = 0;
+        for (auto cache : caches) {
+            cache->trim();
+            cached_size += cache->size();
+        }
+
+        while (cached_size > mBudget) {
+            ResourceCacheBase* oldest = nullptr;
+            for (auto cache : caches) {
+                if (!cache->empty() &&
+                    (!oldest || cache->oldest_age() < oldest->oldest_age())) {
+                    oldest = cache;
+                }
+            }
+            if (!oldest) {
+                break;
+            }
+            cached_size -= oldest->size();
+            oldest->evict_oldest();
+            cached_size += oldest->size();
+        }
+    }
+
+    // Budget in bytes over the caches of all types.
+    void set_cache_budget(size_t budget)
+    {
+        mBudget = budget;
+    }
+
+    template<typename RESOURCE>
+    void set_cache_budget(size_t budget)
+    {
+        cache_of<RESOURCE>().set_budget(budget);
+    }
+
+    // Lets a request be served by a compatible cached resource that is not
+    // an exact match, see ResourceBestFit.
+    template<typename RESOURCE>
+    void set_best_fit(bool best_fit)
+    {
+        cache_of<RESOURCE>().set_best_fit(best_fit);
+    }
+
+    template<typename RESOURCE>
+    const ResourceCacheStatistics& cache_statistics()
+    {
+        return cache_of<RESOURCE>().statistics();
+    }
 
-    void gc() noexcept { MACRO_MAP(GC_TYPE, RESOURCE_LIST) }
+    ResourceCacheStatistics cache_statistics() const
+    {
+        ResourceCacheStatistics statistics;
+        for (auto cache : caches) {
+            statistics += cache->statistics();
+        }
+        return statistics;
+    }
 
 #define RESOLVE_CREATE(RESOURCE) \
     resolveCacheCreate(          \
         handle,                  \
         desc,                    \
-        CACHE_SIZE(RESOURCE),    \
         CACHE_NAME(RESOURCE),    \
         INUSE_NAME(RESOURCE),    \
         rest...);
@@ -168,30 +252,27 @@ class ResourceAllocator {
         this->device = device;
     }
 
-#define DEFINEContainer(RESOURCE)                                     \
-    struct PAYLOAD_NAME(RESOURCE) {                                   \
-        RESOURCE##Handle handle;                                      \
-        size_t age = 0;                                               \
-        uint32_t size = 0;                                            \
-    };                                                                \
-    using RESOURCE##CacheContainer =                                  \
-        AssociativeContainer<RESOURCE##Desc, RESOURCE##CachePayload>; \
-    using RESOURCE##InUseContainer =                                  \
-        AssociativeContainer<RESOURCE##Handle, RESOURCE##Desc>;       \
-    RESOURCE##CacheContainer CACHE_NAME(RESOURCE);                    \
-    RESOURCE##InUseContainer INUSE_NAME(RESOURCE);                    \
-    uint32_t CACHE_SIZE(RESOURCE) = 0;
-
-#define PURGE(RESOURCE)                                \
-    RESOURCE##CacheContainer::iterator purge(          \
-        const RESOURCE##CacheContainer::iterator& pos) \
-    {                                                  \
-        pos->second.handle = nullptr;                  \
-        m##RESOURCE##CacheSize -= pos->second.size;    \
-        return CACHE_NAME(RESOURCE).erase(pos);        \
-    }
+#define DEFINEContainer(RESOURCE)                               \
+    using RESOURCE##CacheContainer =                            \
+        ResourceCache<RESOURCE##Desc, RESOURCE##Handle>;        \
+    using RESOURCE##InUseContainer =                            \
+        AssociativeContainer<RESOURCE##Handle, RESOURCE##Desc>; \
+    RESOURCE##CacheContainer CACHE_NAME(RESOURCE);              \
+    RESOURCE##InUseContainer INUSE_NAME(RESOURCE);
 
    private:
+#define RETURN_CACHE(RESOURCE)       \
+    JUDGE_RESOURCE(RESOURCE)         \
+    {                                \
+        return CACHE_NAME(RESOURCE); \
+    }
+
+    template<typename RESOURCE>
+    auto& cache_of()
+    {
+        MACRO_MAP(RETURN_CACHE, RESOURCE_LIST)
+    }
+
 #define CREATE_CONCRETE(RESOURCE)                       \
     JUDGE_RESOURCE(RESOURCE)                            \
     {                                                   \
@@ -217,23 +298,18 @@ class ResourceAllocator {
     void resolveCacheCreate(
         RESOURCE& handle,
         auto& desc,
-        auto& cacheSize,
         auto&& cache,
         auto&& inUseCache,
         auto&&... rest)
     {
-        auto it = cache.find(desc);
-        if (it != cache.end()) {
-            // we do, move the entry to the in-use list, and remove from the
-            // cache
-            handle = it->second.handle;
-            cacheSize -= it->second.size;
-            cache.erase(it);
-        }
-        else {
+        // A best fit resource goes back to the cache under the descriptor it
+        // was created with.
+        std::remove_cvref_t<decltype(desc)> actual_desc = desc;
+        handle = cache.acquire(desc, actual_desc);
+        if (!handle) {
             handle = create_resource<RESOURCE>(desc, rest...);
         }
-        inUseCache.emplace(handle, desc);
+        inUseCache.emplace(handle, std::move(actual_desc));
     }
 
     template<typename RESOURCE>
@@ -245,8 +321,6 @@ class ResourceAllocator {
     template<typename RESOURCE>
     void resolveCacheDestroy(
         RESOURCE& handle,
-        auto& cacheSize,
-        auto& cachePayload,
         auto&& cache,
         auto&& inUseCache)
     {
@@ -258,53 +332,14 @@ class ResourceAllocator {
 
         // move it to the cache
         auto desc = std::move(it->second);
-
-        cachePayload.size = calcSize<RESOURCE>(desc);
-
-        // cache.emplace(key, CachePayload{ handle, mAge, size });
-        cache.emplace(std::move(desc), std::move(cachePayload));
-        cacheSize += cachePayload.size;
+        auto size = calcSize<RESOURCE>(desc);
+        cache.release(std::move(desc), handle, size, mAge++);
 
         // remove it from the in-use list
         inUseCache.erase(it);
     }
 
-    template<typename RESOURCE>
-    void gc_type(auto& cacheSize, auto&& cache_in)
-    {
-        if ((cacheSize >= CACHE_CAPACITY)) {
-            using ContainerType = std::remove_cvref_t<decltype(cache_in)>;
-            using Vector = std::vector<std::pair<
-                typename ContainerType::key_type,
-                typename ContainerType::mapped_type>>;
-            auto cache = Vector();
-            std::copy(
-                cache_in.begin(),
-                cache_in.end(),
-                std::back_insert_iterator<Vector>(cache));
-
-            std::sort(
-                cache.begin(),
-                cache.end(),
-                [](const auto& lhs, const auto& rhs) {
-                    return lhs.second.age < rhs.second.age;
-                });
-
-            auto curr = cache.begin();
-            while (cacheSize >= CACHE_CAPACITY) {
-                purge(cache_in.find(curr->first));
-                ++curr;
-            }
-
-            size_t oldestAge = cache.front().second.age;
-            for (auto& it : cache_in) {
-                it.second.age -= oldestAge;
-            }
-            mAge -= oldestAge;
-        }
-    }
-
-    static constexpr size_t CACHE_CAPACITY = 64u << 20u;  // 64 MiB
+    static constexpr size_t CACHE_CAPACITY = 64u << 20u;  // 64 MiB per type
 
     template<typename T>
     struct Hasher {
@@ -375,13 +410,15 @@ class ResourceAllocator {
     };
 #endif
 
-#define CONTAINER_RELATED(RESOURCE) \
-    DEFINEContainer(RESOURCE);      \
-    PURGE(RESOURCE)
+    MACRO_MAP(DEFINEContainer, RESOURCE_LIST);
 
-    MACRO_MAP(CONTAINER_RELATED, RESOURCE_LIST);
+#define REGISTER_CACHE(RESOURCE) &CACHE_NAME(RESOURCE),
+    std::vector<ResourceCacheBase*> caches = { MACRO_MAP(
+        REGISTER_CACHE,
+        RESOURCE_LIST) };
 
     size_t mAge = 0;
+    size_t mBudget = 4 * CACHE_CAPACITY;  // over all types
     static constexpr bool mEnabled = true;
 };
 
@@ -435,6 +472,9 @@ void ResourceAllocator::AssociativeContainer<K, V, H>::emplace(ARGS&&... args)
 
 inline ResourceAllocator::ResourceAllocator() noexcept
 {
+    for (auto cache : caches) {
+        cache->set_budget(CACHE_CAPACITY);
+    }
 }
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "RHI/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct ResourceCacheStatistics {
+    size_t hits = 0;
+    size_t best_fit_hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t cached_count = 0;
+    size_t cached_size = 0;
+
+    ResourceCacheStatistics& operator+=(const ResourceCacheStatistics& other)
+    {
+        hits += other.hits;
+        best_fit_hits += other.best_fit_hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        cached_count += other.cached_count;
+        cached_size += other.cached_size;
+        return *this;
+    }
+};
+
+// Decides whether a cached resource created from `cached` may serve a request
+// for `request`. Only exact matches are used unless a type specializes this.
+// A specialization also provides size_class, which sorts descriptors into
+// classes, and candidate_classes, the classes a request may be served from.
+template<typename DESC>
+struct ResourceBestFit {
+    static constexpr bool supported = false;
+
+    static bool fits(const DESC& cached, const DESC& request)
+    {
+        return false;
+    }
+};
+
+// The part of a cache the allocator needs to keep a budget over all types.
+class ResourceCacheBase {
+   public:
+    virtual ~ResourceCacheBase() = default;
+
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+    // Age of the least recently released resource, the cache must not be
+    // empty.
+    virtual size_t oldest_age() const = 0;
+    virtual void evict_oldest() = 0;
+    virtual void clear() = 0;
+    virtual const ResourceCacheStatistics& statistics() const = 0;
+
+    void set_budget(size_t budget)
+    {
+        budget_ = budget;
+    }
+
+    size_t budget() const
+    {
+        return budget_;
+    }
+
+    void set_best_fit(bool best_fit)
+    {
+        best_fit_ = best_fit;
+    }
+
+    // Evicts the least recently released resources until the cache fits its
+    // budget.
+    void trim()
+    {
+        while (!empty() && size() > budget_) {
+            evict_oldest();
+        }
+    }
+
+   protected:
+    size_t budget_ = SIZE_MAX;
+    bool best_fit_ = false;
+};
+
+// Unused resources of one type. They are kept in a list ordered by release,
+// with an index from descriptor to list node, so lookup, insertion and
+// eviction are O(1). With best fit, a second index by size class limits the
+// search to the resources that can fit.
+template<typename DESC, typename HANDLE>
+class ResourceCache final : public ResourceCacheBase {
+   public:
+    // Takes a cached resource that can serve desc, and writes the descriptor
+    // it was created with to actual_desc. Returns a null handle on a miss.
+    HANDLE acquire(const DESC& desc, DESC& actual_desc)
+    {
+        auto found = index.find(desc);
+        if (found != index.end()) {
+            ++statistics_.hits;
+            return take(found->second, actual_desc);
+        }
+
+        if constexpr (ResourceBestFit<DESC>::supported) {
+            if (best_fit_) {
+                auto best = lru.end();
+                for (auto& size_class :
+                     ResourceBestFit<DESC>::candidate_classes(desc)) {
+                    auto [begin, end] = size_classes.equal_range(size_class);
+                    for (auto it = begin; it != end; ++it) {
+                        auto entry = it->second;
+                        if (ResourceBestFit<DESC>::fits(entry->desc, desc) &&
+                            (best == lru.end() || entry->size < best->size)) {
+                            best = entry;
+                        }
+                    }
+                }
+                if (best != lru.end()) {
+                    ++statistics_.best_fit_hits;
+                    return take(best, actual_desc);
+                }
+            }
+        }
+
+        ++statistics_.misses;
+        return HANDLE{};
+    }
+
+    void release(DESC desc, HANDLE handle, size_t size, size_t age)
+    {
+        lru.push_front(Entry{ desc, std::move(handle), size, age });
+        if constexpr (ResourceBestFit<DESC>::supported) {
+            size_classes.emplace(
+                ResourceBestFit<DESC>::size_class(desc), lru.begin());
+        }
+        index.emplace(std::move(desc), lru.begin());
+
+        ++statistics_.cached_count;
+        statistics_.cached_size += size;
+    }
+
+    bool empty() const override
+    {
+        return lru.empty();
+    }
+
+    size_t size() const override
+    {
+        return statistics_.cached_size;
+    }
+
+    size_t oldest_age() const override
+    {
+        return lru.back().age;
+    }
+
+    void evict_oldest() override
+    {
+        DESC desc;
+        remove(std::prev(lru.end()), desc);
+        ++statistics_.evictions;
+    }
+
+    void clear() override
+    {
+        index.clear();
+        size_classes.clear();
+        lru.clear();
+        statistics_.cached_count = 0;
+        statistics_.cached_size = 0;
+    }
+
+    const ResourceCacheStatistics& statistics() const override
+    {
+        return statistics_;
+    }
+
+   private:
+    struct Entry {
+        DESC desc;
+        HANDLE handle;
+        size_t size;
+        size_t age;
+    };
+    using List = std::list<Entry>;
+
+    HANDLE take(typename List::iterator entry, DESC& actual_desc)
+    {
+        HANDLE handle = std::move(entry->handle);
+        remove(entry, actual_desc);
+        return handle;
+    }
+
+    using Index = std::unordered_multimap<DESC, typename List::iterator>;
+
+    static void unindex(
+        Index& index,
+        const DESC& key,
+        typename List::iterator entry)
+    {
+        auto [begin, end] = index.equal_range(key);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second == entry) {
+                index.erase(it);
+                break;
+            }
+        }
+    }
+
+    void remove(typename List::iterator entry, DESC& desc)
+    {
+        unindex(index, entry->desc, entry);
+        if constexpr (ResourceBestFit<DESC>::supported) {
+            unindex(
+                size_classes,
+                ResourceBestFit<DESC>::size_class(entry->desc),
+                entry);
+        }
+
+        --statistics_.cached_count;
+        statistics_.cached_size -= entry->size;
+        desc = std::move(entry->desc);
+        lru.erase(entry);
+    }
+
+    List lru;
+    Index index;
+    Index size_classes;
+    ResourceCacheStatistics statistics_;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,128 @@
+#include "RHI/ResourceManager/resource_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <bit>
+#include <memory>
+
+using namespace USTC_CG;
+
+struct FakeDesc {
+    size_t byteSize = 0;
+    int format = 0;
+
+    bool operator==(const FakeDesc&) const = default;
+};
+
+template<>
+struct std::hash<FakeDesc> {
+    size_t operator()(const FakeDesc& desc) const noexcept
+    {
+        return std::hash<size_t>()(desc.byteSize) ^ desc.format;
+    }
+};
+
+template<>
+struct USTC_CG::ResourceBestFit<FakeDesc> {
+    static constexpr bool supported = true;
+
+    static bool fits(const FakeDesc& cached, const FakeDesc& request)
+    {
+        return cached.format == request.format &&
+               cached.byteSize >= request.byteSize &&
+               cached.byteSize <= 2 * request.byteSize;
+    }
+
+    static FakeDesc size_class(const FakeDesc& desc)
+    {
+        return { std::bit_floor(desc.byteSize), desc.format };
+    }
+
+    static std::array<FakeDesc, 2> candidate_classes(const FakeDesc& request)
+    {
+        auto lower = size_class(request);
+        return { lower, FakeDesc{ lower.byteSize * 2, lower.format } };
+    }
+};
+
+using FakeHandle = std::shared_ptr<int>;
+using FakeCache = ResourceCache<FakeDesc, FakeHandle>;
+
+TEST(ResourceCache, exact_match)
+{
+    FakeCache cache;
+    FakeDesc desc{ 64, 1 };
+    FakeDesc actual;
+
+    EXPECT_FALSE(cache.acquire(desc, actual));
+    cache.release(desc, std::make_shared<int>(1), 64, 0);
+    cache.release(FakeDesc{ 128, 1 }, std::make_shared<int>(2), 128, 1);
+    EXPECT_EQ(cache.size(), 192);
+
+    auto handle = cache.acquire(desc, actual);
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(*handle, 1);
+    EXPECT_EQ(actual, desc);
+    EXPECT_EQ(cache.size(), 128);
+
+    // Without best fit a larger resource is not used.
+    EXPECT_FALSE(cache.acquire(desc, actual));
+
+    auto& statistics = cache.statistics();
+    EXPECT_EQ(statistics.hits, 1);
+    EXPECT_EQ(statistics.misses, 2);
+    EXPECT_EQ(statistics.cached_count, 1);
+}
+
+TEST(ResourceCache, best_fit)
+{
+    FakeCache cache;
+    cache.set_best_fit(true);
+    cache.release(FakeDesc{ 256, 1 }, std::make_shared<int>(1), 256, 0);
+    cache.release(FakeDesc{ 128, 1 }, std::make_shared<int>(2), 128, 1);
+    cache.release(FakeDesc{ 96, 2 }, std::make_shared<int>(3), 96, 2);
+
+    FakeDesc actual;
+    auto handle = cache.acquire(FakeDesc{ 100, 1 }, actual);
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(*handle, 2);
+    EXPECT_EQ(actual.byteSize, 128);
+    EXPECT_EQ(cache.statistics().best_fit_hits, 1);
+
+    // Taking a resource leaves no trace in the size classes.
+    EXPECT_FALSE(cache.acquire(FakeDesc{ 100, 1 }, actual));
+    handle = cache.acquire(FakeDesc{ 200, 1 }, actual);
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(*handle, 1);
+    handle = cache.acquire(FakeDesc{ 48, 2 }, actual);
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(*handle, 3);
+    EXPECT_TRUE(cache.empty());
+}
+
+TEST(ResourceCache, lru_eviction)
+{
+    FakeCache cache;
+    for (int i = 0; i < 8; ++i) {
+        cache.release(FakeDesc{ 16, i }, std::make_shared<int>(i), 16, i);
+    }
+
+    // Taking a resource and releasing it again makes it the most recent.
+    FakeDesc actual;
+    auto handle = cache.acquire(FakeDesc{ 16, 0 }, actual);
+    cache.release(actual, handle, 16, 8);
+    EXPECT_EQ(cache.oldest_age(), 1);
+
+    cache.set_budget(64);
+    cache.trim();
+    EXPECT_EQ(cache.size(), 64);
+    EXPECT_EQ(cache.statistics().evictions, 4);
+
+    // The four most recently released resources are left.
+    EXPECT_FALSE(cache.acquire(FakeDesc{ 16, 4 }, actual));
+    for (int i : { 0, 5, 6, 7 }) {
+        EXPECT_TRUE(cache.acquire(FakeDesc{ 16, i }, actual));
+    }
+    EXPECT_TRUE(cache.empty());
+}
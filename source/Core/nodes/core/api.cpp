@@ -1,5 +1,8 @@
 #include "nodes/core/api.hpp"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "nodes/core/node.hpp"
 #include "nodes/core/node_exec_eager.hpp"
 #include "nodes/core/node_link.hpp"
@@ -37,9 +40,37 @@ SocketType get_socket_type<entt::meta_any>()
     return SocketType();
 }
 
+static std::mutex value_hash_mutex;
+static std::unordered_map<entt::id_type, ValueHashFunction> value_hashes;
+
+void register_value_hash(entt::id_type type, ValueHashFunction function)
+{
+    std::lock_guard lock(value_hash_mutex);
+    value_hashes[type] = function;
+}
+
+bool hash_socket_value(const entt::meta_any& value, size_t& hash)
+{
+    if (!value) {
+        return false;
+    }
+    ValueHashFunction function;
+    {
+        std::lock_guard lock(value_hash_mutex);
+        auto it = value_hashes.find(value.type().info().hash());
+        if (it == value_hashes.end()) {
+            return false;
+        }
+        function = it->second;
+    }
+    return function(value, hash);
+}
+
 void unregister_cpp_type()
 {
     entt::meta_reset(g_entt_ctx);
+    std::lock_guard lock(value_hash_mutex);
+    value_hashes.clear();
 }
 
 std::unique_ptr<NodeTree> create_node_tree(
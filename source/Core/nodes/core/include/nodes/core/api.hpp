@@ -9,6 +9,7 @@
 #include "entt/meta/factory.hpp"
 #include "nodes/core/api.h"
 #include "socket.hpp"
+#include "value_hash.hpp"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
 struct NodeTreeExecutorDesc;
@@ -42,6 +43,7 @@ template<typename TYPE>
 inline void register_cpp_type()
 {
     entt::meta<TYPE>(get_entt_ctx()).type(entt::type_hash<TYPE>());
+    register_value_hash<TYPE>();
     if (!entt::hashed_string{ type_name<TYPE>().data() } ==
         entt::type_hash<TYPE>()) {
         log::error("register type failed: %s", type_name<TYPE>().data());
@@ -40,8 +40,32 @@
                std::string(type_name<to>().data());                       \
     }
 
+// A whole conversion whose output is convert(input), with sockets named after
+// the types.
+#define CONVERSION_DEFINITION(from, to, convert)                        \
+    CONVERSION_DECLARATION_FUNCTION(from, to)                           \
+    {                                                                   \
+        b.add_input<from>(#from);                                       \
+        b.add_output<to>(#to);                                          \
+    }                                                                   \
+    CONVERSION_EXECUTION_FUNCTION(from, to)                             \
+    {                                                                   \
+        params.set_output(#to, convert(params.get_input<from>(#from))); \
+        return true;                                                    \
+    }                                                                   \
+    CONVERSION_FUNC_NAME(from, to)
+
 #define NODE_DECLARATION_REQUIRED(name)        \
     USTC_CG_EXPORT bool node_required_##name() \
     {                                          \
         return true;                           \
+    }
+
+// A pure node must not use storage or the global payload, its outputs are
+// restored from the memo whenever its inputs were seen before. See
+// NodeTypeInfo::set_pure.
+#define NODE_DECLARATION_PURE(name)        \
+    USTC_CG_EXPORT bool node_pure_##name() \
+    {                                      \
+        return true;                       \
     }
\ No newline at end of file
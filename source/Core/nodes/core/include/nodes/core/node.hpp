@@ -186,6 +186,7 @@ struct NodeGroup : public Node {
     void deserialize(const nlohmann::json& node_json) override;
 
     friend class NodeTree;
+    friend class NodeTreeDescriptor;
 
     std::pair<NodeSocket*, NodeSocket*> node_group_add_input_socket(
         const char* type_name,
@@ -540,16 +541,35 @@ struct NODES_CORE_API NodeTypeInfo {
 
     NodeTypeInfo& set_always_required(bool always_required);
 
+    // A pure node computes its outputs from its inputs only, without storage
+    // or global payload. The executor memoizes it when all its inputs can be
+    // hashed, and not once it holds storage, which the key does not cover.
+    NodeTypeInfo& set_pure(bool pure);
+
+    // Registers a type ahead of the library that implements it. The loader
+    // sets the declare and execution functions, and is called by the
+    // descriptor the first time the type is looked up.
+    NodeTypeInfo& set_loader(const std::function<void(NodeTypeInfo&)>& loader);
+
+    bool is_loaded() const
+    {
+        return !loader;
+    }
+
     float color[4] = { 0.3, 0.5, 0.7, 1.0 };
     ExecFunction node_execute;
 
     bool ALWAYS_REQUIRED = false;
     bool INVISIBLE = false;
+    bool PURE = false;
 
     NodeDeclaration static_declaration;
 
    private:
+    friend class NodeTreeDescriptor;
+
     NodeDeclareFunction declare;
+    std::function<void(NodeTypeInfo&)> loader;
 
     void reset_declaration();
 
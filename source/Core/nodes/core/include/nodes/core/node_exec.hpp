@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <optional>
 #include <vector>
@@ -73,6 +74,26 @@ struct NODES_CORE_API ExeParams {
         return values;
     }
 
+    /**
+     * Hand the value of an input over to the node. It is moved out when the
+     * executor does not read it again, and copied otherwise.
+     */
+    template<typename T>
+    T take_input(const char* identifier)
+    {
+        const size_t index = this->get_input_index(identifier);
+        if (index < movable_inputs_.size() && movable_inputs_[index]) {
+            return std::move(inputs_[index]->cast<T&>());
+        }
+        return inputs_[index]->cast<const T&>();
+    }
+
+    /**
+     * Hand the values of an input group over to the node. Values the executor
+     * does not read again are moved out, the others are copied.
+     */
+    std::vector<entt::meta_any> take_input_group(const char* group_identifier);
+
     /**
      * Store the output value for the given socket identifier.
      */
@@ -83,7 +104,9 @@ struct NODES_CORE_API ExeParams {
 
         const int index = this->get_output_index(identifier);
 
-        if (outputs_[index]->type()) {
+        // A slot whose value was moved out may keep its type without holding
+        // an object, it is given a new one.
+        if (outputs_[index]->type() && outputs_[index]->data()) {
             outputs_[index]->cast<DecayT&>() = std::forward<T>(value);
         }
         else {
@@ -135,6 +158,9 @@ struct NODES_CORE_API ExeParams {
     void set_output_group(
         const char* identifier,
         const std::vector<entt::meta_any>& outputs);
+    void set_output_group(
+        const char* identifier,
+        std::vector<entt::meta_any>&& outputs);
 
    private:
     int get_input_index(const char* identifier) const;
@@ -157,6 +183,7 @@ struct NODES_CORE_API ExeParams {
    private:
     entt::meta_any& global_param;
     std::vector<entt::meta_any*> inputs_;
+    std::vector<bool> movable_inputs_;
     std::vector<entt::meta_any*> outputs_;
 
     // Subtree execution
@@ -198,6 +225,14 @@ struct NODES_CORE_API NodeTreeExecutor {
     {
     }
 
+    virtual void sync_node_from_external_storage(
+        NodeSocket* socket,
+        entt::meta_any&& data)
+    {
+        sync_node_from_external_storage(
+            socket, static_cast<const entt::meta_any&>(data));
+    }
+
     virtual std::shared_ptr<NodeTreeExecutor> clone_empty() const = 0;
 
     virtual void sync_node_to_external_storage(
@@ -205,12 +240,38 @@ struct NODES_CORE_API NodeTreeExecutor {
         entt::meta_any& data)
     {
     }
+
+    // Takes the value out instead of copying it, for a socket nothing reads
+    // anymore until the tree is prepared again.
+    virtual void move_node_to_external_storage(
+        NodeSocket* socket,
+        entt::meta_any& data)
+    {
+        sync_node_to_external_storage(socket, data);
+    }
     void execute(NodeTree* tree, Node* required_node = nullptr)
     {
         prepare_tree(tree, required_node);
         execute_tree(tree);
     }
 
+    // Cooperative cancellation. The request is only observed between nodes,
+    // so the node currently running always finishes.
+    void request_cancel()
+    {
+        cancel_requested = true;
+    }
+
+    void reset_cancel()
+    {
+        cancel_requested = false;
+    }
+
+    [[nodiscard]] bool is_cancel_requested() const
+    {
+        return cancel_requested;
+    }
+
     template<typename T>
     T get_global_payload()
     {
@@ -225,6 +286,14 @@ struct NODES_CORE_API NodeTreeExecutor {
 
    protected:
     entt::meta_any global_payload;
+    std::atomic<bool> cancel_requested = false;
+};
+
+// What a node group keeps between executions. Its executor outlives the call,
+// keeping the subtree compiled until its structure changes.
+struct NodeGroupStorage {
+    std::shared_ptr<NodeTreeExecutor> executor = nullptr;
+    static constexpr bool has_storage = false;
 };
 
 struct NodeTreeExecutorDesc {
@@ -1,6 +1,9 @@
 #pragma once
+#include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "entt/meta/meta.hpp"
@@ -23,6 +26,39 @@ struct RuntimeOutputState {
     bool is_last_used = false;
 };
 
+// The nodes between a paired iteration_begin and iteration_end. The body is
+// compiled once and executed repeatedly, loop invariant nodes are hoisted out
+// of it. Both indices refer to nodes_to_execute.
+struct IterationZone {
+    ptrdiff_t begin = 0;
+    ptrdiff_t end = 0;
+};
+
+// Counts of the socket values an executor built from scratch, which allocate
+// for the types entt does not store inline, and of the ones it reset or
+// assigned in place.
+struct ValuePoolStatistics {
+    size_t constructed = 0;
+    size_t reused = 0;
+};
+
+// A call of a pure node: its type and the type and content hash of each of
+// its inputs. hash combines them to index the memo, a hit also compares the
+// inputs one by one, so two calls only collide if one of their inputs does.
+struct MemoKey {
+    const NodeTypeInfo* type = nullptr;
+    std::vector<std::pair<entt::id_type, size_t>> inputs;
+    size_t hash = 0;
+
+    bool operator==(const MemoKey&) const = default;
+};
+
+// Outputs a pure node computed for a call.
+struct MemoEntry {
+    MemoKey key;
+    std::vector<entt::meta_any> outputs;
+};
+
 // Provide single threaded execution. The aim of this executor is simplicity and
 // robustness.
 
@@ -37,11 +73,38 @@ class NODES_CORE_API EagerNodeTreeExecutor : public NodeTreeExecutor {
     void sync_node_from_external_storage(
         NodeSocket* socket,
         const entt::meta_any& data) override;
+    void sync_node_from_external_storage(
+        NodeSocket* socket,
+        entt::meta_any&& data) override;
     void sync_node_to_external_storage(NodeSocket* socket, entt::meta_any& data)
         override;
+    void move_node_to_external_storage(NodeSocket* socket, entt::meta_any& data)
+        override;
 
     std::shared_ptr<NodeTreeExecutor> clone_empty() const override;
 
+    const ValuePoolStatistics& value_pool_statistics() const
+    {
+        return pool_statistics;
+    }
+
+    void reset_value_pool_statistics()
+    {
+        pool_statistics = {};
+    }
+
+    // How many times prepare_tree compiled a plan instead of reusing the last
+    // one.
+    size_t compile_count() const
+    {
+        return compilations;
+    }
+
+    // Pure nodes called with inputs seen in the last memo_capacity calls are
+    // not executed, their outputs are copied from the memo.
+    void set_memo_capacity(size_t capacity);
+    void clear_memo();
+
    protected:
     virtual ExeParams prepare_params(NodeTree* tree, Node* node);
     virtual bool execute_node(NodeTree* tree, Node* node);
@@ -49,6 +112,23 @@ class NODES_CORE_API EagerNodeTreeExecutor : public NodeTreeExecutor {
     void forward_output_to_input(Node* node);
     void clear();
 
+    // Socket values keep their storage across executions. A value of the
+    // right type is reset to the default of its type or assigned in place,
+    // only an empty or mismatching one is replaced.
+    void reset_value(entt::meta_any& value, SocketType type);
+    void copy_value(entt::meta_any& to, const entt::meta_any& from);
+    void move_value(entt::meta_any& to, entt::meta_any&& from);
+    void recycle_values();
+
+    // False when an input of the node cannot be hashed.
+    bool compute_memo_key(Node* node, MemoKey& key);
+    bool restore_memo(Node* node, const MemoKey& key);
+    void store_memo(Node* node, MemoKey&& key);
+
+    void compile_iteration_zones();
+    void execute_nodes(NodeTree* tree, ptrdiff_t first, ptrdiff_t last);
+    void execute_iteration_zone(NodeTree* tree, const IterationZone& zone);
+
     std::vector<RuntimeInputState> input_states;
     std::vector<RuntimeOutputState> output_states;
     std::map<NodeSocket*, size_t> index_cache;
@@ -56,6 +136,26 @@ class NODES_CORE_API EagerNodeTreeExecutor : public NodeTreeExecutor {
     std::vector<NodeSocket*> input_of_nodes_to_execute;
     std::vector<NodeSocket*> output_of_nodes_to_execute;
     ptrdiff_t nodes_to_execute_count = 0;
+    std::vector<IterationZone> iteration_zones;
+
+    // What the current plan was compiled for. Preparing the same tree again
+    // only resets the runtime states.
+    NodeTree* compiled_tree = nullptr;
+    Node* compiled_required_node = nullptr;
+    uint64_t compiled_revision = 0;
+    size_t compilations = 0;
+
+    // Defaults values are reset to, and the values of the slots of the last
+    // plan, by type, for the next one to take over.
+    std::unordered_map<entt::id_type, entt::meta_any> default_values;
+    std::unordered_map<entt::id_type, std::vector<entt::meta_any>> value_pool;
+    ValuePoolStatistics pool_statistics;
+
+    // Most recently used first, indexed by the hash of their key. Inputs are
+    // not kept alive by the memo, only their hashes.
+    std::list<MemoEntry> memo;
+    std::unordered_map<size_t, std::list<MemoEntry>::iterator> memo_index;
+    size_t memo_capacity = 64;
 
     // Storage related
     virtual void refresh_storage();
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -35,7 +37,12 @@ class NODES_CORE_API NodeTreeDescriptor {
     NodeTreeDescriptor& register_conversion_name(
         const std::string& conversion_name);
 
-    const NodeTypeInfo* get_node_type(const std::string& name) const;
+    // Loads the library of a type registered with a loader on its first
+    // lookup.
+    const NodeTypeInfo* get_node_type(const std::string& name);
+    // Whether a type is registered and its library has been loaded, without
+    // loading it.
+    bool is_node_type_loaded(const std::string& name) const;
 
     static std::string conversion_node_name(SocketType from, SocketType to);
     bool can_convert(SocketType from, SocketType to) const;
@@ -55,6 +62,7 @@ class NODES_CORE_API NodeTreeDescriptor {
     std::map<std::string, NodeTypeInfo> node_registry;
 
     std::unordered_set<std::string> conversion_node_registry;
+    mutable std::mutex loading_mutex;
 
     std::vector<std::vector<GROUP_DESC>> socket_group_syncronization;
 };
@@ -90,6 +98,16 @@ NodeTreeDescriptor& NodeTreeDescriptor::register_conversion(
     return *this;
 }
 
+// Json form of a tree. Taking it is cheap and has to happen on the thread
+// owning the tree; dump() yields the same string as NodeTree::serialize() and
+// may run anywhere.
+struct NODES_CORE_API NodeTreeSerialization {
+    nlohmann::json value;
+    std::string ui_settings;
+
+    [[nodiscard]] std::string dump() const;
+};
+
 class NODES_CORE_API NodeTree {
    public:
     NodeTree(std::shared_ptr<NodeTreeDescriptor> descriptor);
@@ -213,6 +231,7 @@ class NODES_CORE_API NodeTree {
 
    public:
     std::string serialize() const;
+    NodeTreeSerialization serialize_snapshot() const;
 
     void deserialize(const std::string& str);
 
@@ -220,8 +239,16 @@ class NODES_CORE_API NodeTree {
 
     bool GetDirty();
 
+    // Changes whenever nodes, sockets or links are added or removed, so an
+    // executor can tell whether what it compiled still matches the tree.
+    // Values are never shared between trees.
+    [[nodiscard]] uint64_t structure_revision() const;
+
    private:
+    void mark_structure_changed();
+
     bool dirty_ = true;
+    uint64_t structure_revision_ = 0;
 };
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
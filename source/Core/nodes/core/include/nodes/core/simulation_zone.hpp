@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include "entt/meta/meta.hpp"
+#include "nodes/core/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+struct ExeParams;
+
+// State of a simulation zone, kept in the storage of simulation_in. The state
+// is double buffered so a step moves it instead of copying it: simulation_out
+// fills the in flight buffer and swaps it with the committed one when the step
+// finished. Both buffers keep their allocations across steps.
+struct SimulationStorage {
+    // The state of the last finished step.
+    std::vector<entt::meta_any> committed;
+    // The state of the running step.
+    std::vector<entt::meta_any> in_flight;
+    static constexpr bool has_storage = false;
+};
+
+// The bodies of the simulation_in and simulation_out nodes, shared by the node
+// libraries that differ in how they tell whether a simulation is running.
+
+// Starts a step from the state of the last finished one, or from the inputs
+// when not simulating. The committed state is moved into the step, so after a
+// step that fails the zone starts again from its inputs. Fails, keeping the
+// state, when the state does not match the zone's sockets.
+NODES_CORE_API bool execute_simulation_in(ExeParams& params, bool simulating);
+// Commits the values of the finished step as the state of the zone. When a
+// value is missing the step fails and the committed state is left as it was.
+NODES_CORE_API bool execute_simulation_out(ExeParams& params);
+USTC_CG_NAMESPACE_CLOSE_SCOPE
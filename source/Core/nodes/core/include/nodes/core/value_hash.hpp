@@ -0,0 +1,80 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#include "entt/meta/meta.hpp"
+#include "nodes/core/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+inline void hash_combine(size_t& seed, size_t hash)
+{
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// Content hash of a socket value, used to memoize pure nodes. Arithmetic
+// types, enums and strings go through std::hash, other types provide a
+// hash_value found by argument dependent lookup. pxr::VtArray and the Gf types
+// do, hashing their elements. A type that cannot always be hashed provides
+// bool hash_value(const T&, size_t&) instead. Pointers and handles are left
+// out on purpose, as their address says nothing about what they point to.
+template<typename T>
+struct ValueHash {
+    static constexpr bool std_hashed = std::is_arithmetic_v<T> ||
+                                       std::is_enum_v<T> ||
+                                       std::is_same_v<T, std::string>;
+
+    static constexpr bool has_fallible_hash =
+        requires(const T& value, size_t& hash) {
+            { hash_value(value, hash) } -> std::convertible_to<bool>;
+        };
+
+    static constexpr bool has_hash =
+        std_hashed || has_fallible_hash || requires(const T& value) {
+            { hash_value(value) } -> std::convertible_to<size_t>;
+        };
+
+    static bool hash(const T& value, size_t& result)
+    {
+        if constexpr (std_hashed) {
+            result = std::hash<T>{}(value);
+            return true;
+        }
+        else if constexpr (has_fallible_hash) {
+            return hash_value(value, result);
+        }
+        else {
+            result = hash_value(value);
+            return true;
+        }
+    }
+};
+
+using ValueHashFunction = bool (*)(const entt::meta_any& value, size_t& hash);
+
+NODES_CORE_API void register_value_hash(
+    entt::id_type type,
+    ValueHashFunction function);
+
+// False when the value cannot be hashed, or its type has no hash registered.
+NODES_CORE_API bool hash_socket_value(
+    const entt::meta_any& value,
+    size_t& hash);
+
+template<typename T>
+inline void register_value_hash()
+{
+    if constexpr (ValueHash<T>::has_hash) {
+        register_value_hash(
+            entt::type_hash<T>(),
+            [](const entt::meta_any& value, size_t& hash) {
+                return ValueHash<T>::hash(value.cast<const T&>(), hash);
+            });
+    }
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -58,6 +58,19 @@ NodeTypeInfo& NodeTypeInfo::set_always_required(bool always_required)
     return *this;
 }
 
+NodeTypeInfo& NodeTypeInfo::set_pure(bool pure)
+{
+    this->PURE = pure;
+    return *this;
+}
+
+NodeTypeInfo& NodeTypeInfo::set_loader(
+    const std::function<void(NodeTypeInfo&)>& loader)
+{
+    this->loader = loader;
+    return *this;
+}
+
 void NodeTypeInfo::reset_declaration()
 {
     static_declaration = NodeDeclaration();
@@ -346,6 +359,7 @@ NodeSocket* Node::add_socket(
     register_socket_to_node(socket, in_out);
 
     tree_->sockets.emplace_back(socket);
+    tree_->mark_structure_changed();
     return socket;
 }
 
@@ -489,6 +503,7 @@ void Node::refresh_node()
 
     out_date_sockets(old_inputs, PinKind::Input);
     out_date_sockets(old_outputs, PinKind::Output);
+    tree_->mark_structure_changed();
 }
 
 void Node::deserialize(const nlohmann::json& node_json)
@@ -17,6 +17,34 @@ void ExeParams::set_output_group(
     }
 }
 
+void ExeParams::set_output_group(
+    const char* identifier,
+    std::vector<entt::meta_any>&& outputs)
+{
+    const auto indices = get_output_group_indices(identifier);
+    assert(indices.size() == outputs.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        *outputs_[indices[i]] = std::move(outputs[i]);
+    }
+}
+
+std::vector<entt::meta_any> ExeParams::take_input_group(
+    const char* group_identifier)
+{
+    const auto indices = get_input_group_indices(group_identifier);
+    std::vector<entt::meta_any> values;
+    values.reserve(indices.size());
+    for (size_t index : indices) {
+        if (index < movable_inputs_.size() && movable_inputs_[index]) {
+            values.push_back(std::move(*inputs_[index]));
+        }
+        else {
+            values.push_back(*inputs_[index]);
+        }
+    }
+    return values;
+}
+
 int ExeParams::get_input_index(const char* identifier) const
 {
     return node_.find_socket_id(identifier, PinKind::Input);
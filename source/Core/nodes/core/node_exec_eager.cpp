@@ -1,11 +1,14 @@
 #include "nodes/core/node_exec_eager.hpp"
 
+#include <algorithm>
 #include <set>
+#include <utility>
 
 #include "entt/core/any.hpp"
 #include "entt/meta/resolve.hpp"
 #include "nodes/core/api.h"
 #include "nodes/core/node_tree.hpp"
+#include "nodes/core/value_hash.hpp"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
 
@@ -27,10 +30,9 @@ ExeParams EagerNodeTreeExecutor::prepare_params(NodeTree* tree, Node* node)
         }
         else if (
             input->directly_linked_sockets.empty() && input->dataField.value) {
-            auto type = input_states[index_cache[input]].value.type();
-            auto value = input->dataField.value;
             // Has default value
-            input_states[index_cache[input]].value = value;
+            copy_value(
+                input_states[index_cache[input]].value, input->dataField.value);
             input_ptr = &input_states[index_cache[input]].value;
         }
         else {
@@ -41,6 +43,8 @@ ExeParams EagerNodeTreeExecutor::prepare_params(NodeTree* tree, Node* node)
             node->MISSING_INPUT = true;
         }
         params.inputs_.push_back(input_ptr);
+        params.movable_inputs_.push_back(
+            !input_states[index_cache[input]].keep_alive);
     }
 
     for (auto&& output : node->get_outputs()) {
@@ -64,14 +68,106 @@ bool EagerNodeTreeExecutor::execute_node(NodeTree* tree, Node* node)
         return false;
     }
     auto typeinfo = node->typeinfo;
+
+    MemoKey key;
+    bool memoized = typeinfo->PURE && !node->is_node_group() &&
+                    memo_capacity > 0 && compute_memo_key(node, key);
+    if (memoized && restore_memo(node, key)) {
+        node->execution_failed = {};
+        return true;
+    }
+
     if (!typeinfo->node_execute(params)) {
         node->execution_failed = "Execution failed";
         return false;
     }
     node->execution_failed = {};
+    if (memoized) {
+        store_memo(node, std::move(key));
+    }
+    return true;
+}
+
+bool EagerNodeTreeExecutor::compute_memo_key(Node* node, MemoKey& key)
+{
+    // Storage is state the key does not see, a pure node using it anyway is
+    // executed every time.
+    if (node->storage) {
+        return false;
+    }
+    key.type = node->typeinfo;
+    key.hash = std::hash<std::string>{}(node->typeinfo->id_name);
+    for (auto&& input : node->get_inputs()) {
+        if (input->is_placeholder()) {
+            continue;
+        }
+        auto& value = input_states[index_cache[input]].value;
+        size_t hash;
+        if (!hash_socket_value(value, hash)) {
+            return false;
+        }
+        auto type = value.type().info().hash();
+        key.inputs.emplace_back(type, hash);
+        hash_combine(key.hash, type);
+        hash_combine(key.hash, hash);
+    }
     return true;
 }
 
+bool EagerNodeTreeExecutor::restore_memo(Node* node, const MemoKey& key)
+{
+    auto found = memo_index.find(key.hash);
+    if (found == memo_index.end()) {
+        return false;
+    }
+    auto entry = found->second;
+    auto& outputs = node->get_outputs();
+    if (entry->key != key || entry->outputs.size() != outputs.size()) {
+        return false;
+    }
+
+    memo.splice(memo.begin(), memo, entry);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        copy_value(
+            output_states[index_cache[outputs[i]]].value, entry->outputs[i]);
+    }
+    return true;
+}
+
+void EagerNodeTreeExecutor::store_memo(Node* node, MemoKey&& key)
+{
+    // A call whose key has the same hash is replaced.
+    auto found = memo_index.find(key.hash);
+    if (found != memo_index.end()) {
+        memo.erase(found->second);
+        memo_index.erase(found);
+    }
+
+    MemoEntry entry;
+    entry.key = std::move(key);
+    for (auto&& output : node->get_outputs()) {
+        entry.outputs.push_back(output_states[index_cache[output]].value);
+    }
+    memo.push_front(std::move(entry));
+    memo_index.emplace(memo.front().key.hash, memo.begin());
+    set_memo_capacity(memo_capacity);
+}
+
+void EagerNodeTreeExecutor::set_memo_capacity(size_t capacity)
+{
+    memo_capacity = capacity;
+    while (memo.size() > memo_capacity) {
+        memo_index.erase(memo.back().key.hash);
+        memo.pop_back();
+    }
+}
+
+void EagerNodeTreeExecutor::clear_memo()
+{
+    memo.clear();
+    memo_index.clear();
+}
+
 void EagerNodeTreeExecutor::forward_output_to_input(Node* node)
 {
     for (auto&& output : node->get_outputs()) {
@@ -126,10 +222,11 @@ void EagerNodeTreeExecutor::forward_output_to_input(Node* node)
                             ->execution_failed = {};
 
                         if (is_last_target) {
-                            input_state.value = std::move(value_to_forward);
+                            move_value(
+                                input_state.value, std::move(value_to_forward));
                         }
                         else {
-                            input_state.value = value_to_forward;
+                            copy_value(input_state.value, value_to_forward);
                         }
                         // Move is better in efficiency,
                         // but it bothers the visualization of input and output.
@@ -160,11 +257,6 @@ void EagerNodeTreeExecutor::forward_output_to_input(Node* node)
             }
         }
     }
-
-    if (node->typeinfo->id_name == "simulation_out") {
-        auto simulation_in = node->paired_node;
-        simulation_in->storage = node->storage;
-    }
 }
 
 void EagerNodeTreeExecutor::clear()
@@ -174,6 +266,7 @@ void EagerNodeTreeExecutor::clear()
     index_cache.clear();
     nodes_to_execute.clear();
     nodes_to_execute_count = 0;
+    iteration_zones.clear();
     input_of_nodes_to_execute.clear();
     output_of_nodes_to_execute.clear();
 }
@@ -205,6 +298,11 @@ void EagerNodeTreeExecutor::compile(NodeTree* tree, Node* required_node)
         }
 
         if (node->REQUIRED) {
+            // The whole zone runs when its end is needed.
+            if (node->typeinfo->id_name == "iteration_end" &&
+                node->paired_node) {
+                node->paired_node->REQUIRED = true;
+            }
             for (auto input : node->get_inputs()) {
                 assert(input->directly_linked_sockets.size() <= 1);
                 for (auto directly_linked_socket :
@@ -225,6 +323,8 @@ void EagerNodeTreeExecutor::compile(NodeTree* tree, Node* required_node)
 
     nodes_to_execute_count = std::distance(nodes_to_execute.begin(), split);
 
+    compile_iteration_zones();
+
     for (int i = 0; i < nodes_to_execute_count; ++i) {
         input_of_nodes_to_execute.insert(
             input_of_nodes_to_execute.end(),
@@ -238,22 +338,194 @@ void EagerNodeTreeExecutor::compile(NodeTree* tree, Node* required_node)
     }
 }
 
+void EagerNodeTreeExecutor::compile_iteration_zones()
+{
+    auto first = nodes_to_execute.begin();
+    auto last = nodes_to_execute.begin() + nodes_to_execute_count;
+
+    for (ptrdiff_t i = 0; i < nodes_to_execute_count; ++i) {
+        auto begin = nodes_to_execute[i];
+        if (begin->typeinfo->id_name != "iteration_begin") {
+            continue;
+        }
+        auto end = begin->paired_node;
+        auto end_it = std::find(first + i, last, end);
+        if (!end || end_it == last) {
+            // Nothing after the beginning closes the zone, it is executed
+            // once like any other node.
+            continue;
+        }
+        ptrdiff_t end_pos = std::distance(first, end_it);
+
+        // An inner zone must be closed before the one containing it.
+        bool crossing = false;
+        for (auto& outer : iteration_zones) {
+            if (outer.begin < i && i < outer.end && end_pos > outer.end) {
+                crossing = true;
+            }
+        }
+        if (crossing) {
+            begin->execution_failed = "Iteration zones overlap.";
+            continue;
+        }
+
+        auto linked_from = [](Node* node, const std::set<Node*>& nodes) {
+            for (auto input : node->get_inputs()) {
+                for (auto source : input->directly_linked_sockets) {
+                    if (nodes.contains(source->node)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
+        std::set<Node*> depending = { begin };
+        for (ptrdiff_t j = i + 1; j < end_pos; ++j) {
+            if (linked_from(nodes_to_execute[j], depending)) {
+                depending.insert(nodes_to_execute[j]);
+            }
+        }
+
+        std::set<Node*> feeding = { end };
+        for (ptrdiff_t j = end_pos - 1; j > i; --j) {
+            auto node = nodes_to_execute[j];
+            if (!depending.contains(node)) {
+                continue;
+            }
+            for (auto output : node->get_outputs()) {
+                for (auto target : output->directly_linked_sockets) {
+                    if (feeding.contains(target->node)) {
+                        feeding.insert(node);
+                    }
+                }
+            }
+        }
+
+        // Nodes not depending on the iteration are hoisted in front of the
+        // zone, the ones only consuming its values move behind it and see
+        // the last iteration.
+        std::vector<Node*> invariant, body, after;
+        for (ptrdiff_t j = i + 1; j < end_pos; ++j) {
+            auto node = nodes_to_execute[j];
+            if (!depending.contains(node)) {
+                invariant.push_back(node);
+            }
+            else if (feeding.contains(node)) {
+                body.push_back(node);
+            }
+            else {
+                after.push_back(node);
+            }
+        }
+
+        auto out = first + i;
+        out = std::copy(invariant.begin(), invariant.end(), out);
+        *out++ = begin;
+        out = std::copy(body.begin(), body.end(), out);
+        *out++ = end;
+        std::copy(after.begin(), after.end(), out);
+
+        IterationZone zone;
+        zone.begin = i + invariant.size();
+        zone.end = zone.begin + body.size() + 1;
+        iteration_zones.push_back(zone);
+
+        // Continue from the beginning, nested zones are found in the body.
+        i = zone.begin;
+    }
+}
+
 void EagerNodeTreeExecutor::prepare_memory()
 {
     for (int i = 0; i < input_states.size(); ++i) {
         index_cache[input_of_nodes_to_execute[i]] = i;
-        auto type = input_of_nodes_to_execute[i]->type_info;
-        if (type) {
-            input_states[i].value = type.construct();
-        }
+        reset_value(
+            input_states[i].value, input_of_nodes_to_execute[i]->type_info);
     }
 
     for (int i = 0; i < output_states.size(); ++i) {
         index_cache[output_of_nodes_to_execute[i]] = i;
-        auto type = output_of_nodes_to_execute[i]->type_info;
-        if (type) {
-            output_states[i].value = type.construct();
+        reset_value(
+            output_states[i].value, output_of_nodes_to_execute[i]->type_info);
+    }
+    value_pool.clear();
+}
+
+void EagerNodeTreeExecutor::reset_value(entt::meta_any& value, SocketType type)
+{
+    if (!type) {
+        value.reset();
+        return;
+    }
+
+    // A moved from value may keep its type without holding an object, it
+    // takes one from the pool of the last plan.
+    if (!(value.type() == type && value.data())) {
+        auto pooled = value_pool.find(type.id());
+        if (pooled != value_pool.end() && !pooled->second.empty()) {
+            value = std::move(pooled->second.back());
+            pooled->second.pop_back();
+        }
+    }
+
+    // Every value is reset, whether or not it is written again: a node may
+    // leave an output unset, and the last value must not leak into this run.
+    // Assigning the default keeps the storage of the object.
+    if (value.type() == type && value.data()) {
+        auto default_value = default_values.find(type.id());
+        if (default_value == default_values.end()) {
+            default_value =
+                default_values.emplace(type.id(), type.construct()).first;
         }
+        if (value.assign(default_value->second)) {
+            ++pool_statistics.reused;
+            return;
+        }
+    }
+
+    value = type.construct();
+    ++pool_statistics.constructed;
+}
+
+void EagerNodeTreeExecutor::copy_value(
+    entt::meta_any& to,
+    const entt::meta_any& from)
+{
+    if (to.type() == from.type() && to.data() && to.assign(from)) {
+        ++pool_statistics.reused;
+        return;
+    }
+    to = from;
+    if (to) {
+        ++pool_statistics.constructed;
+    }
+}
+
+void EagerNodeTreeExecutor::move_value(
+    entt::meta_any& to,
+    entt::meta_any&& from)
+{
+    // Moving into the object the slot holds leaves both slots their storage.
+    if (to.type() == from.type() && to.data() && from.data() &&
+        to.assign(std::move(from))) {
+        return;
+    }
+    to = std::move(from);
+}
+
+void EagerNodeTreeExecutor::recycle_values()
+{
+    auto recycle = [this](entt::meta_any& value) {
+        if (value.type() && value.data()) {
+            value_pool[value.type().id()].push_back(std::move(value));
+        }
+    };
+    for (auto& state : input_states) {
+        recycle(state.value);
+    }
+    for (auto& state : output_states) {
+        recycle(state.value);
     }
 }
 
@@ -391,13 +663,32 @@ void EagerNodeTreeExecutor::prepare_tree(NodeTree* tree, Node* required_node)
 {
     // auto gilState = PyGILState_Ensure();
 
-    tree->ensure_topology_cache();
-    clear();
+    if (tree != compiled_tree || required_node != compiled_required_node ||
+        tree->structure_revision() != compiled_revision) {
+        recycle_values();
+        tree->ensure_topology_cache();
+        clear();
+
+        compile(tree, required_node);
 
-    compile(tree, required_node);
+        compiled_tree = tree;
+        compiled_required_node = required_node;
+        compiled_revision = tree->structure_revision();
+        ++compilations;
+    }
 
+    // The values are reset by prepare_memory, only the flags of the last
+    // execution are cleared here.
     input_states.resize(input_of_nodes_to_execute.size());
     output_states.resize(output_of_nodes_to_execute.size());
+    for (auto& state : input_states) {
+        state.is_forwarded = false;
+        state.is_last_used = false;
+        state.keep_alive = false;
+    }
+    for (auto& state : output_states) {
+        state.is_last_used = false;
+    }
 
     prepare_memory();
 
@@ -409,16 +700,187 @@ void EagerNodeTreeExecutor::execute_tree(NodeTree* tree)
 {
     // auto gilState = PyGILState_Ensure();
 
-    for (int i = 0; i < nodes_to_execute_count; ++i) {
+    execute_nodes(tree, 0, nodes_to_execute_count);
+    if (is_cancel_requested()) {
+        // Leave the storage untouched, a newer execution will refill it.
+        return;
+    }
+    try_storage();
+
+    // PyGILState_Release(gilState);
+}
+
+void EagerNodeTreeExecutor::execute_nodes(
+    NodeTree* tree,
+    ptrdiff_t first,
+    ptrdiff_t last)
+{
+    for (ptrdiff_t i = first; i < last; ++i) {
+        if (is_cancel_requested()) {
+            return;
+        }
+        auto zone = std::find_if(
+            iteration_zones.begin(),
+            iteration_zones.end(),
+            [i](const IterationZone& zone) { return zone.begin == i; });
+        if (zone != iteration_zones.end()) {
+            execute_iteration_zone(tree, *zone);
+            i = zone->end;
+            continue;
+        }
+
         auto node = nodes_to_execute[i];
         auto result = execute_node(tree, node);
         if (result) {
             forward_output_to_input(node);
         }
     }
-    try_storage();
+}
 
-    // PyGILState_Release(gilState);
+void EagerNodeTreeExecutor::execute_iteration_zone(
+    NodeTree* tree,
+    const IterationZone& zone)
+{
+    auto begin = nodes_to_execute[zone.begin];
+    auto end = nodes_to_execute[zone.end];
+
+    if (!execute_node(tree, begin)) {
+        return;
+    }
+
+    auto count_socket = begin->get_input_socket("Count");
+    auto index_socket = begin->get_output_socket("Index");
+    if (!count_socket || !index_socket) {
+        begin->execution_failed = "Outdated iteration node.";
+        return;
+    }
+    int count = 1;
+    if (auto value =
+            input_states[index_cache[count_socket]].value.try_cast<int>()) {
+        count = *value;
+    }
+    auto& index_state = output_states[index_cache[index_socket]];
+
+    auto begin_ids =
+        begin->find_socket_group_ids("Iteration Out", PinKind::Output);
+    auto end_ids = end->find_socket_group_ids("Iteration In", PinKind::Input);
+    if (begin_ids.size() != end_ids.size()) {
+        begin->execution_failed = "Iteration sockets are not paired.";
+        return;
+    }
+
+    // States written from inside the zone, which are forwarded again by every
+    // iteration.
+    std::vector<size_t> zone_inputs;
+    std::vector<size_t> zone_outputs;
+    for (ptrdiff_t i = zone.begin; i < zone.end; ++i) {
+        for (auto output : nodes_to_execute[i]->get_outputs()) {
+            zone_outputs.push_back(index_cache[output]);
+            for (auto target : output->directly_linked_sockets) {
+                if (index_cache.contains(target)) {
+                    zone_inputs.push_back(index_cache[target]);
+                }
+            }
+        }
+    }
+
+    struct CarriedValue {
+        size_t from;
+        size_t to;
+        bool by_move;
+    };
+    std::vector<CarriedValue> carried;
+    for (size_t k = 0; k < begin_ids.size(); ++k) {
+        auto from = index_cache[end->get_inputs()[end_ids[k]]];
+        auto to = index_cache[begin->get_outputs()[begin_ids[k]]];
+        // A value coming from outside the zone is needed again by the next
+        // iterations, so it can only be copied.
+        bool by_move = std::find(
+                           zone_inputs.begin(), zone_inputs.end(), from) !=
+                       zone_inputs.end();
+        carried.push_back({ from, to, by_move });
+    }
+
+    // Values from outside the zone are read by every iteration. They are not
+    // released or moved out by the body, but only once the zone is done.
+    std::vector<size_t> invariant_inputs;
+    std::vector<std::pair<size_t, bool>> kept_inputs;
+    for (ptrdiff_t i = zone.begin + 1; i <= zone.end; ++i) {
+        for (auto input : nodes_to_execute[i]->get_inputs()) {
+            auto state = index_cache.find(input);
+            if (state == index_cache.end() ||
+                std::find(
+                    zone_inputs.begin(), zone_inputs.end(), state->second) !=
+                    zone_inputs.end()) {
+                continue;
+            }
+            auto& input_state = input_states[state->second];
+            kept_inputs.emplace_back(state->second, input_state.keep_alive);
+            input_state.keep_alive = true;
+            if (input_state.is_last_used) {
+                input_state.is_last_used = false;
+                invariant_inputs.push_back(state->second);
+            }
+        }
+    }
+    auto release_invariants = [&] {
+        for (auto i : invariant_inputs) {
+            input_states[i].is_last_used = true;
+        }
+        for (auto [i, keep_alive] : kept_inputs) {
+            input_states[i].keep_alive = keep_alive;
+        }
+    };
+
+    forward_output_to_input(begin);
+    for (int iteration = 0;; ++iteration) {
+        execute_nodes(tree, zone.begin + 1, zone.end);
+        if (is_cancel_requested()) {
+            release_invariants();
+            return;
+        }
+
+        ExeParams params = prepare_params(tree, end);
+        if (end->MISSING_INPUT) {
+            release_invariants();
+            return;
+        }
+        auto converged = params.get_input<bool>("Converged");
+        if (converged || iteration + 1 >= count) {
+            release_invariants();
+            if (!end->typeinfo->node_execute(params)) {
+                end->execution_failed = "Execution failed";
+                return;
+            }
+            end->execution_failed = {};
+            forward_output_to_input(end);
+            return;
+        }
+
+        for (auto i : zone_inputs) {
+            input_states[i].is_forwarded = false;
+            input_states[i].is_last_used = false;
+        }
+        for (auto i : zone_outputs) {
+            output_states[i].is_last_used = false;
+        }
+
+        // Loop carried values are handed back to the beginning by move.
+        for (auto& value : carried) {
+            if (value.by_move) {
+                move_value(
+                    output_states[value.to].value,
+                    std::move(input_states[value.from].value));
+            }
+            else {
+                copy_value(
+                    output_states[value.to].value,
+                    input_states[value.from].value);
+            }
+        }
+        index_state.value = iteration + 1;
+        forward_output_to_input(begin);
+    }
 }
 
 entt::meta_any* EagerNodeTreeExecutor::FindPtr(NodeSocket* socket)
@@ -447,7 +909,7 @@ void EagerNodeTreeExecutor::sync_node_from_external_storage(
 {
     if (index_cache.find(socket) != index_cache.end()) {
         entt::meta_any* ptr = FindPtr(socket);
-        *ptr = data;
+        copy_value(*ptr, data);
 
         // if it has dataField, fill it
         if (socket->in_out == PinKind::Input) {
@@ -459,6 +921,19 @@ void EagerNodeTreeExecutor::sync_node_from_external_storage(
     }
 }
 
+void EagerNodeTreeExecutor::sync_node_from_external_storage(
+    NodeSocket* socket,
+    entt::meta_any&& data)
+{
+    if (socket->in_out == PinKind::Input) {
+        // An input may also keep the value as its default.
+        sync_node_from_external_storage(socket, std::as_const(data));
+    }
+    else if (index_cache.find(socket) != index_cache.end()) {
+        move_value(*FindPtr(socket), std::move(data));
+    }
+}
+
 void EagerNodeTreeExecutor::sync_node_to_external_storage(
     NodeSocket* socket,
     entt::meta_any& data)
@@ -469,6 +944,15 @@ void EagerNodeTreeExecutor::sync_node_to_external_storage(
     }
 }
 
+void EagerNodeTreeExecutor::move_node_to_external_storage(
+    NodeSocket* socket,
+    entt::meta_any& data)
+{
+    if (index_cache.find(socket) != index_cache.end()) {
+        data = std::move(*FindPtr(socket));
+    }
+}
+
 std::shared_ptr<NodeTreeExecutor> EagerNodeTreeExecutor::clone_empty() const
 {
     return std::make_shared<EagerNodeTreeExecutor>();
@@ -1,5 +1,6 @@
 #include "nodes/core/node_tree.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <set>
 #include <stack>
@@ -18,11 +19,6 @@
     } while (0)
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
-struct NodeGroupStorage {
-    std::shared_ptr<NodeTreeExecutor> executor = nullptr;
-    static constexpr bool has_storage = false;
-};
-
 NodeTreeDescriptor::NodeTreeDescriptor()
 {
     register_node(
@@ -33,64 +29,49 @@ NodeTreeDescriptor::NodeTreeDescriptor()
                 b.add_output_group(OutsideOutputsPH);
             })
             .set_execution_function([](ExeParams params) {
-                auto group_storage = params.get_storage<NodeGroupStorage&>();
+                auto& group = static_cast<const NodeGroup&>(params.node_);
+
+                auto& group_storage = params.get_storage<NodeGroupStorage&>();
                 if (group_storage.executor == nullptr) {
                     group_storage.executor =
                         params.get_executor()->clone_empty();
                 }
+                auto& executor = *group_storage.executor;
 
                 auto subtree = params.get_subtree();
+                executor.prepare_tree(subtree);
 
-                auto input_group = params.get_input_group(OutsideInputsPH);
-
-                group_storage.executor->prepare_tree(subtree);
-
-                auto [input_node, output_node] = [subtree]() {
-                    Node* input_node;
-                    Node* output_node;
-                    for (auto& node : subtree->nodes) {
-                        {
-                            if (node->typeinfo->id_name ==
-                                NODE_GROUP_IN_IDENTIFIER) {
-                                input_node = node.get();
-                            }
-                            else if (
-                                node->typeinfo->id_name ==
-                                NODE_GROUP_OUT_IDENTIFIER) {
-                                output_node = node.get();
-                            }
-                        }
-                    }
-                    return std::make_pair(input_node, output_node);
-                }();
-                auto output_sockets = input_node->get_outputs();
+                auto input_group = params.take_input_group(OutsideInputsPH);
+                auto& output_sockets = group.group_in->get_outputs();
 
                 assert(input_group.size() == output_sockets.size() - 1);
 
-                for (int i = 0; i < input_group.size(); i++) {
+                for (size_t i = 0; i < input_group.size(); i++) {
                     if (input_group[i]) {
-                        group_storage.executor->sync_node_from_external_storage(
-                            output_sockets[i], *input_group[i]);
+                        executor.sync_node_from_external_storage(
+                            output_sockets[i], std::move(input_group[i]));
                     }
                 }
-                group_storage.executor->execute_tree(subtree);
+                executor.execute_tree(subtree);
 
-                auto input_sockets = output_node->get_inputs();
+                auto& input_sockets = group.group_out->get_inputs();
 
                 std::vector<entt::meta_any> output_group;
+                output_group.reserve(input_sockets.size());
 
-                for (int i = 0; i < input_sockets.size(); i++) {
+                for (size_t i = 0; i < input_sockets.size(); i++) {
                     entt::meta_any data;
-                    group_storage.executor->sync_node_to_external_storage(
+                    executor.move_node_to_external_storage(
                         input_sockets[i], data);
 
                     if (data) {
-                        output_group.push_back(data);
+                        output_group.push_back(std::move(data));
                     }
                 }
 
                 if (output_group.size() == input_sockets.size() - 1) {
-                    params.set_output_group(OutsideOutputsPH, output_group);
+                    params.set_output_group(
+                        OutsideOutputsPH, std::move(output_group));
                     return true;
                 }
                 else {
@@ -121,6 +102,12 @@ NodeTreeDescriptor::NodeTreeDescriptor()
           { "simulation_in", "Simulation Out", PinKind::Output },
           { "simulation_out", "Simulation In", PinKind::Input },
           { "simulation_out", "Simulation Out", PinKind::Output } });
+
+    add_socket_group_syncronization(
+        { { "iteration_begin", "Iteration In", PinKind::Input },
+          { "iteration_begin", "Iteration Out", PinKind::Output },
+          { "iteration_end", "Iteration In", PinKind::Input },
+          { "iteration_end", "Iteration Out", PinKind::Output } });
 }
 
 NodeTreeDescriptor::~NodeTreeDescriptor()
@@ -148,14 +135,32 @@ NodeTreeDescriptor& NodeTreeDescriptor::add_socket_group_syncronization(
     return *this;
 }
 
-const NodeTypeInfo* NodeTreeDescriptor::get_node_type(
-    const std::string& name) const
+const NodeTypeInfo* NodeTreeDescriptor::get_node_type(const std::string& name)
 {
     auto it = node_registry.find(name);
-    if (it != node_registry.end()) {
-        return &it->second;
+    if (it == node_registry.end()) {
+        return nullptr;
     }
-    return nullptr;
+
+    auto& type_info = it->second;
+    std::lock_guard lock(loading_mutex);
+    if (type_info.loader) {
+        // Kept until it succeeds, so a failed load is tried again.
+        type_info.loader(type_info);
+        type_info.loader = nullptr;
+    }
+    return &type_info;
+}
+
+bool NodeTreeDescriptor::is_node_type_loaded(const std::string& name) const
+{
+    auto it = node_registry.find(name);
+    if (it == node_registry.end()) {
+        return false;
+    }
+
+    std::lock_guard lock(loading_mutex);
+    return it->second.is_loaded();
 }
 
 std::string NodeTreeDescriptor::conversion_node_name(
@@ -274,6 +279,17 @@ bool NodeTree::GetDirty()
     return dirty_;
 }
 
+uint64_t NodeTree::structure_revision() const
+{
+    return structure_revision_;
+}
+
+void NodeTree::mark_structure_changed()
+{
+    static std::atomic<uint64_t> last_revision = 0;
+    structure_revision_ = ++last_revision;
+}
+
 void NodeTree::clear()
 {
     links.clear();
@@ -283,6 +299,7 @@ void NodeTree::clear()
     output_sockets.clear();
     toposort_right_to_left.clear();
     toposort_left_to_right.clear();
+    mark_structure_changed();
 }
 
 Node* NodeTree::find_node(NodeId id) const
@@ -346,6 +363,7 @@ Node* NodeTree::add_node(const char* idname)
     auto bare = node.get();
     nodes.push_back(std::move(node));
     bare->refresh_node();
+    mark_structure_changed();
     return bare;
 }
 
@@ -411,11 +429,10 @@ template<
     typename NodePtrContainer,
     typename NodeLinkPtrContainer,
     typename NodeSocketPtrContainer>
-std::string tree_serialize(
+nlohmann::json tree_to_json(
     const NodePtrContainer& nodes,
     const NodeLinkPtrContainer& links,
-    const NodeSocketPtrContainer& sockets,
-    const std::string& ui_settings = "{}")
+    const NodeSocketPtrContainer& sockets)
 {
     nlohmann::json value;
 
@@ -433,7 +450,13 @@ std::string tree_serialize(
     for (auto&& socket : sockets) {
         socket->Serialize(sockets_info);
     }
+    return value;
+}
 
+static std::string dump_tree_json(
+    const nlohmann::json& value,
+    const std::string& ui_settings)
+{
     std::ostringstream s;
     s << value.dump();
 
@@ -449,6 +472,19 @@ std::string tree_serialize(
     return node_serialize;
 }
 
+template<
+    typename NodePtrContainer,
+    typename NodeLinkPtrContainer,
+    typename NodeSocketPtrContainer>
+std::string tree_serialize(
+    const NodePtrContainer& nodes,
+    const NodeLinkPtrContainer& links,
+    const NodeSocketPtrContainer& sockets,
+    const std::string& ui_settings = "{}")
+{
+    return dump_tree_json(tree_to_json(nodes, links, sockets), ui_settings);
+}
+
 // remembder to adopt the node!
 static NodeGroup* create_group_node(NodeTree* tree)
 {
@@ -697,6 +733,7 @@ NodeLink* NodeTree::add_link(
         link->to_sock = tosock;
         bare_ptr = link.get();
         links.push_back(std::move(link));
+        mark_structure_changed();
     }
     else if (descriptor_->can_convert(fromsock->type_info, tosock->type_info)) {
         std::string conversion_node_name;
@@ -806,6 +843,7 @@ void NodeTree::delete_link(
         else {
             links.erase(link);
         }
+        mark_structure_changed();
     }
     if (refresh_topology) {
         ensure_topology_cache();
@@ -923,6 +961,7 @@ void NodeTree::delete_socket(SocketID socketId, bool force_group_delete)
     if (force_group_delete || !socket_in_group)
         if (id != sockets.end()) {
             sockets.erase(id);
+            mark_structure_changed();
         }
 }
 
@@ -1142,6 +1181,7 @@ void NodeTree::ensure_topology_cache()
     update_socket_vectors_and_owner_node();
     update_directly_linked_links_and_sockets();
     update_toposort();
+    mark_structure_changed();
 }
 
 void NodeTree::update_toposort()
@@ -1163,6 +1203,16 @@ std::string NodeTree::serialize() const
     return tree_serialize(nodes, links, sockets, ui_settings);
 }
 
+NodeTreeSerialization NodeTree::serialize_snapshot() const
+{
+    return { tree_to_json(nodes, links, sockets), ui_settings };
+}
+
+std::string NodeTreeSerialization::dump() const
+{
+    return dump_tree_json(value, ui_settings);
+}
+
 void NodeTree::deserialize(const std::string& str)
 {
     nlohmann::json value;
@@ -0,0 +1,89 @@
+#include "nodes/core/simulation_zone.hpp"
+
+#include <iterator>
+#include <utility>
+
+#include "Logger/Logger.h"
+#include "nodes/core/api.hpp"
+#include "nodes/core/node_exec.hpp"
+#include "nodes/core/socket.hpp"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+// simulation_out works on the storage of the simulation_in it is paired with.
+static SimulationStorage& zone_storage(ExeParams& params)
+{
+    auto simulation_in = params.node_.paired_node;
+    if (!simulation_in) {
+        return params.get_storage<SimulationStorage&>();
+    }
+    if (!simulation_in->storage) {
+        simulation_in->storage =
+            get_socket_type<SimulationStorage>().construct();
+    }
+    return simulation_in->storage.cast<SimulationStorage&>();
+}
+
+bool execute_simulation_in(ExeParams& params, bool simulating)
+{
+    auto& state = params.get_storage<SimulationStorage&>().committed;
+
+    // Before the first step finished the zone starts from its inputs.
+    if (!simulating || state.empty()) {
+        params.set_output_group(
+            "Simulation Out", params.take_input_group("Simulation In"));
+        return true;
+    }
+
+    auto input_count = params.get_input_group("Simulation In").size();
+    if (state.size() != input_count) {
+        log::warning(
+            "The simulation state has %zu values but the zone has %zu, "
+            "restart the simulation.",
+            state.size(),
+            input_count);
+        return false;
+    }
+
+    params.set_output_group("Simulation Out", std::move(state));
+    state.clear();
+    return true;
+}
+
+bool execute_simulation_out(ExeParams& params)
+{
+    auto& storage = zone_storage(params);
+    auto values = params.take_input_group("Simulation In");
+    storage.in_flight.assign(
+        std::make_move_iterator(values.begin()),
+        std::make_move_iterator(values.end()));
+
+    for (auto& value : storage.in_flight) {
+        if (!value.data()) {
+            log::warning("The simulation step did not produce its state.");
+            storage.in_flight.clear();
+            return false;
+        }
+    }
+    std::swap(storage.committed, storage.in_flight);
+    storage.in_flight.clear();
+    auto& state = storage.committed;
+
+    // Only outputs read after the zone need a copy of the state, the others
+    // keep a default value of their type.
+    auto output_ids =
+        params.node_.find_socket_group_ids("Simulation Out", PinKind::Output);
+    std::vector<entt::meta_any> outputs;
+    outputs.reserve(output_ids.size());
+    for (size_t i = 0; i < output_ids.size(); ++i) {
+        auto socket = params.node_.get_outputs()[output_ids[i]];
+        if (!socket->directly_linked_sockets.empty() && i < state.size()) {
+            outputs.push_back(state[i]);
+        }
+        else {
+            outputs.push_back(socket->type_info.construct());
+        }
+    }
+    params.set_output_group("Simulation Out", std::move(outputs));
+    return true;
+}
+USTC_CG_NAMESPACE_CLOSE_SCOPE
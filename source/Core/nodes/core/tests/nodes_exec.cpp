@@ -4,10 +4,45 @@
 
 #include "nodes/core/api.hpp"
 #include "nodes/core/node.hpp"
+#include "nodes/core/node_exec_eager.hpp"
 #include "nodes/core/node_tree.hpp"
+#include "nodes/core/simulation_zone.hpp"
 
 using namespace USTC_CG;
 
+// Counts the copies made while it travels through a tree. Assigning a
+// default constructed counter is how the executor resets a value, it is
+// counted apart.
+struct CopyCounter {
+    int value = 0;
+    bool is_default = true;
+    static inline int copies = 0;
+    static inline int resets = 0;
+
+    CopyCounter() = default;
+    CopyCounter(int value) : value(value), is_default(false)
+    {
+    }
+    CopyCounter(const CopyCounter& other)
+        : value(other.value),
+          is_default(other.is_default)
+    {
+        ++copies;
+    }
+    CopyCounter(CopyCounter&&) noexcept = default;
+    CopyCounter& operator=(const CopyCounter& other)
+    {
+        value = other.value;
+        is_default = other.is_default;
+        ++(other.is_default ? resets : copies);
+        return *this;
+    }
+    CopyCounter& operator=(CopyCounter&&) noexcept = default;
+};
+
+static bool simulating = false;
+static int pure_executions = 0;
+
 class NodeExecTest : public ::testing::Test {
    protected:
     void SetUp() override
@@ -40,6 +75,97 @@ class NodeExecTest : public ::testing::Test {
 
         descriptor->register_node(add_node);
 
+        register_cpp_type<CopyCounter>();
+
+        NodeTypeInfo simulation_in;
+        simulation_in.id_name = "simulation_in";
+        simulation_in.ui_name = "Simulation In";
+        simulation_in.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input_group("Simulation In");
+            b.add_output_group("Simulation Out");
+        });
+        simulation_in.set_execution_function([](ExeParams params) {
+            return execute_simulation_in(params, simulating);
+        });
+        descriptor->register_node(simulation_in);
+
+        NodeTypeInfo simulation_out;
+        simulation_out.id_name = "simulation_out";
+        simulation_out.ui_name = "Simulation Out";
+        simulation_out.ALWAYS_REQUIRED = true;
+        simulation_out.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input_group("Simulation In");
+            b.add_output_group("Simulation Out");
+        });
+        simulation_out.set_execution_function(
+            [](ExeParams params) { return execute_simulation_out(params); });
+        descriptor->register_node(simulation_out);
+
+        NodeTypeInfo step;
+        step.id_name = "step";
+        step.ui_name = "Step";
+        step.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input<CopyCounter>("state");
+            b.add_output<CopyCounter>("state");
+        });
+        step.set_execution_function([](ExeParams params) {
+            auto state = params.get_input<CopyCounter>("state");
+            state.value += 1;
+            params.set_output("state", std::move(state));
+            return true;
+        });
+        descriptor->register_node(step);
+
+        NodeTypeInfo advance;
+        advance.id_name = "advance";
+        advance.ui_name = "Advance";
+        advance.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input<CopyCounter>("state");
+            b.add_output<CopyCounter>("state");
+        });
+        advance.set_execution_function([](ExeParams params) {
+            auto state = params.take_input<CopyCounter>("state");
+            state.value += 1;
+            params.set_output("state", std::move(state));
+            return true;
+        });
+        descriptor->register_node(advance);
+
+        NodeTypeInfo pure_add;
+        pure_add.id_name = "pure_add";
+        pure_add.ui_name = "Pure Add";
+        pure_add.set_pure(true);
+        pure_add.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input<int>("a");
+            b.add_input<int>("b").default_val(1);
+            b.add_output<int>("result");
+        });
+        pure_add.set_execution_function([](ExeParams params) {
+            ++pure_executions;
+            params.set_output(
+                "result",
+                params.get_input<int>("a") + params.get_input<int>("b"));
+            return true;
+        });
+        descriptor->register_node(pure_add);
+
+        // Leaves its output unset for a zero input.
+        NodeTypeInfo nonzero;
+        nonzero.id_name = "nonzero";
+        nonzero.ui_name = "Nonzero";
+        nonzero.set_declare_function([](NodeDeclarationBuilder& b) {
+            b.add_input<int>("a");
+            b.add_output<int>("result");
+        });
+        nonzero.set_execution_function([](ExeParams params) {
+            auto a = params.get_input<int>("a");
+            if (a != 0) {
+                params.set_output("result", a);
+            }
+            return true;
+        });
+        descriptor->register_node(nonzero);
+
         tree = create_node_tree(descriptor);
     }
 
@@ -121,6 +247,116 @@ class NodeExecTest : public ::testing::Test {
     ASSERT_EQ(result.cast<int>(), 41);
 }
 
+TEST_F(NodeExecTest, NodeExecReusesValues)
+{
+    EagerNodeTreeExecutor executor;
+
+    std::vector<Node*> add_nodes;
+    for (int i = 0; i < 4; i++) {
+        add_nodes.push_back(tree->add_node("add"));
+    }
+    for (int i = 0; i < add_nodes.size() - 1; i++) {
+        tree->add_link(
+            add_nodes[i]->get_output_socket("result"),
+            add_nodes[i + 1]->get_input_socket("a"));
+    }
+
+    for (int run = 0; run < 3; ++run) {
+        executor.reset_value_pool_statistics();
+        executor.prepare_tree(tree.get());
+        executor.sync_node_from_external_storage(
+            add_nodes[0]->get_input_socket("a"), run);
+        executor.execute_tree(tree.get());
+
+        entt::meta_any result;
+        executor.sync_node_to_external_storage(
+            add_nodes.back()->get_output_socket("result"), result);
+        ASSERT_EQ(result.cast<int>(), run + 4);
+
+        // Only the first run builds the values of the sockets.
+        auto& statistics = executor.value_pool_statistics();
+        if (run == 0) {
+            EXPECT_GT(statistics.constructed, 0);
+        }
+        else {
+            EXPECT_EQ(statistics.constructed, 0);
+            EXPECT_GT(statistics.reused, 0);
+        }
+    }
+}
+
+TEST_F(NodeExecTest, NodeExecResetsUnsetOutputs)
+{
+    EagerNodeTreeExecutor executor;
+
+    auto nonzero = tree->add_node("nonzero");
+    auto add = tree->add_node("add");
+    tree->add_link(
+        nonzero->get_output_socket("result"), add->get_input_socket("a"));
+
+    auto run = [&](int a) {
+        executor.prepare_tree(tree.get());
+        executor.sync_node_from_external_storage(
+            nonzero->get_input_socket("a"), a);
+        executor.execute_tree(tree.get());
+
+        entt::meta_any result;
+        executor.sync_node_to_external_storage(
+            add->get_output_socket("result"), result);
+        return result.cast<int>();
+    };
+
+    EXPECT_EQ(run(5), 6);
+    // The output of the last run is not passed on.
+    EXPECT_EQ(run(0), 1);
+}
+
+TEST_F(NodeExecTest, NodeExecMemoizesPureNodes)
+{
+    EagerNodeTreeExecutor executor;
+
+    auto pure = tree->add_node("pure_add");
+    auto add = tree->add_node("add");
+    tree->add_link(
+        pure->get_output_socket("result"), add->get_input_socket("a"));
+
+    auto run = [&](int a) {
+        executor.prepare_tree(tree.get());
+        executor.sync_node_from_external_storage(
+            pure->get_input_socket("a"), a);
+        executor.execute_tree(tree.get());
+
+        entt::meta_any result;
+        executor.sync_node_to_external_storage(
+            add->get_output_socket("result"), result);
+        return result.cast<int>();
+    };
+
+    pure_executions = 0;
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(pure_executions, 1);
+
+    EXPECT_EQ(run(2), 4);
+    EXPECT_EQ(pure_executions, 2);
+
+    // Both inputs are still in the memo.
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(pure_executions, 2);
+
+    // Only the last call is kept.
+    executor.set_memo_capacity(1);
+    EXPECT_EQ(run(2), 4);
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(pure_executions, 4);
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(pure_executions, 4);
+
+    executor.clear_memo();
+    EXPECT_EQ(run(1), 3);
+    EXPECT_EQ(pure_executions, 5);
+}
+
 TEST_F(NodeExecTest, NodeExecWithLinkAndNodeGroup)
 {
     NodeTreeExecutorDesc desc;
@@ -161,3 +397,121 @@ TEST_F(NodeExecTest, NodeExecWithLinkAndNodeGroup)
 
     std::cout << value_out.cast<int>() << std::endl;
 }
+
+TEST_F(NodeExecTest, NodeExecNodeGroupMovesValues)
+{
+    NodeTreeExecutorDesc desc;
+    desc.policy = NodeTreeExecutorDesc::Policy::Eager;
+    auto executor = create_node_tree_executor(desc);
+
+    auto first = tree->add_node("step");
+    auto grouped = tree->add_node("step");
+    auto last = tree->add_node("step");
+    tree->add_link(
+        first->get_output_socket("state"), grouped->get_input_socket("state"));
+    tree->add_link(
+        grouped->get_output_socket("state"), last->get_input_socket("state"));
+    auto group = tree->group_up({ grouped });
+    ASSERT_TRUE(group);
+
+    for (int run = 0; run < 3; ++run) {
+        executor->prepare_tree(tree.get(), last);
+        executor->sync_node_from_external_storage(
+            first->get_input_socket("state"), CopyCounter(run));
+
+        CopyCounter::copies = 0;
+        executor->execute_tree(tree.get());
+
+        // Each step node copies its input, the group itself never does.
+        // Later runs also reset the values the subtree kept.
+        EXPECT_EQ(CopyCounter::copies, 3);
+
+        entt::meta_any value;
+        executor->sync_node_to_external_storage(
+            last->get_output_socket("state"), value);
+        ASSERT_TRUE(value);
+        EXPECT_EQ(value.cast<CopyCounter&>().value, run + 3);
+    }
+
+    // The group keeps its executor, the subtree is compiled once.
+    ASSERT_TRUE(group->storage);
+    auto group_executor = std::dynamic_pointer_cast<EagerNodeTreeExecutor>(
+        group->storage.cast<NodeGroupStorage&>().executor);
+    ASSERT_TRUE(group_executor);
+    EXPECT_EQ(group_executor->compile_count(), 1);
+}
+
+TEST_F(NodeExecTest, NodeExecSimulationZoneKeepsState)
+{
+    NodeTreeExecutorDesc desc;
+    desc.policy = NodeTreeExecutorDesc::Policy::Eager;
+    auto executor = create_node_tree_executor(desc);
+
+    auto begin = tree->add_node("simulation_in");
+    auto end = tree->add_node("simulation_out");
+    begin->paired_node = end;
+    end->paired_node = begin;
+
+    auto counter_type = type_name<CopyCounter>();
+    begin->group_add_socket(
+        "Simulation In", counter_type.c_str(), "x", "x", PinKind::Input);
+    begin->group_add_socket(
+        "Simulation Out", counter_type.c_str(), "x", "x", PinKind::Output);
+    end->group_add_socket(
+        "Simulation In", counter_type.c_str(), "x", "x", PinKind::Input);
+    end->group_add_socket(
+        "Simulation Out", counter_type.c_str(), "x", "x", PinKind::Output);
+
+    auto step = tree->add_node("advance");
+    tree->add_link(
+        begin->get_output_socket("x"), step->get_input_socket("state"));
+    tree->add_link(
+        step->get_output_socket("state"), end->get_input_socket("x"));
+
+    for (int frame = 0; frame < 3; ++frame) {
+        simulating = frame > 0;
+        executor->prepare_tree(tree.get());
+        executor->sync_node_from_external_storage(
+            begin->get_input_socket("x"), CopyCounter(0));
+
+        CopyCounter::copies = 0;
+        executor->execute_tree(tree.get());
+
+        // The state is moved from the committed buffer through the step
+        // into the in flight one, and never copied.
+        EXPECT_EQ(CopyCounter::copies, 0);
+
+        // The state waits in simulation_in, simulation_out keeps nothing.
+        EXPECT_FALSE(end->storage);
+        ASSERT_TRUE(begin->storage);
+        auto& storage = begin->storage.cast<SimulationStorage&>();
+        EXPECT_TRUE(storage.in_flight.empty());
+        auto& state = storage.committed;
+        ASSERT_EQ(state.size(), 1);
+        EXPECT_EQ(state[0].cast<CopyCounter&>().value, frame + 1);
+    }
+
+    // A state that no longer matches the zone fails the step instead of
+    // restarting it, and is kept.
+    begin->group_add_socket(
+        "Simulation In", counter_type.c_str(), "y", "y", PinKind::Input);
+    begin->group_add_socket(
+        "Simulation Out", counter_type.c_str(), "y", "y", PinKind::Output);
+    end->group_add_socket(
+        "Simulation In", counter_type.c_str(), "y", "y", PinKind::Input);
+    end->group_add_socket(
+        "Simulation Out", counter_type.c_str(), "y", "y", PinKind::Output);
+
+    executor->prepare_tree(tree.get());
+    executor->sync_node_from_external_storage(
+        begin->get_input_socket("x"), CopyCounter(0));
+    executor->sync_node_from_external_storage(
+        begin->get_input_socket("y"), CopyCounter(0));
+    executor->execute_tree(tree.get());
+    EXPECT_FALSE(begin->execution_failed.empty());
+    ASSERT_TRUE(begin->storage);
+    auto& state = begin->storage.cast<SimulationStorage&>().committed;
+    ASSERT_EQ(state.size(), 1);
+    EXPECT_EQ(state[0].cast<CopyCounter&>().value, 3);
+    simulating = false;
+}
@@ -22,6 +22,26 @@ class NODES_SYSTEM_API NodeSystem {
         bool is_ui_execution = false,
         Node* required_node = nullptr) const;
 
+    // Executes a snapshot of the node tree on a worker thread. A newer call
+    // cancels the execution in flight. Results stay invisible until
+    // consume_background_execution() publishes them to the live tree.
+    void execute_in_background(
+        bool is_ui_execution = false,
+        Node* required_node = nullptr);
+
+    // Publishes the latest finished background execution (node status and
+    // node storage) to the live tree. Returns false if there is nothing new.
+    bool consume_background_execution();
+
+    // The value a socket of the live tree held at the end of the last
+    // published background execution, or nullptr. Read it on the thread that
+    // consumes the executions.
+    [[nodiscard]] const entt::meta_any* find_background_value(
+        NodeSocket* socket) const;
+
+    [[nodiscard]] bool is_executing_in_background() const;
+    void wait_for_background_execution() const;
+
     [[nodiscard]] NodeTree* get_node_tree() const;
     [[nodiscard]] NodeTreeExecutor* get_node_tree_executor() const;
 
@@ -30,8 +50,15 @@ class NODES_SYSTEM_API NodeSystem {
     virtual std::shared_ptr<NodeTreeDescriptor> node_tree_descriptor() = 0;
 
    protected:
+    // Must be called before the executor is released.
+    void stop_background_execution();
+
     std::unique_ptr<NodeTree> node_tree;
     std::unique_ptr<NodeTreeExecutor> node_tree_executor;
+
+   private:
+    struct BackgroundExecution;
+    std::unique_ptr<BackgroundExecution> background_execution;
 };
 
 template<typename T>
@@ -2,6 +2,7 @@
 
 #include <nodes/system/api.h>
 
+#include <memory>
 #include <stdexcept>
 #include <string>
 
@@ -51,6 +52,24 @@ std::function<Func> DynamicLibraryLoader::getFunction(
 #endif
 }
 
+// A library opened the first time one of its nodes is used. Calls to get()
+// are serialized by the descriptor, which loads one type at a time.
+class NODES_SYSTEM_API LazyLibraryLoader {
+   public:
+    explicit LazyLibraryLoader(const std::string& libraryName);
+
+    bool is_loaded() const
+    {
+        return library != nullptr;
+    }
+
+    DynamicLibraryLoader& get();
+
+   private:
+    std::string libraryName;
+    std::unique_ptr<DynamicLibraryLoader> library;
+};
+
 class NODES_SYSTEM_API NodeDynamicLoadingSystem : public NodeSystem {
    protected:
 
@@ -65,7 +84,7 @@ class NODES_SYSTEM_API NodeDynamicLoadingSystem : public NodeSystem {
     bool load_configuration(const std::filesystem::path& config) override;
 
    private:
-    std::unordered_map<std::string, std::unique_ptr<DynamicLibraryLoader>>
+    std::unordered_map<std::string, std::shared_ptr<LazyLibraryLoader>>
         node_libraries;
     std::unordered_map<std::string, std::unique_ptr<DynamicLibraryLoader>>
         conversion_libraries;
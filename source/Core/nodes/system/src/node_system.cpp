@@ -1,8 +1,174 @@
 #include "nodes/system/node_system.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
 #include "nodes/system/node_system_dl.hpp"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Copies of the socket values of an executed snapshot, by socket id. They
+// are taken by the worker while it still owns the executor, so the UI never
+// reads the executor the next job is running on.
+using SocketValues = std::unordered_map<uintptr_t, entt::meta_any>;
+
+// A single worker executing snapshots of the tree. Only the most recent
+// request is kept: posting a new one replaces the pending job and cancels the
+// running one.
+struct NodeSystem::BackgroundExecution {
+    struct Result {
+        std::unique_ptr<NodeTree> snapshot;
+        SocketValues values;
+    };
+
+    struct Job {
+        std::unique_ptr<NodeTree> snapshot;
+        NodeTreeExecutor* executor = nullptr;
+        std::optional<NodeId> required_node;
+    };
+
+    BackgroundExecution() : worker([this] { run(); })
+    {
+    }
+
+    ~BackgroundExecution()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+            pending.reset();
+            if (running_executor) {
+                running_executor->request_cancel();
+            }
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    void post(Job job)
+    {
+        {
+            std::lock_guard lock(mutex);
+            pending = std::move(job);
+            if (running_executor) {
+                running_executor->request_cancel();
+            }
+        }
+        cv.notify_all();
+    }
+
+    void cancel_and_wait()
+    {
+        std::unique_lock lock(mutex);
+        pending.reset();
+        if (running_executor) {
+            running_executor->request_cancel();
+        }
+        idle_cv.wait(lock, [this] { return !running_executor; });
+    }
+
+    void wait()
+    {
+        std::unique_lock lock(mutex);
+        idle_cv.wait(lock, [this] { return !running_executor && !pending; });
+    }
+
+    bool busy()
+    {
+        std::lock_guard lock(mutex);
+        return running_executor || pending;
+    }
+
+    std::optional<Result> take_result()
+    {
+        std::lock_guard lock(mutex);
+        return std::exchange(finished, std::nullopt);
+    }
+
+    // The last published execution, only touched by the thread consuming
+    // the results. The snapshot is kept alive, since the executor still
+    // refers to its sockets until the next execution.
+    std::unique_ptr<NodeTree> displayed;
+    SocketValues displayed_values;
+
+   private:
+    void run()
+    {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [this] { return stop || pending; });
+                if (stop) {
+                    return;
+                }
+                job = std::move(*pending);
+                pending.reset();
+                running_executor = job.executor;
+                running_executor->reset_cancel();
+            }
+
+            Node* required_node = nullptr;
+            if (job.required_node) {
+                required_node = job.snapshot->find_node(*job.required_node);
+            }
+            job.executor->execute(job.snapshot.get(), required_node);
+
+            std::optional<Result> result;
+            if (!job.executor->is_cancel_requested()) {
+                result.emplace();
+                collect_values(*job.snapshot, *job.executor, result->values);
+                result->snapshot = std::move(job.snapshot);
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                if (result && !job.executor->is_cancel_requested()) {
+                    finished = std::move(result);
+                }
+                running_executor = nullptr;
+            }
+            idle_cv.notify_all();
+        }
+    }
+
+    static void collect_values(
+        NodeTree& snapshot,
+        NodeTreeExecutor& executor,
+        SocketValues& values)
+    {
+        auto collect = [&](const std::vector<NodeSocket*>& sockets) {
+            for (auto socket : sockets) {
+                entt::meta_any value;
+                executor.sync_node_to_external_storage(socket, value);
+                if (value) {
+                    values[socket->ID.Get()] = std::move(value);
+                }
+            }
+        };
+        for (auto&& node : snapshot.nodes) {
+            collect(node->get_inputs());
+            collect(node->get_outputs());
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable idle_cv;
+
+    std::optional<Job> pending;
+    NodeTreeExecutor* running_executor = nullptr;
+    std::optional<Result> finished;
+    bool stop = false;
+
+    // Declared last so that all the state above exists when it starts.
+    std::thread worker;
+};
+
 void NodeSystem::init()
 {
     this->node_tree = create_node_tree(node_tree_descriptor());
@@ -11,15 +177,18 @@ void NodeSystem::init()
 void NodeSystem::set_node_tree_executor(
     std::unique_ptr<NodeTreeExecutor> executor)
 {
+    stop_background_execution();
     node_tree_executor = std::move(executor);
 }
 
 NodeSystem::~NodeSystem()
 {
+    stop_background_execution();
 }
 
 void NodeSystem::finalize()
 {
+    stop_background_execution();
     if (node_tree_executor) {
         node_tree_executor->finalize(node_tree.get());
     }
@@ -30,11 +199,102 @@ void NodeSystem::execute(bool is_ui_execution, Node* required_node) const
     if (is_ui_execution && !allow_ui_execution) {
         return;
     }
+    if (background_execution) {
+        background_execution->cancel_and_wait();
+    }
     if (node_tree_executor) {
         return node_tree_executor->execute(node_tree.get(), required_node);
     }
 }
 
+void NodeSystem::execute_in_background(
+    bool is_ui_execution,
+    Node* required_node)
+{
+    if (is_ui_execution && !allow_ui_execution) {
+        return;
+    }
+    if (!node_tree_executor) {
+        return;
+    }
+
+    BackgroundExecution::Job job;
+    job.snapshot = std::make_unique<NodeTree>(*node_tree);
+    job.executor = node_tree_executor.get();
+    if (required_node) {
+        job.required_node = required_node->ID;
+    }
+
+    // Runtime storage is not serialized, carry it over by hand.
+    for (auto&& node : node_tree->nodes) {
+        if (node->storage) {
+            if (auto copied = job.snapshot->find_node(node->ID)) {
+                copied->storage = node->storage;
+            }
+        }
+    }
+
+    if (!background_execution) {
+        background_execution = std::make_unique<BackgroundExecution>();
+    }
+    background_execution->post(std::move(job));
+}
+
+bool NodeSystem::consume_background_execution()
+{
+    if (!background_execution) {
+        return false;
+    }
+    auto result = background_execution->take_result();
+    if (!result) {
+        return false;
+    }
+
+    for (auto&& executed : result->snapshot->nodes) {
+        auto node = node_tree->find_node(executed->ID);
+        if (!node) {
+            continue;
+        }
+        node->REQUIRED = executed->REQUIRED;
+        node->MISSING_INPUT = executed->MISSING_INPUT;
+        node->execution_failed = executed->execution_failed;
+        node->storage = std::move(executed->storage);
+        node->storage_info = executed->storage_info;
+    }
+
+    background_execution->displayed = std::move(result->snapshot);
+    background_execution->displayed_values = std::move(result->values);
+    return true;
+}
+
+const entt::meta_any* NodeSystem::find_background_value(
+    NodeSocket* socket) const
+{
+    if (!background_execution) {
+        return nullptr;
+    }
+    auto& values = background_execution->displayed_values;
+    auto it = values.find(socket->ID.Get());
+    return it != values.end() ? &it->second : nullptr;
+}
+
+bool NodeSystem::is_executing_in_background() const
+{
+    return background_execution && background_execution->busy();
+}
+
+void NodeSystem::wait_for_background_execution() const
+{
+    if (background_execution) {
+        background_execution->wait();
+    }
+}
+
+void NodeSystem::stop_background_execution()
+{
+    background_execution.reset();
+}
+
 NodeTree* NodeSystem::get_node_tree() const
 {
     return node_tree.get();
@@ -50,4 +310,4 @@ std::shared_ptr<NodeSystem> create_dynamic_loading_system()
     return std::make_shared<NodeDynamicLoadingSystem>();
 }
 
-USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
+USTC_CG_NAMESPACE_CLOSE_SCOPE
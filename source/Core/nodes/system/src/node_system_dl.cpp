@@ -40,6 +40,19 @@ DynamicLibraryLoader::~DynamicLibraryLoader()
 #endif
 }
 
+LazyLibraryLoader::LazyLibraryLoader(const std::string& libraryName)
+    : libraryName(libraryName)
+{
+}
+
+DynamicLibraryLoader& LazyLibraryLoader::get()
+{
+    if (!library) {
+        library = std::make_unique<DynamicLibraryLoader>(libraryName);
+    }
+    return *library;
+}
+
 std::shared_ptr<NodeTreeDescriptor>
 NodeDynamicLoadingSystem::node_tree_descriptor()
 {
@@ -53,6 +66,7 @@ NodeDynamicLoadingSystem::NodeDynamicLoadingSystem()
 
 NodeDynamicLoadingSystem::~NodeDynamicLoadingSystem()
 {
+    stop_background_execution();
     descriptor = {};
     this->node_tree.reset();
     this->node_tree_executor.reset();
@@ -74,68 +88,84 @@ bool NodeDynamicLoadingSystem::load_configuration(
     config_file >> j;
     config_file.close();
 
-    auto load_libraries = [&](const nlohmann::json& json_section,
-                              auto& library_map,
-                              const std::string& extension,
-                              bool is_conversion) {
-        for (auto it = json_section.begin(); it != json_section.end(); ++it) {
-            std::string key = it.key();
-            auto func_names = it.value();
-
-            library_map[key] =
-                std::make_unique<DynamicLibraryLoader>(key + extension);
-
-            for (auto&& func_name : func_names) {
-                auto func_name_str = func_name.get<std::string>();
-                auto node_ui_name =
-                    library_map[key]->template getFunction<const char*()>(
-                        "node_ui_name_" + func_name_str);
-
-                auto node_id_name =
-                    library_map[key]->template getFunction<std::string()>(
-                        "node_id_name_" + func_name_str);
-
-                auto node_always_requred =
-                    library_map[key]->template getFunction<bool()>(
-                        "node_required_" + func_name_str);
-
-                auto node_declare =
-                    library_map[key]
-                        ->template getFunction<void(NodeDeclarationBuilder&)>(
-                            "node_declare_" + func_name_str);
-                auto node_execution =
-                    library_map[key]->template getFunction<bool(ExeParams)>(
-                        "node_execution_" + func_name_str);
-
-                NodeTypeInfo new_node;
-
-                if (is_conversion) {
-                    new_node.id_name =
-                        node_id_name();  // For a conversion node, id name must
-                                         // exist.
-                    new_node.ui_name = "invisible";
-                    new_node.INVISIBLE = true;
-                    descriptor->register_conversion_name(node_id_name());
-                }
-                else {
-                    new_node.id_name =
-                        node_id_name ? node_id_name() : func_name_str;
-                    new_node.ui_name =
-                        node_ui_name ? node_ui_name() : new_node.id_name;
-                }
+    auto load_functions = [](DynamicLibraryLoader& library,
+                             const std::string& func_name_str,
+                             NodeTypeInfo& type_info) {
+        auto node_declare =
+            library.getFunction<void(NodeDeclarationBuilder&)>(
+                "node_declare_" + func_name_str);
+        auto node_execution = library.getFunction<bool(ExeParams)>(
+            "node_execution_" + func_name_str);
+
+        type_info.set_declare_function(node_declare);
+        type_info.set_execution_function(node_execution);
+    };
+
+    auto register_loaded = [&](DynamicLibraryLoader& library,
+                               const std::string& func_name_str,
+                               bool is_conversion) {
+        auto node_ui_name =
+            library.getFunction<const char*()>("node_ui_name_" + func_name_str);
+
+        auto node_id_name =
+            library.getFunction<std::string()>("node_id_name_" + func_name_str);
+
+        auto node_always_requred =
+            library.getFunction<bool()>("node_required_" + func_name_str);
+
+        auto node_pure =
+            library.getFunction<bool()>("node_pure_" + func_name_str);
+
+        NodeTypeInfo new_node;
+
+        if (is_conversion) {
+            new_node.id_name = node_id_name();  // For a conversion node, id
+                                                // name must exist.
+            new_node.ui_name = "invisible";
+            new_node.INVISIBLE = true;
+            descriptor->register_conversion_name(node_id_name());
+        }
+        else {
+            new_node.id_name = node_id_name ? node_id_name() : func_name_str;
+            new_node.ui_name = node_ui_name ? node_ui_name() : new_node.id_name;
+        }
+
+        new_node.ALWAYS_REQUIRED =
+            node_always_requred ? node_always_requred() : false;
+        if (new_node.ALWAYS_REQUIRED) {
+            log::info("%s is always required.", func_name_str.c_str());
+        }
+        new_node.PURE = node_pure ? node_pure() : false;
+        load_functions(library, func_name_str, new_node);
+
+        descriptor->register_node(new_node);
+    };
 
-                new_node.ALWAYS_REQUIRED =
-                    node_always_requred ? node_always_requred() : false;
+    // Takes what the library would report from the manifest, leaving the
+    // functions to the loader.
+    auto register_from_manifest =
+        [&](const nlohmann::json& entries,
+            const std::shared_ptr<LazyLibraryLoader>& library) {
+            for (auto&& entry : entries) {
+                auto func_name_str = entry["id"].get<std::string>();
+
+                NodeTypeInfo new_node(func_name_str.c_str());
+                new_node.ui_name = entry.value("ui_name", func_name_str);
+                new_node.ALWAYS_REQUIRED = entry.value("required", false);
                 if (new_node.ALWAYS_REQUIRED) {
                     log::info("%s is always required.", func_name_str.c_str());
                 }
-                new_node.set_declare_function(node_declare);
-                new_node.set_execution_function(node_execution);
+                new_node.PURE = entry.value("pure", false);
+                new_node.set_loader(
+                    [library, func_name_str, load_functions](
+                        NodeTypeInfo& type_info) {
+                        load_functions(
+                            library->get(), func_name_str, type_info);
+                    });
 
                 descriptor->register_node(new_node);
             }
-        }
-    };
+        };
 
 #ifdef _WIN32
     std::string extension = ".dll";
@@ -143,8 +173,38 @@ bool NodeDynamicLoadingSystem::load_configuration(
     std::string extension = ".so";
 #endif
 
-    load_libraries(j["nodes"], node_libraries, extension, false);
-    load_libraries(j["conversions"], conversion_libraries, extension, true);
+    // Libraries with a manifest entry are only opened once one of their nodes
+    // is used. Conversions are always loaded, as their ids are made of type
+    // names only known to the library.
+    auto manifest = j.value("manifest", nlohmann::json::object());
+
+    auto& nodes = j["nodes"];
+    for (auto it = nodes.begin(); it != nodes.end(); ++it) {
+        std::string key = it.key();
+        auto library = std::make_shared<LazyLibraryLoader>(key + extension);
+        node_libraries[key] = library;
+
+        if (manifest.contains(key)) {
+            register_from_manifest(manifest[key], library);
+        }
+        else {
+            for (auto&& func_name : it.value()) {
+                register_loaded(
+                    library->get(), func_name.get<std::string>(), false);
+            }
+        }
+    }
+
+    auto& conversions = j["conversions"];
+    for (auto it = conversions.begin(); it != conversions.end(); ++it) {
+        std::string key = it.key();
+        auto& library = conversion_libraries[key] =
+            std::make_unique<DynamicLibraryLoader>(key + extension);
+
+        for (auto&& func_name : it.value()) {
+            register_loaded(*library, func_name.get<std::string>(), true);
+        }
+    }
 
     return true;
 }
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "Logger/Logger.h"
+#include "test_node/test_payload.hpp"
 
 using namespace USTC_CG;
 
@@ -48,6 +49,32 @@ TEST(NodeSystem, LoadDyLibExecution)
     dl_load_system->init();
 }
 
+TEST(NodeSystem, LazyLoading)
+{
+    auto dl_load_system = create_dynamic_loading_system();
+    auto loaded = dl_load_system->load_configuration("test_nodes.json");
+    ASSERT_TRUE(loaded);
+    dl_load_system->init();
+
+    auto tree = dl_load_system->get_node_tree();
+    // Registered from the manifest, the library is not opened yet.
+    ASSERT_FALSE(tree->get_descriptor()->is_node_type_loaded("add"));
+
+    auto node = tree->add_node("add");
+    ASSERT_TRUE(node);
+
+    // The ui name comes from the manifest, the declaration from the library
+    // opened on the way.
+    ASSERT_EQ(node->ui_name, "Add");
+    ASSERT_TRUE(node->typeinfo->is_loaded());
+    ASSERT_TRUE(tree->get_descriptor()->is_node_type_loaded("add"));
+    ASSERT_EQ(node->typeinfo->static_declaration.inputs.size(), 2u);
+
+    auto print = tree->get_descriptor()->get_node_type("print");
+    ASSERT_TRUE(print);
+    ASSERT_TRUE(print->ALWAYS_REQUIRED);
+}
+
 void print_tree_info(const NodeTree* tree)
 {
     std::cout << "Nodes: " << tree->nodes.size() << std::endl;
@@ -81,3 +108,108 @@ TEST(NodeSystem, DynamicSockets)
 
     print_tree_info(tree);
 }
+
+TEST(NodeSystem, IterationZone)
+{
+    auto dl_load_system = create_dynamic_loading_system();
+    ASSERT_TRUE(dl_load_system->load_configuration("test_nodes.json"));
+    ASSERT_TRUE(dl_load_system->load_configuration("basic_nodes.json"));
+    dl_load_system->init();
+
+    auto tree = dl_load_system->get_node_tree();
+    auto begin = tree->add_node("iteration_begin");
+    auto end = tree->add_node("iteration_end");
+    ASSERT_TRUE(begin && end);
+    begin->paired_node = end;
+    end->paired_node = begin;
+
+    auto int_type = type_name<int>();
+    begin->group_add_socket(
+        "Iteration In", int_type.c_str(), "x", "x", PinKind::Input);
+    begin->group_add_socket(
+        "Iteration Out", int_type.c_str(), "x", "x", PinKind::Output);
+    end->group_add_socket(
+        "Iteration In", int_type.c_str(), "x", "x", PinKind::Input);
+    end->group_add_socket(
+        "Iteration Out", int_type.c_str(), "x", "x", PinKind::Output);
+
+    // x = x + 2 inside the zone until x is at least 7, the result is read
+    // after it. The step comes from a node that does not depend on the
+    // iteration.
+    auto body = tree->add_node("add");
+    auto invariant = tree->add_node("count_executions");
+    auto converged = tree->add_node("at_least");
+    auto result = tree->add_node("add");
+    tree->add_link(
+        begin->get_output_socket("x"), body->get_input_socket("value"));
+    tree->add_link(
+        invariant->get_output_socket("value"),
+        body->get_input_socket("value2"));
+    tree->add_link(
+        body->get_output_socket("value"), end->get_input_socket("x"));
+    tree->add_link(
+        body->get_output_socket("value"), converged->get_input_socket("value"));
+    tree->add_link(
+        converged->get_output_socket("result"),
+        end->get_input_socket("Converged"));
+    tree->add_link(
+        end->get_output_socket("x"), result->get_input_socket("value"));
+
+    auto executor = create_node_tree_executor({});
+    executor->prepare_tree(tree, result);
+    executor->sync_node_from_external_storage(
+        begin->get_input_socket("x"), 1);
+    executor->sync_node_from_external_storage(
+        begin->get_input_socket("Count"), 5);
+    executor->sync_node_from_external_storage(
+        invariant->get_input_socket("value"), 2);
+    executor->sync_node_from_external_storage(
+        converged->get_input_socket("bound"), 7);
+    executor->sync_node_from_external_storage(
+        result->get_input_socket("value2"), 0);
+    auto& payload = executor->get_global_payload<TestGlobalPayload&>();
+
+    executor->execute_tree(tree);
+
+    // The loop stops after three of its five iterations, with 1 + 3 * 2.
+    entt::meta_any value;
+    executor->sync_node_to_external_storage(
+        result->get_output_socket("value"), value);
+    ASSERT_EQ(value.cast<int>(), 7);
+
+    // The invariant node is hoisted out of the zone and runs once.
+    EXPECT_EQ(payload.executions, 1);
+}
+
+TEST(NodeSystem, BackgroundExecution)
+{
+    auto dl_load_system = create_dynamic_loading_system();
+    auto loaded = dl_load_system->load_configuration("test_nodes.json");
+    ASSERT_TRUE(loaded);
+    dl_load_system->init();
+    dl_load_system->set_node_tree_executor(create_node_tree_executor({}));
+
+    auto tree = dl_load_system->get_node_tree();
+    auto node = tree->add_node("add");
+    ASSERT_TRUE(node);
+
+    // Later requests supersede earlier ones.
+    for (int i = 0; i < 8; ++i) {
+        dl_load_system->execute_in_background(false, node);
+    }
+    dl_load_system->wait_for_background_execution();
+    ASSERT_FALSE(dl_load_system->is_executing_in_background());
+
+    ASSERT_TRUE(dl_load_system->consume_background_execution());
+    ASSERT_TRUE(node->REQUIRED);
+    ASSERT_TRUE(node->execution_failed.empty());
+
+    // The values are read from what the worker published, by the sockets of
+    // the live tree.
+    auto sum = dl_load_system->find_background_value(
+        node->get_output_socket("value"));
+    ASSERT_TRUE(sum);
+    ASSERT_EQ(sum->cast<int>(), 2);
+
+    ASSERT_FALSE(dl_load_system->consume_background_execution());
+}
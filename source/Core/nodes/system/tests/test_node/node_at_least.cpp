@@ -0,0 +1,24 @@
+#include "nodes/core/def/node_def.hpp"
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_UI(at_least)
+{
+    return "At Least";
+}
+
+NODE_DECLARATION_FUNCTION(at_least)
+{
+    b.add_input<int>("value");
+    b.add_input<int>("bound");
+    b.add_output<bool>("result");
+}
+
+NODE_EXECUTION_FUNCTION(at_least)
+{
+    auto value = params.get_input<int>("value");
+    auto bound = params.get_input<int>("bound");
+    params.set_output("result", value >= bound);
+    return true;
+}
+
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,26 @@
+#include "nodes/core/def/node_def.hpp"
+#include "test_payload.hpp"
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_UI(count_executions)
+{
+    return "Count Executions";
+}
+
+// Passes its value on and counts how often it ran in the global payload.
+NODE_DECLARATION_FUNCTION(count_executions)
+{
+    b.add_input<int>("value");
+    b.add_output<int>("value");
+}
+
+NODE_EXECUTION_FUNCTION(count_executions)
+{
+    auto& global_payload = params.get_global_payload<TestGlobalPayload&>();
+    ++global_payload.executions;
+
+    params.set_output("value", params.get_input<int>("value"));
+    return true;
+}
+
+NODE_DEF_CLOSE_SCOPE
@@ -1,4 +1,6 @@
 #pragma once
 struct TestGlobalPayload {
     bool is_simulating = false;
+    // Incremented by every run of a count_executions node.
+    int executions = 0;
 };
\ No newline at end of file
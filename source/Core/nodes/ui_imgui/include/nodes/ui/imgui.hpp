@@ -17,6 +17,12 @@ struct NODES_UI_IMGUI_API NodeSystemStorage {
     virtual ~NodeSystemStorage() = default;
     virtual void save(const std::string& data) = 0;
     virtual std::string load() = 0;
+
+    // Whether save() may be called from a worker thread.
+    virtual bool supports_async_save() const
+    {
+        return false;
+    }
 };
 
 struct NODES_UI_IMGUI_API NodeWidgetSettings {
@@ -31,6 +37,11 @@ struct NODES_UI_IMGUI_API NodeWidgetSettings {
     std::shared_ptr<NodeSystem> system;
     virtual std::unique_ptr<NodeSystemStorage> create_storage() const = 0;
 
+    // Execute the tree on a worker thread instead of inside the frame. Only
+    // enable it for systems whose nodes and global payload are safe to use
+    // off the UI thread.
+    bool background_execution = false;
+
     friend class NodeWidget;
 };
 
@@ -6,8 +6,12 @@
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui_internal.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 
 #include "RHI/rhi.hpp"
 #include "imgui.h"
@@ -77,10 +81,74 @@ static bool Splitter(
         0.0f);
 }
 
+// Writes tree snapshots to the storage. If the storage allows it, this
+// happens on a worker thread which only keeps the latest pending snapshot.
+class NodeSystemSaver {
+   public:
+    explicit NodeSystemSaver(NodeSystemStorage* storage) : storage_(storage)
+    {
+        if (storage_->supports_async_save()) {
+            worker_ = std::thread([this] { run(); });
+        }
+    }
+
+    ~NodeSystemSaver()
+    {
+        if (worker_.joinable()) {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            worker_.join();
+        }
+    }
+
+    void save(NodeTreeSerialization snapshot)
+    {
+        if (!worker_.joinable()) {
+            storage_->save(snapshot.dump());
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            pending_ = std::move(snapshot);
+        }
+        cv_.notify_all();
+    }
+
+   private:
+    void run()
+    {
+        while (true) {
+            NodeTreeSerialization snapshot;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || pending_; });
+                // Pending data is still written when stopping.
+                if (!pending_) {
+                    return;
+                }
+                snapshot = std::move(*pending_);
+                pending_.reset();
+            }
+            storage_->save(snapshot.dump());
+        }
+    }
+
+    NodeSystemStorage* storage_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::optional<NodeTreeSerialization> pending_;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
 NodeWidget::NodeWidget(const NodeWidgetSettings& desc)
     : storage_(desc.create_storage()),
       tree_(desc.system->get_node_tree()),
       system_(desc.system),
+      background_execution_(desc.background_execution),
       widget_name(desc.WidgetName())
 {
     ed::Config config;
@@ -96,15 +164,13 @@ NodeWidget::NodeWidget(const NodeWidgetSettings& desc)
             return true;
         }
         auto ptr = static_cast<NodeWidget*>(userPointer);
-        auto storage = ptr->storage_.get();
 
         auto ui_json = std::string(data + 1, size - 2);
 
         ptr->tree_->set_ui_settings(ui_json);
 
-        std::string node_serialize = ptr->tree_->serialize();
-
-        storage->save(node_serialize);
+        ptr->save_pending_ = true;
+        ptr->save_requested_at_ = std::chrono::steady_clock::now();
         return true;
     };
 
@@ -121,6 +187,7 @@ NodeWidget::NodeWidget(const NodeWidgetSettings& desc)
     };
 
     m_Editor = ed::CreateEditor(&config);
+    saver_ = std::make_unique<NodeSystemSaver>(storage_.get());
 
     m_HeaderBackground =
         LoadTexture(BlueprintBackground, sizeof(BlueprintBackground));
@@ -130,6 +197,25 @@ NodeWidget::~NodeWidget()
 {
     ed::SetCurrentEditor(m_Editor);
     ed::DestroyEditor(m_Editor);
+
+    flush_save(true);
+    // Waits for the last write, which still uses storage_.
+    saver_.reset();
+}
+
+void NodeWidget::flush_save(bool force)
+{
+    if (!save_pending_) {
+        return;
+    }
+    auto elapsed = std::chrono::duration<float>(
+                       std::chrono::steady_clock::now() - save_requested_at_)
+                       .count();
+    if (!force && elapsed < m_SaveDelay) {
+        return;
+    }
+    save_pending_ = false;
+    saver_->save(tree_->serialize_snapshot());
 }
 
 std::vector<Node*> NodeWidget::create_node_menu()
@@ -165,10 +251,15 @@ bool NodeWidget::BuildUI()
     //     ImGui::SameLine(0.0f, 12.0f);
     // }
 
+    flush_save(false);
+
     if (tree_->GetDirty()) {
-        system_->execute(true);
+        execute_tree();
         tree_->SetDirty(false);
     }
+    if (background_execution_) {
+        system_->consume_background_execution();
+    }
 
     ed::Begin(GetWindowUniqueName().c_str(), ImGui::GetContentRegionAvail());
     {
@@ -410,7 +501,7 @@ bool NodeWidget::BuildUI()
             ImGui::Text("Unknown node: %p", contextNodeId.AsPointer());
         ImGui::Separator();
         if (ImGui::MenuItem("Run")) {
-            system_->execute(true, node);
+            execute_tree(node);
         }
         if (ImGui::MenuItem("Group")) {
             std::vector<NodeId> selectedNodes;
@@ -544,6 +635,16 @@ void NodeWidget::SetNodeSystemDirty(bool dirty)
     tree_->SetDirty(dirty);
 }
 
+void NodeWidget::execute_tree(Node* required_node)
+{
+    if (background_execution_) {
+        system_->execute_in_background(true, required_node);
+    }
+    else {
+        system_->execute(true, required_node);
+    }
+}
+
 void NodeWidget::ShowInputOrOutput(
     const NodeSocket& socket,
     const entt::meta_any& value)
@@ -760,8 +861,18 @@ void NodeWidget::ShowLeftPane(float paneWidth)
     ImGui::TextUnformatted("Selection");
 
     ImGui::Indent();
+    // A background execution may be running on the executor, its values are
+    // only read from what the last finished one published.
     EagerNodeTreeExecutor* executor =
         dynamic_cast<EagerNodeTreeExecutor*>(system_->get_node_tree_executor());
+    auto socket_value = [&](NodeSocket* socket) -> const entt::meta_any& {
+        static const entt::meta_any empty;
+        if (background_execution_) {
+            auto value = system_->find_background_value(socket);
+            return value ? *value : empty;
+        }
+        return executor ? *executor->FindPtr(socket) : empty;
+    };
     for (int i = 0; i < nodeCount; ++i) {
         ImGui::Text("Node (%p)", selectedNodes[i].AsPointer());
         auto node = tree_->find_node(selectedNodes[i]);
@@ -770,15 +881,13 @@ void NodeWidget::ShowLeftPane(float paneWidth)
         ImGui::Text("Inputs:");
         ImGui::Indent();
         for (auto& in : input) {
-            auto input_value = *executor->FindPtr(in);
-            ShowInputOrOutput(*in, input_value);
+            ShowInputOrOutput(*in, socket_value(in));
         }
         ImGui::Unindent();
         ImGui::Text("Outputs:");
         ImGui::Indent();
         for (auto& out : output) {
-            auto output_value = *executor->FindPtr(out);
-            ShowInputOrOutput(*out, output_value);
+            ShowInputOrOutput(*out, socket_value(out));
         }
         ImGui::Unindent();
         if (node->override_left_pane_info)
@@ -946,10 +1055,29 @@ struct NodeSystemFileStorage : public NodeSystemStorage {
     {
     }
 
+    // Written to a temporary file first, so an interrupted save never leaves
+    // a truncated tree behind.
     void save(const std::string& data) override
     {
-        std::ofstream file(json_path_);
-        file << data;
+        auto tmp_path = json_path_;
+        tmp_path += ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            file << data;
+            if (!file) {
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, json_path_, ec);
+        if (ec) {
+            std::filesystem::remove(tmp_path, ec);
+        }
+    }
+
+    bool supports_async_save() const override
+    {
+        return true;
     }
 
     std::string load() override
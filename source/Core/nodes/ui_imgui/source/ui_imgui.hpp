@@ -1,6 +1,7 @@
 #pragma once
 #define IMGUI_DEFINE_MATH_OPERATORS
 
+#include <chrono>
 #include <string>
 
 #include "RHI/rhi.hpp"
@@ -21,6 +22,8 @@ namespace util = ax::NodeEditor::Utilities;
 using namespace ax;
 using ax::Widgets::IconType;
 
+class NodeSystemSaver;
+
 struct NodeIdLess {
     bool operator()(const NodeId& lhs, const NodeId& rhs) const
     {
@@ -52,6 +55,14 @@ class NodeWidget : public IWidget {
 
     std::unique_ptr<NodeSystemStorage> storage_;
 
+    // Editor settings change on every drag, so saving is coalesced: a request
+    // only marks the tree, and it is written once it stays quiet for a while.
+    void flush_save(bool force);
+    const float m_SaveDelay = 0.5f;
+    bool save_pending_ = false;
+    std::chrono::steady_clock::time_point save_requested_at_;
+    std::unique_ptr<NodeSystemSaver> saver_;
+
     NodeTree* tree_;
     bool createNewNode = false;
     NodeSocket* newNodeLinkPin = nullptr;
@@ -65,6 +76,7 @@ class NodeWidget : public IWidget {
     ImVec2 newNodePostion;
     bool location_remembered = false;
     std::shared_ptr<NodeSystem> system_;
+    bool background_execution_ = false;
     static const int m_PinIconSize = 20;
 
     std::string widget_name;
@@ -95,6 +107,8 @@ class NodeWidget : public IWidget {
         const entt::meta_any& value);
 
     std::vector<Node*> add_node(const std::string& id_name);
+
+    void execute_tree(Node* required_node = nullptr);
 };
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
@@ -23,4 +23,19 @@ Geometry* GeometryComponent::get_attached_operand() const
     return attached_operand;
 }
 
+bool GeometryComponent::hash(size_t& seed) const
+{
+    return false;
+}
+
+void GeometryComponent::hash_prim(const pxr::UsdPrim& prim, size_t& seed)
+{
+    for (auto&& attribute : prim.GetAuthoredAttributes()) {
+        pxr::VtValue value;
+        attribute.Get(&value);
+        hash_combine(seed, attribute.GetName().Hash());
+        hash_combine(seed, value.GetHash());
+    }
+}
+
 USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
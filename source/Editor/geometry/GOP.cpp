@@ -1,5 +1,7 @@
 #include "GCore/GOP.h"
 
+#include <typeinfo>
+
 #include "GCore/Components.h"
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/Components/XformComponent.h"
@@ -44,6 +46,14 @@ Geometry::Geometry(Geometry&& operand) noexcept
 
 Geometry& Geometry::operator=(const Geometry& operand)
 {
+    if (this == &operand) {
+        return *this;
+    }
+
+    // The executor assigns values into sockets that already hold a geometry,
+    // which must not keep its own components.
+    components_.clear();
+    components_.reserve(operand.components_.size());
     for (auto&& operand_component : operand.components_) {
         this->components_.push_back(operand_component->copy(this));
     }
@@ -66,6 +76,23 @@ Geometry Geometry::CreateMesh()
     return std::move(geometry);
 }
 
+bool hash_value(const Geometry& geometry, size_t& hash)
+{
+    hash = geometry.get_components().size();
+    for (auto&& component : geometry.get_components()) {
+        if (!component) {
+            continue;
+        }
+        auto& component_ref = *component;
+        GeometryComponent::hash_combine(
+            hash, typeid(component_ref).hash_code());
+        if (!component->hash(hash)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::string Geometry::to_string() const
 {
     std::ostringstream out;
@@ -91,6 +91,20 @@ GeometryComponentHandle MeshComponent::copy(Geometry* operand) const
     return ret;
 }
 
+bool MeshComponent::hash(size_t& seed) const
+{
+    hash_prim(mesh.GetPrim(), seed);
+    hash_combine(seed, hash_value(vertex_scalar_quantities));
+    hash_combine(seed, hash_value(face_scalar_quantities));
+    hash_combine(seed, hash_value(vertex_color_quantities));
+    hash_combine(seed, hash_value(face_color_quantities));
+    hash_combine(seed, hash_value(vertex_vector_quantities));
+    hash_combine(seed, hash_value(face_vector_quantities));
+    hash_combine(seed, hash_value(face_corner_parameterization_quantities));
+    hash_combine(seed, hash_value(vertex_parameterization_quantities));
+    return true;
+}
+
 void MeshComponent::set_mesh_geom(const pxr::UsdGeomMesh& usdgeom)
 {
     copy_prim(usdgeom.GetPrim(), mesh.GetPrim());
@@ -26,6 +26,8 @@ GeometryComponentHandle SkelComponent::copy(Geometry* operand) const
     ret->bindTransforms = this->bindTransforms;
     ret->jointWeight = this->jointWeight;
     ret->jointIndices = this->jointIndices;
+    ret->jointInterpolation = this->jointInterpolation;
+    ret->jointElementSize = this->jointElementSize;
 
     return ret;
 }
@@ -1,14 +1,96 @@
 #include "GCore/Components/VolumeComponent.h"
 
+#include <algorithm>
+#include <sstream>
+
 USTC_CG_NAMESPACE_OPEN_SCOPE
-GeometryComponentHandle VolumeComponet::copy(Geometry* operand) const
+VolumeComponent::VolumeComponent(Geometry* attached_operand)
+    : GeometryComponent(attached_operand)
+{
+}
+
+GeometryComponentHandle VolumeComponent::copy(Geometry* operand) const
+{
+    auto ret = std::make_shared<VolumeComponent>(operand);
+    ret->grids = grids;
+    return ret;
+}
+
+std::string VolumeComponent::to_string() const
+{
+    std::ostringstream out;
+    out << "Volume component. Grids:";
+    for (auto&& grid : grids) {
+        out << " " << grid->getName() << " (" << grid->activeVoxelCount()
+            << " active voxels)";
+    }
+    out << ".";
+    return out.str();
+}
+
+// Only the transforms change, so the transformed grids keep sharing their
+// trees until get_grid_for_write copies them.
+void VolumeComponent::apply_transform(const pxr::GfMatrix4d& transform)
+{
+    openvdb::Mat4d matrix(transform.GetArray());
+    for (auto&& grid : grids) {
+        auto transformed = grid->copyGrid();
+        transformed->transform().postMult(matrix);
+        grid = transformed;
+    }
+}
+
+void VolumeComponent::add_grid(openvdb::GridBase::Ptr grid)
+{
+    if (auto existing = find_grid(grid->getName())) {
+        *existing = std::move(grid);
+    }
+    else {
+        grids.push_back(std::move(grid));
+    }
+}
+
+void VolumeComponent::remove_grid(const std::string& name)
+{
+    std::erase_if(
+        grids, [&](auto&& grid) { return grid->getName() == name; });
+}
+
+openvdb::GridBase::ConstPtr VolumeComponent::get_grid(
+    const std::string& name) const
+{
+    for (auto&& grid : grids) {
+        if (grid->getName() == name) {
+            return grid;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> VolumeComponent::get_grid_names() const
+{
+    std::vector<std::string> names;
+    names.reserve(grids.size());
+    for (auto&& grid : grids) {
+        names.push_back(grid->getName());
+    }
+    return names;
+}
+
+openvdb::GridBase::Ptr* VolumeComponent::find_grid(const std::string& name)
 {
-    (void)(operand);
-    return {};
+    for (auto&& grid : grids) {
+        if (grid->getName() == name) {
+            return &grid;
+        }
+    }
+    return nullptr;
 }
 
-std::string VolumeComponet::to_string() const
+bool VolumeComponent::tree_is_shared(const openvdb::GridBase& grid)
 {
-    return std::string("VolumeComponet");
+    // The pointer handed out is a copy, the grid itself holds the other
+    // reference.
+    return grid.constBaseTreePtr().use_count() > 2;
 }
 USTC_CG_NAMESPACE_CLOSE_SCOPE
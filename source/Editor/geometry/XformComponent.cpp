@@ -19,6 +19,17 @@ GeometryComponentHandle XformComponent::copy(Geometry* operand) const
     return ret;
 }
 
+bool XformComponent::hash(size_t& seed) const
+{
+    for (auto* vectors : { &translation, &scale, &rotation }) {
+        hash_combine(seed, vectors->size());
+        for (auto&& vector : *vectors) {
+            hash_combine(seed, hash_value(vector));
+        }
+    }
+    return true;
+}
+
 std::string XformComponent::to_string() const
 {
     return std::string("XformComponent");
@@ -16,7 +16,19 @@ struct GEOMETRY_API GeometryComponent {
 
     virtual void apply_transform(const pxr::GfMatrix4d& transform) = 0;
 
+    // Adds a hash of the content to seed. False for the components whose
+    // content is not hashed, a geometry holding one is never memoized.
+    virtual bool hash(size_t& seed) const;
+
+    static void hash_combine(size_t& seed, size_t hash)
+    {
+        seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
    protected:
+    // Hashes the authored attributes of a scratch buffer prim.
+    static void hash_prim(const pxr::UsdPrim& prim, size_t& seed);
+
     Geometry* attached_operand;
     pxr::SdfPath scratch_buffer_path;
 };
@@ -13,6 +13,12 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     std::string to_string() const override;
 
+    bool hash(size_t& seed) const override
+    {
+        hash_prim(curves.GetPrim(), seed);
+        return true;
+    }
+
     void apply_transform(const pxr::GfMatrix4d& transform) override
     {
         auto vertices = get_vertices();
@@ -30,6 +30,14 @@ struct GEOMETRY_API MaterialComponent : public GeometryComponent {
         return {};
     }
 
+    bool hash(size_t& seed) const override
+    {
+        for (auto&& texture : textures) {
+            hash_combine(seed, std::hash<std::string>{}(texture));
+        }
+        return true;
+    }
+
     std::vector<std::string> textures;
 };
 
@@ -28,6 +28,8 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
     std::string to_string() const override;
 
     GeometryComponentHandle copy(Geometry* operand) const override;
+    bool hash(size_t& seed) const override;
+
     [[nodiscard]] pxr::VtArray<pxr::GfVec3f> get_vertices() const
     {
         pxr::VtArray<pxr::GfVec3f> vertices;
@@ -267,7 +269,8 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
    private:
     pxr::UsdGeomMesh mesh;
 
-    // After adding these quantities, you need to modify the copy() function
+    // After adding these quantities, you need to modify the copy() and hash()
+    // functions
 
     // Quantities for polyscope
     // Edge quantities are not supported because the indexing is not clear
@@ -23,6 +23,12 @@ struct GEOMETRY_API PointsComponent : public GeometryComponent {
 
     GeometryComponentHandle copy(Geometry* operand) const override;
 
+    bool hash(size_t& seed) const override
+    {
+        hash_prim(points.GetPrim(), seed);
+        return true;
+    }
+
     [[nodiscard]] pxr::VtArray<pxr::GfVec3f> get_vertices() const
     {
         pxr::VtArray<pxr::GfVec3f> vertices;
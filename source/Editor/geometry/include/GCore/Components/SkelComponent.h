@@ -4,6 +4,7 @@
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 #include "pxr/base/gf/matrix4f.h"
+#include "pxr/usd/usdGeom/tokens.h"
 #include "pxr/usd/usdGeom/xform.h"
 #include "pxr/usd/usdSkel/skeleton.h"
 #include "pxr/usd/usdSkel/topology.h"
@@ -28,6 +29,10 @@ struct GEOMETRY_API SkelComponent : public GeometryComponent {
     pxr::VtArray<pxr::GfMatrix4d> bindTransforms;
     pxr::VtArray<float> jointWeight;
     pxr::VtArray<int> jointIndices;
+    // How the joint influences of the binding are laid out: constant for one
+    // set shared by all points, vertex for jointElementSize per point.
+    pxr::TfToken jointInterpolation = pxr::UsdGeomTokens->vertex;
+    int jointElementSize = 1;
 
     GeometryComponentHandle copy(Geometry* operand) const override;
 };
@@ -1,17 +1,67 @@
 #pragma once
 
+#include <openvdb/openvdb.h>
+
+#include <string>
+#include <vector>
+
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 #include "GCore/api.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
-class GEOMETRY_API VolumeComponet : public GeometryComponent {
+// Sparse volumes stored as named OpenVDB grids. Copies of the component share
+// the grids, so they are only handed out const; get_grid_for_write makes the
+// grid unique before it is modified.
+class GEOMETRY_API VolumeComponent : public GeometryComponent {
    public:
-    explicit VolumeComponet(Geometry* attached_operand) : GeometryComponent(attached_operand)
-    {
-    }
+    explicit VolumeComponent(Geometry* attached_operand);
 
     GeometryComponentHandle copy(Geometry* operand) const override;
     std::string to_string() const override;
+
+    void apply_transform(const pxr::GfMatrix4d& transform) override;
+
+    // Adds the grid under its name, replacing a grid of the same name.
+    void add_grid(openvdb::GridBase::Ptr grid);
+    void remove_grid(const std::string& name);
+
+    [[nodiscard]] openvdb::GridBase::ConstPtr get_grid(
+        const std::string& name) const;
+
+    template<typename GridType>
+    [[nodiscard]] typename GridType::ConstPtr get_grid(
+        const std::string& name) const
+    {
+        return openvdb::gridConstPtrCast<GridType>(get_grid(name));
+    }
+
+    // The grid after copying it if another component or reader shares it, or
+    // shares its tree, as the grids made by apply_transform do.
+    template<typename GridType>
+    typename GridType::Ptr get_grid_for_write(const std::string& name)
+    {
+        auto grid = find_grid(name);
+        if (!grid) {
+            return nullptr;
+        }
+        if (grid->use_count() > 1 || tree_is_shared(**grid)) {
+            *grid = (*grid)->deepCopyGrid();
+        }
+        return openvdb::gridPtrCast<GridType>(*grid);
+    }
+
+    [[nodiscard]] std::vector<std::string> get_grid_names() const;
+
+    [[nodiscard]] const std::vector<openvdb::GridBase::Ptr>& get_grids() const
+    {
+        return grids;
+    }
+
+   private:
+    openvdb::GridBase::Ptr* find_grid(const std::string& name);
+    static bool tree_is_shared(const openvdb::GridBase& grid);
+
+    std::vector<openvdb::GridBase::Ptr> grids;
 };
 USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -11,6 +11,7 @@ class GEOMETRY_API XformComponent : public GeometryComponent {
    public:
     GeometryComponentHandle copy(Geometry* operand) const override;
     std::string to_string() const override;
+    bool hash(size_t& seed) const override;
 
     explicit XformComponent(Geometry* attached_operand)
         : GeometryComponent(attached_operand)
@@ -76,6 +76,10 @@ std::shared_ptr<OperandType> Geometry::get_component(size_t idx) const
     return nullptr;
 }
 
+// Content hash of the components, used to memoize the nodes taking the
+// geometry. False when a component is not hashed.
+GEOMETRY_API bool hash_value(const Geometry& geometry, size_t& hash);
+
 void GEOMETRY_API init(Stage* stage);
 
 void GEOMETRY_API copy_prim(const pxr::UsdPrim& from, const pxr::UsdPrim& to);
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/stageCache.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdSkel/cache.h>
+#include <pxr/usd/usdSkel/skeletonQuery.h>
+
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Reads the points of a mesh and the joint transforms of its skeleton. The
+// authored time samples following the last fetched one are read ahead on a
+// worker thread, so playing back cached animation is served from memory.
+class GEOMETRY_API UsdAnimationPrefetcher {
+   public:
+    struct Frame {
+        pxr::VtArray<pxr::GfVec3f> points;
+        pxr::VtArray<pxr::GfMatrix4f> joint_local_transforms;
+    };
+
+    UsdAnimationPrefetcher(
+        const pxr::UsdGeomMesh& mesh,
+        const pxr::UsdSkelSkeletonQuery& skel_query,
+        size_t window = 16);
+    ~UsdAnimationPrefetcher();
+
+    UsdAnimationPrefetcher(const UsdAnimationPrefetcher&) = delete;
+    UsdAnimationPrefetcher& operator=(const UsdAnimationPrefetcher&) = delete;
+
+    Frame fetch(pxr::UsdTimeCode time);
+
+   private:
+    Frame read(pxr::UsdTimeCode time) const;
+    void run();
+
+    pxr::UsdStageRefPtr stage;
+    pxr::UsdGeomMesh mesh;
+    pxr::UsdSkelSkeletonQuery skel_query;
+    size_t window;
+
+    // Sorted union of the point and joint transform samples.
+    std::vector<double> sample_times;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<double, Frame> frames;
+    size_t window_begin = 0;
+    size_t window_end = 0;
+    bool stop = false;
+    std::thread worker;
+};
+
+// Stages opened from files, shared between all the nodes reading them, so a
+// file read every frame is composed only once. A stage is reopened when its
+// file changes on disk, and the least recently used ones are released once
+// there are more than the capacity.
+class GEOMETRY_API UsdFileStageCache {
+   public:
+    struct CachedStage {
+        pxr::UsdStageRefPtr stage;
+        std::shared_ptr<pxr::UsdSkelCache> skel_cache;
+    };
+
+    static UsdFileStageCache& instance();
+
+    CachedStage open(const std::string& file_name);
+
+    // One prefetcher is kept per prim of a cached stage.
+    std::shared_ptr<UsdAnimationPrefetcher> open_animation(
+        const std::string& file_name,
+        const pxr::UsdGeomMesh& mesh,
+        const pxr::UsdSkelSkeletonQuery& skel_query);
+
+    void set_capacity(size_t capacity);
+    void clear();
+
+   private:
+    struct Entry {
+        pxr::UsdStageCache::Id id;
+        std::filesystem::file_time_type write_time;
+        uint64_t last_used = 0;
+        std::shared_ptr<pxr::UsdSkelCache> skel_cache;
+        std::map<pxr::SdfPath, std::shared_ptr<UsdAnimationPrefetcher>>
+            animations;
+    };
+
+    Entry* acquire(const std::string& file_name);
+    void evict();
+
+    std::mutex mutex;
+    pxr::UsdStageCache stage_cache;
+    std::unordered_map<std::string, Entry> entries;
+    size_t capacity = 8;
+    uint64_t use_counter = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
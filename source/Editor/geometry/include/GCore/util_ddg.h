@@ -0,0 +1,133 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <memory>
+#include <vector>
+
+#include "GCore/api.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/base/work/loops.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Sparsity of the per face 3x3 stencils of a triangle mesh, such as the
+// cotangent Laplacian. A matrix is assembled from 9 values per face, row major
+// over the face corners, by a parallel gather in which every nonzero sums the
+// face entries that land on it. The pattern only depends on the topology and
+// is shared through face_stencil_pattern().
+class GEOMETRY_API FaceStencilPattern {
+   public:
+    FaceStencilPattern(int vertex_count, const pxr::VtArray<int>& triangles);
+
+    bool matches(int vertex_count, const pxr::VtArray<int>& triangles) const;
+
+    int vertex_count() const
+    {
+        return vertex_count_;
+    }
+
+    Eigen::SparseMatrix<double> assemble(
+        const std::vector<double>& face_values) const;
+
+    // Sums per corner values, 3 per face, into their vertices.
+    template<typename T>
+    std::vector<T> gather_corners(
+        const std::vector<T>& corner_values,
+        const T& zero) const
+    {
+        std::vector<T> vertex_values(vertex_count_, zero);
+        pxr::WorkParallelForN(vertex_count_, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                for (int k = corner_offsets_[v]; k < corner_offsets_[v + 1];
+                     ++k) {
+                    vertex_values[v] += corner_values[corners_[k]];
+                }
+            }
+        });
+        return vertex_values;
+    }
+
+   private:
+    int vertex_count_;
+    pxr::VtArray<int> triangles_;
+    Eigen::SparseMatrix<double> pattern_;
+    // Face entries f * 9 + k summed by every nonzero.
+    std::vector<int> entry_offsets_;
+    std::vector<int> entries_;
+    // Corners f * 3 + c of every vertex.
+    std::vector<int> corner_offsets_;
+    std::vector<int> corners_;
+};
+
+// Returns the pattern of a topology, reusing the one built for the last few
+// topologies seen.
+GEOMETRY_API std::shared_ptr<const FaceStencilPattern> face_stencil_pattern(
+    int vertex_count,
+    const pxr::VtArray<int>& triangles);
+
+// Per face quantities of a triangle mesh given as flat arrays, computed in
+// parallel over faces. Corner i of a face is opposite to the edge between
+// corners i + 1 and i + 2.
+class GEOMETRY_API TriangleMeshDDG {
+   public:
+    TriangleMeshDDG(
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const pxr::VtArray<int>& face_vertex_counts,
+        const pxr::VtArray<int>& face_vertex_indices);
+
+    int vertex_count() const
+    {
+        return pattern_->vertex_count();
+    }
+
+    int face_count() const
+    {
+        return int(triangles_.size() / 3);
+    }
+
+    const int* face(int f) const
+    {
+        return triangles_.cdata() + 3 * f;
+    }
+
+    // Cotangents of the angles at the corners of every face.
+    const std::vector<Eigen::Vector3d>& cotangents() const
+    {
+        return cotangents_;
+    }
+
+    const std::vector<double>& areas() const
+    {
+        return areas_;
+    }
+
+    // Corners of every face in an isometric frame of its plane, corner 0 at
+    // the origin and corner 1 on the positive x axis.
+    const std::vector<Eigen::Matrix<double, 3, 2>>& frames() const
+    {
+        return frames_;
+    }
+
+    // L_ij = -(cot a + cot b) / 2 summed over the faces of edge ij, positive
+    // semi-definite.
+    Eigen::SparseMatrix<double> cotangent_laplacian() const;
+
+    // Diagonal lumped mass, a third of the area of the faces around a vertex.
+    Eigen::SparseMatrix<double> mass_matrix() const;
+
+    const FaceStencilPattern& pattern() const
+    {
+        return *pattern_;
+    }
+
+   private:
+    pxr::VtArray<int> triangles_;
+    std::shared_ptr<const FaceStencilPattern> pattern_;
+    std::vector<Eigen::Vector3d> cotangents_;
+    std::vector<double> areas_;
+    std::vector<Eigen::Matrix<double, 3, 2>> frames_;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+#include "GCore/GOP.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/array.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+// Narrow band level set of the union of spheres, widths are used as radii.
+GEOMETRY_API openvdb::FloatGrid::Ptr spheres_to_level_set(
+    const pxr::VtArray<pxr::GfVec3f>& centers,
+    const pxr::VtArray<float>& radii,
+    float voxel_size);
+
+// Mesh of the isosurface as a geometry with a mesh component. Adaptivity in
+// [0, 1] merges faces in flat regions.
+GEOMETRY_API Geometry level_set_to_operand(
+    const openvdb::FloatGrid& grid,
+    float isovalue,
+    float adaptivity);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "GCore/api.h"
+#include "pxr/base/gf/vec3f.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+struct SkelComponent;
+
+// Influences of every point with the zero weights and invalid joints dropped
+// and the weights normalized, padded to the same count so every point runs
+// the same blend loop. Constant influences are one row shared by all points.
+struct SkinningInfluences {
+    bool constant = false;
+    size_t influence_count = 0;
+    std::vector<int> indices;
+    std::vector<float> weights;
+};
+
+// Lays out the joint influences of the skeleton binding, following its
+// interpolation and element size. Throws when they do not match the points.
+GEOMETRY_API SkinningInfluences build_skinning_influences(
+    const SkelComponent& skel,
+    size_t point_count,
+    size_t joint_count);
+
+// Transforms a normal by the linear part of a skinning transform, given as
+// three rows for row vectors as in Gf. Like UsdSkel, it uses the inverse
+// transpose, so normals stay perpendicular to the surface under non uniform
+// scale. The cofactor matrix is the inverse transpose up to the determinant,
+// only its sign is kept as the result is normalized.
+inline pxr::GfVec3f skin_normal(const float* m, const pxr::GfVec3f& n)
+{
+    float c[9] = {
+        m[4] * m[8] - m[5] * m[7], m[5] * m[6] - m[3] * m[8],
+        m[3] * m[7] - m[4] * m[6], m[2] * m[7] - m[1] * m[8],
+        m[0] * m[8] - m[2] * m[6], m[1] * m[6] - m[0] * m[7],
+        m[1] * m[5] - m[2] * m[4], m[2] * m[3] - m[0] * m[5],
+        m[0] * m[4] - m[1] * m[3],
+    };
+    float determinant = m[0] * c[0] + m[1] * c[1] + m[2] * c[2];
+    float sign = determinant < 0 ? -1.f : 1.f;
+
+    return (sign * pxr::GfVec3f(
+                       n[0] * c[0] + n[1] * c[3] + n[2] * c[6],
+                       n[0] * c[1] + n[1] * c[4] + n[2] * c[7],
+                       n[0] * c[2] + n[1] * c[5] + n[2] * c[8]))
+        .GetNormalized();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
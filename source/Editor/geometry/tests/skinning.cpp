@@ -0,0 +1,100 @@
+#include "GCore/util_skinning.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "GCore/Components/SkelComponent.h"
+#include "GCore/GOP.h"
+#include "stage/stage.hpp"
+
+using namespace USTC_CG;
+
+class SkinningTest : public ::testing::Test {
+   protected:
+    void SetUp() override
+    {
+        init(&stage);
+    }
+
+    void TearDown() override
+    {
+        init(nullptr);
+    }
+
+    Stage stage;
+};
+
+// Two influences shared by two points. Taken as per vertex runs, these would
+// be one influence for each point.
+TEST_F(SkinningTest, ConstantInfluencesAreShared)
+{
+    Geometry geometry;
+    SkelComponent skel(&geometry);
+    skel.jointIndices = { 0, 1 };
+    skel.jointWeight = { 1.f, 3.f };
+    skel.jointInterpolation = pxr::UsdGeomTokens->constant;
+    skel.jointElementSize = 2;
+
+    auto influences = build_skinning_influences(skel, 2, 2);
+    EXPECT_TRUE(influences.constant);
+    ASSERT_EQ(influences.influence_count, 2);
+    ASSERT_EQ(influences.indices.size(), 2);
+    EXPECT_EQ(influences.indices[0], 0);
+    EXPECT_EQ(influences.indices[1], 1);
+    EXPECT_FLOAT_EQ(influences.weights[0], 0.25f);
+    EXPECT_FLOAT_EQ(influences.weights[1], 0.75f);
+}
+
+TEST_F(SkinningTest, VertexInfluencesArePerPoint)
+{
+    Geometry geometry;
+    SkelComponent skel(&geometry);
+    // The second point has a zero weight and a joint out of range, which are
+    // dropped, and its row is padded.
+    skel.jointIndices = { 0, 1, 1, 5 };
+    skel.jointWeight = { 1.f, 1.f, 2.f, 1.f };
+    skel.jointInterpolation = pxr::UsdGeomTokens->vertex;
+    skel.jointElementSize = 2;
+
+    auto influences = build_skinning_influences(skel, 2, 2);
+    EXPECT_FALSE(influences.constant);
+    ASSERT_EQ(influences.influence_count, 2);
+    ASSERT_EQ(influences.indices.size(), 4);
+    EXPECT_FLOAT_EQ(influences.weights[0], 0.5f);
+    EXPECT_FLOAT_EQ(influences.weights[1], 0.5f);
+    EXPECT_EQ(influences.indices[2], 1);
+    EXPECT_FLOAT_EQ(influences.weights[2], 1.f);
+    EXPECT_FLOAT_EQ(influences.weights[3], 0.f);
+
+    // Vertex influences must cover every point.
+    EXPECT_THROW(build_skinning_influences(skel, 3, 2), std::runtime_error);
+}
+
+// Under a non uniform scale a normal must stay perpendicular to the skinned
+// surface, which transforming it like a point does not.
+TEST(SkinNormal, StaysPerpendicularUnderScale)
+{
+    // Scales x by 2, rows of the linear part.
+    float m[9] = { 2, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+    // The surface x + y = 0, its tangent (1, -1, 0) becomes (2, -1, 0).
+    pxr::GfVec3f normal = pxr::GfVec3f(1, 1, 0).GetNormalized();
+    pxr::GfVec3f skinned_tangent(2, -1, 0);
+
+    auto skinned = skin_normal(m, normal);
+    EXPECT_NEAR(pxr::GfDot(skinned, skinned_tangent), 0.f, 1e-6f);
+    EXPECT_NEAR(skinned.GetLength(), 1.f, 1e-6f);
+    EXPECT_GT(pxr::GfDot(skinned, normal), 0.f);
+}
+
+TEST(SkinNormal, RotatesWithRigidTransforms)
+{
+    // A quarter turn about z, x goes to y.
+    float m[9] = { 0, 1, 0, -1, 0, 0, 0, 0, 1 };
+
+    auto skinned = skin_normal(m, pxr::GfVec3f(1, 0, 0));
+    EXPECT_NEAR(skinned[0], 0.f, 1e-6f);
+    EXPECT_NEAR(skinned[1], 1.f, 1e-6f);
+    EXPECT_NEAR(skinned[2], 0.f, 1e-6f);
+}
@@ -0,0 +1,93 @@
+#include "GCore/Components/VolumeComponent.h"
+
+#include <gtest/gtest.h>
+#include <openvdb/tools/LevelSetFilter.h>
+#include <openvdb/tools/LevelSetSphere.h>
+
+#include "GCore/GOP.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "stage/stage.hpp"
+
+using namespace USTC_CG;
+
+class VolumeComponentTest : public ::testing::Test {
+   protected:
+    void SetUp() override
+    {
+        openvdb::initialize();
+        init(&stage);
+    }
+
+    void TearDown() override
+    {
+        init(nullptr);
+    }
+
+    Stage stage;
+};
+
+TEST_F(VolumeComponentTest, WriteAfterTransformLeavesSourceUnchanged)
+{
+    auto sphere = openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        1.f, openvdb::Vec3f(0.f), 0.1f);
+    sphere->setName("surface");
+
+    Geometry source;
+    auto volume = std::make_shared<VolumeComponent>(&source);
+    volume->add_grid(sphere);
+    source.attach_component(volume);
+
+    // A voxel on the surface, which the filter moves.
+    openvdb::Coord surface(10, 0, 0);
+    auto voxels = sphere->activeVoxelCount();
+    auto value = sphere->tree().getValue(surface);
+
+    Geometry transformed = source;
+    auto copy = transformed.get_component<VolumeComponent>();
+    ASSERT_TRUE(copy);
+    copy->apply_transform(
+        pxr::GfMatrix4d(1.0).SetTranslate(pxr::GfVec3d(1.0, 0.0, 0.0)));
+
+    // The transformed grid shares the tree of the source until written.
+    EXPECT_EQ(
+        &copy->get_grid<openvdb::FloatGrid>("surface")->tree(),
+        &sphere->tree());
+
+    auto grid = copy->get_grid_for_write<openvdb::FloatGrid>("surface");
+    ASSERT_TRUE(grid);
+    EXPECT_NE(&grid->tree(), &sphere->tree());
+
+    openvdb::tools::LevelSetFilter<openvdb::FloatGrid> filter(*grid);
+    filter.gaussian(1);
+    filter.offset(-0.2f);
+    EXPECT_NE(grid->tree().getValue(surface), value);
+    EXPECT_EQ(
+        grid->transform().indexToWorld(openvdb::Vec3d(0.0)),
+        openvdb::Vec3d(1.0, 0.0, 0.0));
+
+    auto original = volume->get_grid<openvdb::FloatGrid>("surface");
+    EXPECT_EQ(original, sphere);
+    EXPECT_EQ(original->activeVoxelCount(), voxels);
+    EXPECT_EQ(original->tree().getValue(surface), value);
+    EXPECT_EQ(
+        original->transform().indexToWorld(openvdb::Vec3d(0.0)),
+        openvdb::Vec3d(0.0));
+}
+
+TEST_F(VolumeComponentTest, WriteUnsharedGridInPlace)
+{
+    auto sphere = openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        1.f, openvdb::Vec3f(0.f), 0.1f);
+    sphere->setName("surface");
+
+    Geometry geometry;
+    auto volume = std::make_shared<VolumeComponent>(&geometry);
+    volume->add_grid(sphere);
+    geometry.attach_component(volume);
+    auto tree = &sphere->tree();
+    sphere.reset();
+
+    auto grid = volume->get_grid_for_write<openvdb::FloatGrid>("surface");
+    ASSERT_TRUE(grid);
+    EXPECT_EQ(&grid->tree(), tree);
+}
@@ -0,0 +1,237 @@
+#include "GCore/usd_stage_cache.h"
+
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usdSkel/animQuery.h>
+
+#include <algorithm>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+UsdAnimationPrefetcher::UsdAnimationPrefetcher(
+    const pxr::UsdGeomMesh& mesh,
+    const pxr::UsdSkelSkeletonQuery& skel_query,
+    size_t window)
+    : stage(mesh.GetPrim().GetStage()),
+      mesh(mesh),
+      skel_query(skel_query),
+      window(window)
+{
+    std::vector<double> times;
+    mesh.GetPointsAttr().GetTimeSamples(&sample_times);
+    if (skel_query) {
+        skel_query.GetAnimQuery().GetJointTransformTimeSamples(&times);
+        sample_times.insert(sample_times.end(), times.begin(), times.end());
+    }
+    std::sort(sample_times.begin(), sample_times.end());
+    sample_times.erase(
+        std::unique(sample_times.begin(), sample_times.end()),
+        sample_times.end());
+
+    if (window > 0 && !sample_times.empty()) {
+        worker = std::thread([this] { run(); });
+    }
+}
+
+UsdAnimationPrefetcher::~UsdAnimationPrefetcher()
+{
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+UsdAnimationPrefetcher::Frame UsdAnimationPrefetcher::read(
+    pxr::UsdTimeCode time) const
+{
+    Frame frame;
+    mesh.GetPointsAttr().Get(&frame.points, time);
+    if (skel_query) {
+        skel_query.ComputeJointLocalTransforms(
+            &frame.joint_local_transforms, time);
+    }
+    return frame;
+}
+
+UsdAnimationPrefetcher::Frame UsdAnimationPrefetcher::fetch(
+    pxr::UsdTimeCode time)
+{
+    if (time.IsDefault() || sample_times.empty()) {
+        return read(time);
+    }
+
+    auto t = time.GetValue();
+    Frame frame;
+    bool hit = false;
+    {
+        std::lock_guard lock(mutex);
+        auto it = frames.find(t);
+        if (it != frames.end()) {
+            frame = it->second;
+            hit = true;
+        }
+    }
+    if (!hit) {
+        frame = read(time);
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        window_begin = std::distance(
+            sample_times.begin(),
+            std::upper_bound(sample_times.begin(), sample_times.end(), t));
+        window_end = std::min(window_begin + window, sample_times.size());
+
+        // Drop what is behind the playhead or too far ahead of it.
+        auto lower = window_begin < sample_times.size()
+                         ? sample_times[window_begin]
+                         : sample_times.back();
+        auto upper = window_end > 0 ? sample_times[window_end - 1] : lower;
+        std::erase_if(frames, [&](const auto& item) {
+            return item.first < lower || item.first > upper;
+        });
+    }
+    cv.notify_all();
+    return frame;
+}
+
+void UsdAnimationPrefetcher::run()
+{
+    std::unique_lock lock(mutex);
+    while (true) {
+        double next = 0;
+        auto missing = [&] {
+            for (size_t i = window_begin; i < window_end; ++i) {
+                if (!frames.contains(sample_times[i])) {
+                    next = sample_times[i];
+                    return true;
+                }
+            }
+            return false;
+        };
+        cv.wait(lock, [&] { return stop || missing(); });
+        if (stop) {
+            return;
+        }
+
+        lock.unlock();
+        auto frame = read(pxr::UsdTimeCode(next));
+        lock.lock();
+
+        auto in_window = window_begin < window_end &&
+                         next >= sample_times[window_begin] &&
+                         next <= sample_times[window_end - 1];
+        if (in_window) {
+            frames.emplace(next, std::move(frame));
+        }
+    }
+}
+
+UsdFileStageCache& UsdFileStageCache::instance()
+{
+    static UsdFileStageCache cache;
+    return cache;
+}
+
+UsdFileStageCache::Entry* UsdFileStageCache::acquire(
+    const std::string& file_name)
+{
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(file_name, ec);
+    if (ec) {
+        // Not a file on disk (anonymous or missing), nothing to share.
+        return nullptr;
+    }
+
+    auto it = entries.find(file_name);
+    if (it != entries.end()) {
+        if (it->second.write_time == write_time &&
+            stage_cache.Find(it->second.id)) {
+            it->second.last_used = ++use_counter;
+            return &it->second;
+        }
+        stage_cache.Erase(it->second.id);
+        entries.erase(it);
+
+        // The layer registry may still hold the outdated layer.
+        if (auto layer = pxr::SdfLayer::Find(file_name)) {
+            layer->Reload();
+        }
+    }
+
+    auto stage = pxr::UsdStage::Open(file_name);
+    if (!stage) {
+        return nullptr;
+    }
+
+    Entry entry;
+    entry.id = stage_cache.Insert(stage);
+    entry.write_time = write_time;
+    entry.last_used = ++use_counter;
+    entry.skel_cache = std::make_shared<pxr::UsdSkelCache>();
+
+    auto& inserted = entries[file_name] = std::move(entry);
+    evict();
+    return &inserted;
+}
+
+void UsdFileStageCache::evict()
+{
+    while (entries.size() > capacity) {
+        auto oldest = std::min_element(
+            entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.second.last_used < b.second.last_used;
+            });
+        stage_cache.Erase(oldest->second.id);
+        entries.erase(oldest);
+    }
+}
+
+UsdFileStageCache::CachedStage UsdFileStageCache::open(
+    const std::string& file_name)
+{
+    std::lock_guard lock(mutex);
+    auto entry = acquire(file_name);
+    if (!entry) {
+        return { pxr::UsdStage::Open(file_name),
+                 std::make_shared<pxr::UsdSkelCache>() };
+    }
+    return { stage_cache.Find(entry->id), entry->skel_cache };
+}
+
+std::shared_ptr<UsdAnimationPrefetcher> UsdFileStageCache::open_animation(
+    const std::string& file_name,
+    const pxr::UsdGeomMesh& mesh,
+    const pxr::UsdSkelSkeletonQuery& skel_query)
+{
+    std::lock_guard lock(mutex);
+    auto entry = acquire(file_name);
+    if (!entry) {
+        return std::make_shared<UsdAnimationPrefetcher>(mesh, skel_query, 0);
+    }
+
+    auto& animation = entry->animations[mesh.GetPath()];
+    if (!animation) {
+        animation = std::make_shared<UsdAnimationPrefetcher>(mesh, skel_query);
+    }
+    return animation;
+}
+
+void UsdFileStageCache::set_capacity(size_t capacity)
+{
+    std::lock_guard lock(mutex);
+    this->capacity = std::max<size_t>(capacity, 1);
+    evict();
+}
+
+void UsdFileStageCache::clear()
+{
+    std::lock_guard lock(mutex);
+    entries.clear();
+    stage_cache.Clear();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
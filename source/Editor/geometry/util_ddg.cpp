@@ -0,0 +1,210 @@
+#include "GCore/util_ddg.h"
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+FaceStencilPattern::FaceStencilPattern(
+    int vertex_count,
+    const pxr::VtArray<int>& triangles)
+    : vertex_count_(vertex_count),
+      triangles_(triangles)
+{
+    const int* tri = triangles.cdata();
+    size_t face_count = triangles.size() / 3;
+
+    std::vector<Eigen::Triplet<double>> triplets(face_count * 9);
+    for (size_t f = 0; f < face_count; ++f) {
+        for (int k = 0; k < 9; ++k) {
+            triplets[f * 9 + k] = Eigen::Triplet<double>(
+                tri[3 * f + k / 3], tri[3 * f + k % 3], 0.0);
+        }
+    }
+    pattern_.resize(vertex_count, vertex_count);
+    pattern_.setFromTriplets(triplets.begin(), triplets.end());
+    pattern_.makeCompressed();
+
+    // The nonzero of every face entry, by a binary search in its column.
+    std::vector<int> entry_nonzero(face_count * 9);
+    const int* outer = pattern_.outerIndexPtr();
+    const int* inner = pattern_.innerIndexPtr();
+    pxr::WorkParallelForN(face_count, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            for (int k = 0; k < 9; ++k) {
+                int row = tri[3 * f + k / 3];
+                int col = tri[3 * f + k % 3];
+                entry_nonzero[f * 9 + k] = int(
+                    std::lower_bound(
+                        inner + outer[col], inner + outer[col + 1], row) -
+                    inner);
+            }
+        }
+    });
+
+    // Both lists are grouped by a counting sort.
+    auto group = [](const std::vector<int>& keys,
+                    size_t key_count,
+                    std::vector<int>& offsets,
+                    std::vector<int>& items) {
+        offsets.assign(key_count + 1, 0);
+        for (int key : keys) {
+            ++offsets[key + 1];
+        }
+        for (size_t i = 0; i < key_count; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        items.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            items[next[keys[i]]++] = int(i);
+        }
+    };
+
+    group(entry_nonzero, pattern_.nonZeros(), entry_offsets_, entries_);
+    group(
+        std::vector<int>(tri, tri + face_count * 3),
+        vertex_count,
+        corner_offsets_,
+        corners_);
+}
+
+bool FaceStencilPattern::matches(
+    int vertex_count,
+    const pxr::VtArray<int>& triangles) const
+{
+    return vertex_count_ == vertex_count && triangles_ == triangles;
+}
+
+Eigen::SparseMatrix<double> FaceStencilPattern::assemble(
+    const std::vector<double>& face_values) const
+{
+    Eigen::SparseMatrix<double> matrix = pattern_;
+    double* values = matrix.valuePtr();
+    pxr::WorkParallelForN(matrix.nonZeros(), [&](size_t begin, size_t end) {
+        for (size_t nz = begin; nz < end; ++nz) {
+            double sum = 0;
+            for (int k = entry_offsets_[nz]; k < entry_offsets_[nz + 1]; ++k) {
+                sum += face_values[entries_[k]];
+            }
+            values[nz] = sum;
+        }
+    });
+    return matrix;
+}
+
+std::shared_ptr<const FaceStencilPattern> face_stencil_pattern(
+    int vertex_count,
+    const pxr::VtArray<int>& triangles)
+{
+    static constexpr size_t cache_size = 4;
+    static std::mutex mutex;
+    static std::list<std::shared_ptr<const FaceStencilPattern>> cache;
+
+    {
+        std::lock_guard lock(mutex);
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if ((*it)->matches(vertex_count, triangles)) {
+                cache.splice(cache.begin(), cache, it);
+                return cache.front();
+            }
+        }
+    }
+
+    auto pattern =
+        std::make_shared<const FaceStencilPattern>(vertex_count, triangles);
+
+    std::lock_guard lock(mutex);
+    cache.push_front(pattern);
+    if (cache.size() > cache_size) {
+        cache.pop_back();
+    }
+    return pattern;
+}
+
+TriangleMeshDDG::TriangleMeshDDG(
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const pxr::VtArray<int>& face_vertex_counts,
+    const pxr::VtArray<int>& face_vertex_indices)
+    : triangles_(face_vertex_indices)
+{
+    if (face_vertex_indices.size() != face_vertex_counts.size() * 3 ||
+        std::any_of(
+            face_vertex_counts.begin(),
+            face_vertex_counts.end(),
+            [](int count) { return count != 3; })) {
+        throw std::runtime_error("The mesh must be triangulated.");
+    }
+
+    pattern_ = face_stencil_pattern(int(vertices.size()), triangles_);
+
+    int n = face_count();
+    cotangents_.resize(n);
+    areas_.resize(n);
+    frames_.resize(n);
+    pxr::WorkParallelForN(n, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            const int* v = face(int(f));
+            Eigen::Vector3d p[3];
+            for (int i = 0; i < 3; ++i) {
+                auto& point = vertices[v[i]];
+                p[i] = Eigen::Vector3d(point[0], point[1], point[2]);
+            }
+
+            double double_area = (p[1] - p[0]).cross(p[2] - p[0]).norm();
+            areas_[f] = double_area / 2;
+            for (int i = 0; i < 3; ++i) {
+                Eigen::Vector3d a = p[(i + 1) % 3] - p[i];
+                Eigen::Vector3d b = p[(i + 2) % 3] - p[i];
+                cotangents_[f][i] = a.dot(b) / double_area;
+            }
+
+            Eigen::Vector3d e = p[1] - p[0];
+            double length = e.norm();
+            frames_[f] << 0, 0, length, 0, e.dot(p[2] - p[0]) / length,
+                double_area / length;
+        }
+    });
+}
+
+Eigen::SparseMatrix<double> TriangleMeshDDG::cotangent_laplacian() const
+{
+    std::vector<double> face_values(face_count() * 9);
+    pxr::WorkParallelForN(face_count(), [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            double* m = face_values.data() + f * 9;
+            std::fill(m, m + 9, 0.0);
+            for (int k = 0; k < 3; ++k) {
+                int i = (k + 1) % 3;
+                int j = (k + 2) % 3;
+                double w = cotangents_[f][k] / 2;
+                m[i * 3 + j] -= w;
+                m[j * 3 + i] -= w;
+                m[i * 3 + i] += w;
+                m[j * 3 + j] += w;
+            }
+        }
+    });
+    return pattern_->assemble(face_values);
+}
+
+Eigen::SparseMatrix<double> TriangleMeshDDG::mass_matrix() const
+{
+    std::vector<double> corner_areas(face_count() * 3);
+    for (int f = 0; f < face_count(); ++f) {
+        std::fill_n(corner_areas.data() + 3 * f, 3, areas_[f] / 3);
+    }
+    auto vertex_areas = pattern_->gather_corners(corner_areas, 0.0);
+
+    std::vector<Eigen::Triplet<double>> triplets(vertex_count());
+    for (int v = 0; v < vertex_count(); ++v) {
+        triplets[v] = Eigen::Triplet<double>(v, v, vertex_areas[v]);
+    }
+    Eigen::SparseMatrix<double> mass(vertex_count(), vertex_count());
+    mass.setFromTriplets(triplets.begin(), triplets.end());
+    return mass;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,126 @@
+#include "GCore/util_openvdb.h"
+
+#include <openvdb/tools/ParticlesToLevelSet.h>
+#include <openvdb/tools/VolumeToMesh.h>
+
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+using namespace openvdb;
+
+struct WrappingParticleList {
+    using PosType = openvdb::Vec3R;
+    WrappingParticleList(
+        const pxr::VtArray<pxr::GfVec3f>& points_vertices,
+        const pxr::VtArray<float>& points_widths)
+        : points_vertices(points_vertices),
+          points_widths(points_widths)
+    {
+    }
+
+    // Return the total number of particles in the list.
+    // Always required!
+    size_t size() const
+    {
+        return points_vertices.size();
+    }
+
+    // Get the world-space position of the nth particle.
+    // Required by rasterizeSpheres().
+    void getPos(size_t n, Vec3R& xyz) const
+    {
+        auto& point = points_vertices[n];
+        xyz = { point[0], point[1], point[2] };
+    }
+
+    // Get the world-space position and radius of the nth particle.
+    // Required by rasterizeSpheres().
+    void getPosRad(size_t n, Vec3R& xyz, Real& radius) const
+    {
+        radius = points_widths[n];
+        auto& point = points_vertices[n];
+        xyz = { point[0], point[1], point[2] };
+    }
+
+    // Get the world-space position, radius and velocity of the nth particle.
+    // Required by rasterizeTrails().
+    void getPosRadVel(size_t n, Vec3R& xyz, Real& radius, Vec3R& velocity)
+        const;
+
+    const pxr::VtArray<pxr::GfVec3f>& points_vertices;
+    const pxr::VtArray<float>& points_widths;
+};
+
+openvdb::FloatGrid::Ptr spheres_to_level_set(
+    const pxr::VtArray<pxr::GfVec3f>& centers,
+    const pxr::VtArray<float>& radii,
+    float voxel_size)
+{
+    auto pa = WrappingParticleList(centers, radii);
+
+    openvdb::FloatGrid::Ptr grid =
+        openvdb::createLevelSet<openvdb::FloatGrid>(voxel_size);
+    grid->setName("surface");
+    openvdb::tools::ParticlesToLevelSet<openvdb::FloatGrid> raster(*grid);
+
+    raster.setGrainSize(1);  // a value of zero disables threading
+    raster.rasterizeSpheres(pa);
+    raster.finalize(true);
+
+    return grid;
+}
+
+Geometry level_set_to_operand(
+    const openvdb::FloatGrid& grid,
+    float isovalue,
+    float adaptivity)
+{
+    std::vector<openvdb::Vec3s> converted_points;
+    std::vector<openvdb::Vec4I> converted_quads;
+    std::vector<openvdb::Vec3I> converted_triangles;
+
+    openvdb::tools::volumeToMesh(
+        grid,
+        converted_points,
+        converted_triangles,
+        converted_quads,
+        isovalue,
+        adaptivity);
+
+    pxr::VtArray<pxr::GfVec3f> mesh_vertices(converted_points.size());
+    for (size_t i = 0; i < converted_points.size(); ++i) {
+        auto& point = converted_points[i];
+        mesh_vertices[i] = pxr::GfVec3f(point[0], point[1], point[2]);
+    }
+
+    auto face_count = converted_quads.size() + converted_triangles.size();
+    pxr::VtArray<int> mesh_faceVertexCounts(face_count);
+    pxr::VtArray<int> mesh_faceVertexIndices(
+        converted_quads.size() * 4 + converted_triangles.size() * 3);
+
+    size_t face = 0;
+    size_t corner = 0;
+    for (auto&& quad : converted_quads) {
+        mesh_faceVertexCounts[face++] = 4;
+        for (int j = 0; j < 4; ++j) {
+            mesh_faceVertexIndices[corner++] = quad[j];
+        }
+    }
+    for (auto&& triangle : converted_triangles) {
+        mesh_faceVertexCounts[face++] = 3;
+        for (int j = 0; j < 3; ++j) {
+            mesh_faceVertexIndices[corner++] = triangle[j];
+        }
+    }
+
+    auto mesh_geometry = Geometry();
+    auto mesh_component = std::make_shared<MeshComponent>(&mesh_geometry);
+    mesh_geometry.attach_component(mesh_component);
+
+    mesh_component->set_vertices(mesh_vertices);
+    mesh_component->set_face_vertex_counts(mesh_faceVertexCounts);
+    mesh_component->set_face_vertex_indices(mesh_faceVertexIndices);
+    return mesh_geometry;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
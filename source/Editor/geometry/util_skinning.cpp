@@ -0,0 +1,73 @@
+#include "GCore/util_skinning.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "GCore/Components/SkelComponent.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+SkinningInfluences build_skinning_influences(
+    const SkelComponent& skel,
+    size_t point_count,
+    size_t joint_count)
+{
+    auto& joint_indices = skel.jointIndices;
+    auto& joint_weights = skel.jointWeight;
+    if (joint_indices.empty() || joint_indices.size() != joint_weights.size()) {
+        throw std::runtime_error("Joint indices and weights do not match.");
+    }
+
+    // Constant influences are one set for the whole mesh, vertex ones a set
+    // of elementSize influences per point.
+    bool constant = skel.jointInterpolation == pxr::UsdGeomTokens->constant;
+    size_t rows = constant ? 1 : point_count;
+    size_t element_size = std::max(skel.jointElementSize, 1);
+    if (joint_indices.size() != rows * element_size) {
+        throw std::runtime_error("Joint influences do not match the points.");
+    }
+
+    auto valid = [&](size_t i) {
+        return joint_weights[i] > 0.f && joint_indices[i] >= 0 &&
+               size_t(joint_indices[i]) < joint_count;
+    };
+
+    size_t influence_count = 1;
+    for (size_t row = 0; row < rows; ++row) {
+        size_t count = 0;
+        for (size_t e = 0; e < element_size; ++e) {
+            count += valid(row * element_size + e);
+        }
+        influence_count = std::max(influence_count, count);
+    }
+
+    SkinningInfluences influences;
+    influences.constant = constant;
+    influences.influence_count = influence_count;
+    influences.indices.assign(rows * influence_count, 0);
+    influences.weights.assign(rows * influence_count, 0.f);
+
+    for (size_t row = 0; row < rows; ++row) {
+        auto indices = influences.indices.data() + row * influence_count;
+        auto weights = influences.weights.data() + row * influence_count;
+        size_t count = 0;
+        float sum = 0;
+        for (size_t e = 0; e < element_size; ++e) {
+            auto i = row * element_size + e;
+            if (valid(i)) {
+                indices[count] = joint_indices[i];
+                weights[count] = joint_weights[i];
+                sum += joint_weights[i];
+                ++count;
+            }
+        }
+        // Points without influences keep a zero first weight and are left
+        // where they are.
+        for (size_t k = 0; k < count; ++k) {
+            weights[k] /= sum;
+        }
+    }
+    return influences;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "GCore/util_ddg.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/reduce.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Closest rotation and similarity to S from the closed form SVD of a 2x2
+// matrix. With e = S00 + S11 and h = S10 - S01, S = Rot(phi) diag(q + r,
+// q - r) Rot(theta) where q = |(e, h)| / 2 and phi + theta = atan2(h, e), q - r
+// being negative when S flips. The rotation maximizing tr(R^T S) without a
+// reflection is then Rot(phi + theta) and tr(R^T S) = 2q, so no trigonometry
+// or iterative SVD is needed.
+//
+// The similarity m R minimizes sum w |u - m R x|^2 for S and scale as given
+// below, with m = 2q / scale.
+inline Eigen::Matrix2d closest_similarity(
+    const Eigen::Matrix2d& S,
+    double scale,
+    bool rotation_only)
+{
+    double e = S(0, 0) + S(1, 1);
+    double h = S(1, 0) - S(0, 1);
+    double norm = std::hypot(e, h);
+    if (norm == 0) {
+        return Eigen::Matrix2d::Identity();
+    }
+    double divisor = rotation_only || scale <= 0 ? norm : scale;
+    Eigen::Matrix2d R;
+    R << e, -h, h, e;
+    return R / divisor;
+}
+
+// Kept by the parameterization nodes to warm start from their last result.
+// The input arrays are held, so an unchanged input usually shares their
+// buffers and is recognized without comparing elements.
+struct LocalGlobalStorage {
+    static constexpr bool has_storage = false;
+
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> face_vertex_indices;
+    pxr::VtArray<pxr::GfVec3f> uv;
+
+    bool matches(
+        const pxr::VtArray<pxr::GfVec3f>& input_vertices,
+        const pxr::VtArray<int>& input_indices) const
+    {
+        return !uv.empty() && vertices == input_vertices &&
+               face_vertex_indices == input_indices;
+    }
+};
+
+// Local/global parameterization (Liu et al. 2008). Every face is fitted with
+// a linear map from its isometric frame to the uv plane, then the uv
+// coordinates are solved for with these maps fixed, using the cotangent
+// Laplacian factorized once. fit(S, scale) returns the map of a face from
+// S = sum w (u_i - u_j)(x_i - x_j)^T and scale = sum w |x_i - x_j|^2 over its
+// edges, w being half the cotangent of the opposite angle.
+//
+// Vertex 0 keeps its initial position. Iterating stops once the energy
+// changes by at most tolerance. Returns the uv coordinates as points with
+// z = 0.
+template<typename Fit>
+pxr::VtArray<pxr::GfVec3f> local_global_parameterize(
+    const TriangleMeshDDG& ddg,
+    const pxr::VtArray<pxr::GfVec3f>& initial,
+    Fit&& fit,
+    int max_iterations = 300,
+    double tolerance = 1e-7)
+{
+    const int n_vertices = ddg.vertex_count();
+    const int n_faces = ddg.face_count();
+    if (int(initial.size()) != n_vertices) {
+        throw std::runtime_error(
+            "Parameterization: Initialization does not match the mesh.");
+    }
+
+    Eigen::MatrixX2d u(n_vertices, 2);
+    for (int v = 0; v < n_vertices; ++v) {
+        u.row(v) << initial[v][0], initial[v][1];
+    }
+
+    // The pinned vertex is moved to the right hand side, so the system stays
+    // symmetric.
+    Eigen::SparseMatrix<double> A = ddg.cotangent_laplacian();
+    Eigen::VectorXd pin = A.col(0);
+    pin[0] = 0;
+    A.prune([](int row, int col, double) {
+        return row == col || (row != 0 && col != 0);
+    });
+    A.coeffRef(0, 0) = 1;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error("Parameterization: Degenerate mesh.");
+    }
+    const Eigen::RowVector2d u0 = u.row(0);
+
+    auto edge = [&](int f, int k, const Eigen::MatrixX2d& uv,
+                    Eigen::Vector2d& du, Eigen::Vector2d& dx) {
+        const int* v = ddg.face(f);
+        int i = (k + 1) % 3, j = (k + 2) % 3;
+        du = (uv.row(v[i]) - uv.row(v[j])).transpose();
+        dx = (ddg.frames()[f].row(i) - ddg.frames()[f].row(j)).transpose();
+        return ddg.cotangents()[f][k] / 2;
+    };
+
+    std::vector<Eigen::Matrix2d> maps(n_faces);
+    std::vector<Eigen::Vector2d> corners(n_faces * 3);
+    double energy = 0;
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        // Local step, which also writes the right hand side of the global
+        // step per corner, b_i = sum w L (x_i - x_j) over the edges at i.
+        pxr::WorkParallelForN(n_faces, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                Eigen::Vector2d du[3], dx[3];
+                double w[3];
+                Eigen::Matrix2d S = Eigen::Matrix2d::Zero();
+                double scale = 0;
+                for (int k = 0; k < 3; ++k) {
+                    w[k] = edge(int(f), k, u, du[k], dx[k]);
+                    S += w[k] * du[k] * dx[k].transpose();
+                    scale += w[k] * dx[k].squaredNorm();
+                }
+                maps[f] = fit(S, scale);
+
+                Eigen::Vector2d* corner = corners.data() + 3 * f;
+                corner[0].setZero();
+                corner[1].setZero();
+                corner[2].setZero();
+                for (int k = 0; k < 3; ++k) {
+                    Eigen::Vector2d r = w[k] * maps[f] * dx[k];
+                    corner[(k + 1) % 3] += r;
+                    corner[(k + 2) % 3] -= r;
+                }
+            }
+        });
+
+        // Global step.
+        auto b_values = ddg.pattern().gather_corners<Eigen::Vector2d>(
+            corners, Eigen::Vector2d::Zero());
+        Eigen::MatrixX2d b(n_vertices, 2);
+        for (int v = 0; v < n_vertices; ++v) {
+            b.row(v) = b_values[v].transpose() - pin[v] * u0;
+        }
+        b.row(0) = u0;
+        u = solver.solve(b);
+
+        double previous = energy;
+        energy = pxr::WorkParallelReduceN(
+            0.0,
+            n_faces,
+            [&](size_t begin, size_t end, double sum) {
+                for (size_t f = begin; f < end; ++f) {
+                    for (int k = 0; k < 3; ++k) {
+                        Eigen::Vector2d du, dx;
+                        double w = edge(int(f), k, u, du, dx);
+                        sum += w * (du - maps[f] * dx).squaredNorm();
+                    }
+                }
+                return sum;
+            },
+            std::plus<double>());
+        if (iteration > 0 && std::abs(energy - previous) <= tolerance) {
+            break;
+        }
+    }
+
+    pxr::VtArray<pxr::GfVec3f> result(n_vertices);
+    for (int v = 0; v < n_vertices; ++v) {
+        result[v] = pxr::GfVec3f(float(u(v, 0)), float(u(v, 1)), 0);
+    }
+    return result;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -1,11 +1,7 @@
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
 #include "geom_node_base.h"
-#include <cmath>
+#include "local_global_param.h"
 #include <time.h>
-#include <Eigen/Dense>
-#include <Eigen/SparseLU>
-#include <Eigen/Sparse>
 
 /*
 ** @brief HW5_ARAP_Parameterization
@@ -34,6 +30,11 @@ NODE_DECLARATION_FUNCTION(arap)
     // Maybe you need to add another input for initialization?
     b.add_input<Geometry>("Input");
     b.add_input<Geometry>("Initialization");
+    b.add_input<int>("Max iterations").min(1).max(1000).default_val(300);
+    b.add_input<double>("Tolerance").min(0).max(1).default_val(1e-7);
+    // Start from the last result instead of the initialization when the input
+    // mesh did not change.
+    b.add_input<bool>("Warm start").default_val(false);
 
     /*
     ** NOTE: You can add more inputs or outputs if necessary. For example, in
@@ -62,254 +63,54 @@ NODE_EXECUTION_FUNCTION(arap)
     auto input = params.get_input<Geometry>("Input");
     auto iters = params.get_input<Geometry>("Initialization");
 
+    auto mesh = input.get_component<MeshComponent>();
+    auto iter_mesh = iters.get_component<MeshComponent>();
+
     // Avoid processing the node when there is no input
-    if (!input.get_component<MeshComponent>() || !iters.get_component<MeshComponent>()) {
+    if (!mesh || !iter_mesh) {
         throw std::runtime_error("ARAP Parameterization: Need Geometry Input.");
     }
 
-    /* ----------------------------- Preprocess -------------------------------
-    ** Create a halfedge structure (using OpenMesh) for the input mesh. The
-    ** half-edge data structure is a widely used data structure in geometric
-    ** processing, offering convenient operations for traversing and modifying
-    ** mesh elements.
-    */
-
-    // Initialization
     clock_t start_time = clock();
-    auto halfedge_mesh = operand_to_openmesh(&input);
-    auto iter_mesh = operand_to_openmesh(&iters);
-    int n_faces = halfedge_mesh->n_faces();
-    int n_vertices = halfedge_mesh->n_vertices();
-
-    // Construct a set of new triangles
-    std::vector<std::vector<Eigen::Vector2d>> edges(n_faces);
-    Eigen::SparseMatrix<double> cotangents(n_vertices, n_vertices);
-
-    std::vector<Eigen::Triplet<double>> triple;
-    triple.push_back(Eigen::Triplet<double>(0, 0, 1));
-
-    for (auto const& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        std::vector<int> vertex_idx(3);
-        std::vector<double> edge_length(3);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices())
-            vertex_idx[i++] = vertex_handle.idx();
 
-        for (int i = 0; i < 3; i++)
-            edge_length[i] =
-                (halfedge_mesh->point(
-                     halfedge_mesh->vertex_handle(vertex_idx[(i + 1) % 3])) -
-                 halfedge_mesh->point(
-                     halfedge_mesh->vertex_handle(vertex_idx[(i + 2) % 3])))
-                    .length();
+    auto vertices = mesh->get_vertices();
+    auto face_vertex_indices = mesh->get_face_vertex_indices();
 
-        // Record the edges of the face
-        // Their indexes are related to the point indexes opposite to them
-        edges[face_idx].resize(3);
-        double cos_angle =
-            (edge_length[1] * edge_length[1] + edge_length[2] * edge_length[2] -
-             edge_length[0] * edge_length[0]) /
-            (2 * edge_length[1] * edge_length[2]);
-        double sin_angle = sqrt(1 - cos_angle * cos_angle);
-        edges[face_idx][1] << -edge_length[1] * cos_angle,
-            -edge_length[1] * sin_angle;
-        edges[face_idx][2] << edge_length[2], 0;
-        edges[face_idx][0] = -edges[face_idx][1] - edges[face_idx][2];
-
-        // Calculate the cotangent values of the angles in this face
-        // Their indexes are related to the edge indexes opposite to them,
-        // orderly
-        for (int i = 0; i < 3; i++) {
-            double cos_value =
-                edges[face_idx][i].dot(edges[face_idx][(i + 1) % 3]) /
-                (edges[face_idx][i].norm() *
-                 edges[face_idx][(i + 1) % 3].norm());
-            double sin_value = sqrt(1 - cos_value * cos_value);
-            double cot_value = cos_value / sin_value;
-            cotangents.coeffRef(vertex_idx[i], vertex_idx[(i + 1) % 3]) =
-                cot_value;
-            if (vertex_idx[i] == 0) {
-                triple.push_back(Eigen::Triplet<double>(
-                    vertex_idx[(i + 1) % 3],
-                    vertex_idx[(i + 1) % 3],
-                    cot_value));
-            }
-            else if (vertex_idx[(i + 1) % 3] == 0) {
-                triple.push_back(Eigen::Triplet<double>(vertex_idx[i], vertex_idx[i], cot_value));
-            }
-            else {
-                triple.push_back(Eigen::Triplet<double>(vertex_idx[i], vertex_idx[(i + 1) % 3], -cot_value));
-                triple.push_back(Eigen::Triplet<double>(vertex_idx[(i + 1) % 3], vertex_idx[i], -cot_value));
-                triple.push_back(Eigen::Triplet<double>(vertex_idx[i], vertex_idx[i], cot_value));
-                triple.push_back(Eigen::Triplet<double>(vertex_idx[(i + 1) % 3], vertex_idx[(i + 1) % 3], cot_value));
-            }
-        }
-    }
-
-    // Construct the matrix of the function, which can be precomputed before
-    // iteration
-    Eigen::SparseMatrix<double> A(n_vertices, n_vertices);
-    A.setFromTriplets(triple.begin(), triple.end());
-
-    // Precompute the matrix
-    Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
-    solver.compute(A);
-
-    // A few changes is done here, for some more precomputation for each faces
-    std::vector<Eigen::MatrixXd> b_pre(n_faces);
-    std::vector<Eigen::MatrixXd> Jacobi_pre(n_faces);
-    Eigen::MatrixXd Edges(3, 2);
-    Eigen::MatrixXd Cotangents = Eigen::MatrixXd::Identity(3, 3);
-    Eigen::MatrixXd transform_matrix(3, 3);
-    transform_matrix << 1, -1, 0, 0, 1, -1, -1, 0, 1;
-    for (const auto& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        std::vector<int> vertex_idx(3);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices())
-            vertex_idx[i++] = vertex_handle.idx();
-        for (int i = 0; i < 3; i++)
-            Edges.row(i) = edges[face_idx][(i + 2) % 3];
-        for (int i = 0; i < 3; i++)
-            Cotangents(i, i) =
-                cotangents.coeffRef(vertex_idx[i], vertex_idx[(i + 1) % 3]);
-        Jacobi_pre[face_idx] = Cotangents * Edges;
-        b_pre[face_idx] = -Jacobi_pre[face_idx].transpose() * transform_matrix;
-    }
+    // Cotangents, frames and the Laplacian pattern of the input mesh, the
+    // pattern being shared with other nodes working on the same topology.
+    TriangleMeshDDG ddg(
+        vertices, mesh->get_face_vertex_counts(), face_vertex_indices);
 
-    int max_iter = 300;
-    int now_iter = 0;
-    double err_pre = -1e9;
-    double err = 1e9;
-    Eigen::VectorXd bx(n_vertices);
-    Eigen::VectorXd by(n_vertices);
-    std::vector<Eigen::Matrix2d> Jacobi(n_faces);
-    // Begin iteration
-    do {
-        bx.setZero();
-        by.setZero();
-        for (const auto& face_handle : iter_mesh->faces()) {
-            int face_idx = face_handle.idx();
+    auto& storage = params.get_storage<LocalGlobalStorage&>();
+    bool warm = params.get_input<bool>("Warm start") &&
+                storage.matches(vertices, face_vertex_indices);
 
-            // Calculate the Jacobian matrix of each faces
-            std::vector<int> vertex_idx(3);
-            int i = 0;
-            for (const auto& vertex_handle : face_handle.vertices())
-                vertex_idx[i++] = vertex_handle.idx();
-            Eigen::MatrixXd U(2, 3);
-            for (int i = 0; i < 3; i++) {
-                const auto& v0 = iter_mesh->point(iter_mesh->vertex_handle(vertex_idx[i]));
-                const auto& v1 = iter_mesh->point(iter_mesh->vertex_handle(vertex_idx[(i + 1) % 3]));
-                U(0, i) = (v1 - v0)[0];
-                U(1, i) = (v1 - v0)[1];
-            }
-            Jacobi[face_idx] = U * Jacobi_pre[face_idx];
+    // Local phase fits every face with a rotation, flips excluded.
+    auto uv = local_global_parameterize(
+        ddg,
+        warm ? storage.uv : iter_mesh->get_vertices(),
+        [](const Eigen::Matrix2d& S, double scale) {
+            return closest_similarity(S, scale, true);
+        },
+        params.get_input<int>("Max iterations"),
+        params.get_input<double>("Tolerance"));
 
-            // Use SVD deformation to determine whether there is a flip, and set
-            // the sigular values of the Jacobian matrix 1
-            Eigen::JacobiSVD<Eigen::MatrixXd> svd(
-                Jacobi[face_idx],
-                Eigen::DecompositionOptions::ComputeThinU |
-                    Eigen::DecompositionOptions::ComputeThinV);
-            Eigen::MatrixXd svd_u = svd.matrixU();
-            Eigen::MatrixXd svd_v = svd.matrixV();
-            Eigen::MatrixXd S = Eigen::MatrixXd::Identity(2, 2);
-            if (Jacobi[face_idx].determinant() < 0) {
-                // If there is a flip, set the fliped sigular values 1 instead
-                // of -1
-                if (svd.singularValues()[0] < svd.singularValues()[1])
-                    S(0, 0) = -1;
-                else
-                    S(1, 1) = -1;
-            }
-            Jacobi[face_idx] = svd_u * S * svd_v.transpose();
-
-            // Calculate bx and by by matrix multilplication
-            Eigen::MatrixXd b = Jacobi[face_idx] * b_pre[face_idx];
-            for (int i = 0; i < 3; i++) {
-                if (vertex_idx[i] != 0) {
-                    bx(vertex_idx[i]) += b(0, i);
-                    by(vertex_idx[i]) += b(1, i);
-                }
-            }
-        }
-        bx(0) = 0;
-        by(0) = 0;
-        // Solve the linear equations
-        Eigen::VectorXd ux = bx;
-        ux = solver.solve(ux);
-        Eigen::VectorXd uy = by;
-        uy = solver.solve(uy);
-        
-        // Set the answers back to iter mesh
-        for (const auto& vertex_handle : iter_mesh->vertices()) {
-            int vertex_idx = vertex_handle.idx();
-            iter_mesh->point(vertex_handle)[0] = ux(vertex_idx);
-            iter_mesh->point(vertex_handle)[1] = uy(vertex_idx);
-            iter_mesh->point(vertex_handle)[2] = 0;
-        }
-
-        // Calculate the error
-        err_pre = err;
-        err = 0;
-        for (const auto& face_handle : iter_mesh->faces()) {
-            int face_idx = face_handle.idx();
-            std::vector<int> vertex_idx(3);
-            int i = 0;
-            for (const auto& vertex_handle : face_handle.vertices())
-                vertex_idx[i++] = vertex_handle.idx();
-            for (int i = 0; i < 3; i++) {
-                int idx0 = vertex_idx[(i + 1) % 3];
-                int idx1 = vertex_idx[(i + 2) % 3];
-                const auto& tmp_edge =
-                    iter_mesh->point(iter_mesh->vertex_handle(idx1)) -
-                    iter_mesh->point(iter_mesh->vertex_handle(idx0));
-                Eigen::Vector2d iter_edge;
-                iter_edge << tmp_edge[0], tmp_edge[1];
-                const auto& ori_edge = edges[face_idx][i];
-                err += 0.5 * abs(cotangents.coeffRef(idx0, idx1)) *
-                       (iter_edge - Jacobi[face_idx] * ori_edge).squaredNorm();
-            }
-        }
-        now_iter++;
-        //std::cout << now_iter << "\t" << err << std::endl;
-    } while (now_iter < max_iter && abs(err - err_pre) > 1e-7);
+    storage.vertices = vertices;
+    storage.face_vertex_indices = face_vertex_indices;
+    storage.uv = uv;
 
     clock_t end_time = clock();
 
-    auto geometry = openmesh_to_operand(iter_mesh.get());
+    Geometry geometry = Geometry::CreateMesh();
+    auto output = geometry.get_component<MeshComponent>();
+    output->set_vertices(uv);
+    output->set_face_vertex_counts(mesh->get_face_vertex_counts());
+    output->set_face_vertex_indices(mesh->get_face_vertex_indices());
 
     // Set the output of the nodes
-    params.set_output("Output", std::move(*geometry));
+    params.set_output("Output", std::move(geometry));
     params.set_output("Runtime", float(end_time - start_time));
     return true;
-
-    /* ------------- [HW5_TODO] ARAP Parameterization Implementation -----------
-    ** Implement ARAP mesh parameterization to minimize local distortion.
-    **
-    ** Steps:
-    ** 1. Initial Setup: Use a HW4 parameterization result as initial setup.
-    **
-    ** 2. Local Phase: For each triangle, compute local orthogonal approximation
-    **    (Lt) by computing SVD of Jacobian(Jt) with fixed u.
-    **
-    ** 3. Global Phase: With Lt fixed, update parameter coordinates(u) by
-    *solving
-    **    a pre-factored global sparse linear system.
-    **
-    ** 4. Iteration: Repeat Steps 2 and 3 to refine parameterization.
-    **
-    ** Note:
-    **  - Fixed points' selection is crucial for ARAP and ASAP.
-    **  - Encapsulate algorithms into classes for modularity.
-    */
-
-    // The result UV coordinates
-    pxr::VtArray<pxr::GfVec2f> uv_result;
-
-    // Set the output of the node
-    params.set_output("OutputUV", uv_result);
 }
 
 NODE_DECLARATION_UI(arap);
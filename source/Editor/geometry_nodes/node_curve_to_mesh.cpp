@@ -1,8 +1,117 @@
-﻿#include "GCore/Components/CurveComponent.h"
+﻿#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "GCore/Components/CurveComponent.h"
 #include "GCore/Components/MeshOperand.h"
 #include "geom_node_base.h"
-#include "pxr/base/gf/matrix3f.h"
-#include "pxr/base/gf/rotation.h"
+
+using pxr::GfVec3f;
+
+// Orthonormal frame at a guide vertex. The profile's x, y and z axes are
+// mapped to normal, bitangent and tangent.
+struct SweepFrame {
+    GfVec3f normal;
+    GfVec3f bitangent;
+    GfVec3f tangent;
+};
+
+static GfVec3f any_perpendicular(const GfVec3f& v)
+{
+    GfVec3f axis = std::abs(v[0]) < 0.9f ? GfVec3f(1, 0, 0) : GfVec3f(0, 1, 0);
+    return pxr::GfCross(v, axis).GetNormalized();
+}
+
+static GfVec3f rotate_around(
+    const GfVec3f& v,
+    const GfVec3f& axis,
+    float angle)
+{
+    float c = std::cos(angle), s = std::sin(angle);
+    return v * c + pxr::GfCross(axis, v) * s +
+           axis * (pxr::GfDot(axis, v) * (1 - c));
+}
+
+// Rotation minimizing frames of one curve by the double reflection method
+// (Wang et al. 2008). On periodic curves the twist left when coming back to
+// the first vertex is spread evenly along the curve so the sweep closes.
+static void compute_rotation_minimizing_frames(
+    const GfVec3f* points,
+    size_t count,
+    bool periodic,
+    const GfVec3f* initial_normal,
+    SweepFrame* frames)
+{
+    auto point = [&](ptrdiff_t i) {
+        if (periodic) {
+            return points[(i + count) % count];
+        }
+        return points[std::clamp<ptrdiff_t>(i, 0, count - 1)];
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        auto next = (point(i + 1) - point(i)).GetNormalized();
+        auto prev = (point(i) - point(i - 1)).GetNormalized();
+        auto tangent = (next + prev).GetNormalized();
+        if (tangent == GfVec3f(0)) {
+            tangent = next == GfVec3f(0) ? GfVec3f(0, 0, 1) : next;
+        }
+        frames[i].tangent = tangent;
+    }
+
+    auto orthonormal_normal = [](const GfVec3f& normal,
+                                 const GfVec3f& tangent) {
+        auto projected = normal - tangent * pxr::GfDot(normal, tangent);
+        return projected.GetLength() < 1e-6f ? any_perpendicular(tangent)
+                                             : projected.GetNormalized();
+    };
+
+    auto transport = [&](const SweepFrame& from,
+                         const GfVec3f& from_point,
+                         const GfVec3f& to_point,
+                         const GfVec3f& to_tangent) {
+        auto v1 = to_point - from_point;
+        float c1 = pxr::GfDot(v1, v1);
+        if (c1 < 1e-12f) {
+            return orthonormal_normal(from.normal, to_tangent);
+        }
+        auto r = from.normal - v1 * (2 / c1 * pxr::GfDot(v1, from.normal));
+        auto t = from.tangent - v1 * (2 / c1 * pxr::GfDot(v1, from.tangent));
+        auto v2 = to_tangent - t;
+        float c2 = pxr::GfDot(v2, v2);
+        if (c2 > 1e-12f) {
+            r = r - v2 * (2 / c2 * pxr::GfDot(v2, r));
+        }
+        return orthonormal_normal(r, to_tangent);
+    };
+
+    frames[0].normal = orthonormal_normal(
+        initial_normal ? *initial_normal : any_perpendicular(frames[0].tangent),
+        frames[0].tangent);
+    for (size_t i = 1; i < count; ++i) {
+        frames[i].normal = transport(
+            frames[i - 1], points[i - 1], points[i], frames[i].tangent);
+    }
+
+    if (periodic && count > 2) {
+        auto closing = transport(
+            frames[count - 1], points[count - 1], points[0], frames[0].tangent);
+        float angle = std::atan2(
+            pxr::GfDot(
+                pxr::GfCross(closing, frames[0].normal), frames[0].tangent),
+            pxr::GfDot(closing, frames[0].normal));
+        for (size_t i = 1; i < count; ++i) {
+            frames[i].normal = rotate_around(
+                frames[i].normal, frames[i].tangent, angle * i / count);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        frames[i].bitangent =
+            pxr::GfCross(frames[i].tangent, frames[i].normal);
+    }
+}
 
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(curve_to_mesh)
@@ -13,8 +122,14 @@ NODE_DECLARATION_FUNCTION(curve_to_mesh)
     b.add_output<Geometry>("Mesh");
 }
 
+// Sweeps the first profile curve along every curve of the guide component.
+// All output sizes are known from the curve vertex counts, so the arrays are
+// allocated once and filled in parallel: frames per guide curve, profile
+// instances per guide vertex and faces per guide segment.
 NODE_EXECUTION_FUNCTION(curve_to_mesh)
 {
+    using namespace pxr;
+
     Geometry mesh_geom = Geometry::CreateMesh();
 
     auto curve_input = params.get_input<Geometry>("Curve");
@@ -22,95 +137,144 @@ NODE_EXECUTION_FUNCTION(curve_to_mesh)
 
     auto curve = curve_input.get_component<CurveComponent>();
     auto profile_curve = profile_curve_input.get_component<CurveComponent>();
+    if (!curve || !profile_curve) {
+        throw std::runtime_error("Curve to mesh requires two curves.");
+    }
 
-    // Suppose both curve are linear
-    using namespace pxr;
+    auto is_periodic = [](const CurveComponent& component) {
+        TfToken wrap;
+        component.get_usd_curve().GetWrapAttr().Get(&wrap);
+        return wrap == UsdGeomTokens->periodic;
+    };
 
-    // Calculate the transformation
+    auto guide_verts = curve->get_vertices();
+    auto guide_counts = curve->get_vert_count();
+    if (guide_counts.empty()) {
+        guide_counts.push_back(int(guide_verts.size()));
+    }
+    bool guide_periodic = is_periodic(*curve);
 
-    // The curve must have a normal.
-    pxr::VtArray<GfVec3f> curve_normals;
+    // Optional normals seed the frame at the start of each curve.
+    VtArray<GfVec3f> curve_normals;
     curve->get_usd_curve().GetNormalsAttr().Get(&curve_normals);
-    // Only rotation is needed here.
-
-    auto guide_curve_verts = curve->get_vertices();
-    auto profile_curve_verts = profile_curve->get_vertices();
-
-    VtValue periodic;
-    curve->get_usd_curve().GetWrapAttr().Get(&periodic);
-    bool guide_curve_periodic = periodic == UsdGeomTokens->periodic;
-
-    auto vert_count = guide_curve_verts.size();
-
-    auto mesh = mesh_geom.get_component<MeshComponent>();
-
-    VtArray<pxr::GfVec2f> texcoords_array;
-    VtArray<int> face_vertex_counts;
-    VtArray<pxr::GfVec3f> verticies;
-    VtArray<int> face_vertex_indices;
-
-    for (int i = 0; i < guide_curve_verts.size(); ++i) {
-        GfVec3f normal = curve_normals[i].GetNormalized();
-        GfVec3f tangent;
-
-        int this_vert_id = i;
-        int next_vert_id = (i + 1) % vert_count;
-        int prev_vert_id = (i - 1) % vert_count;
-
-        bool first_of_periodic = guide_curve_periodic && i == 0;
+    bool has_normals = curve_normals.size() == guide_verts.size();
 
-        bool last_of_periodic =
-            guide_curve_periodic && i == guide_curve_verts.size() - 1;
+    auto profile_verts = profile_curve->get_vertices();
+    auto profile_counts = profile_curve->get_vert_count();
+    size_t profile_count =
+        profile_counts.empty() ? profile_verts.size() : profile_counts[0];
+    bool profile_periodic = is_periodic(*profile_curve) && profile_count > 2;
+    size_t profile_segments = profile_periodic ? profile_count
+                              : profile_count ? profile_count - 1
+                                              : 0;
 
-        bool first_of_nonperiodic = !guide_curve_periodic && i == 0;
-
-        bool last_of_nonperiodic =
-            !guide_curve_periodic && i == guide_curve_verts.size() - 1;
-
-        if (first_of_nonperiodic) {
-            tangent = guide_curve_verts[1] - guide_curve_verts[0];
-        }
-        else if (last_of_nonperiodic) {
-            tangent = guide_curve_verts[guide_curve_verts.size() - 1] -
-                      guide_curve_verts[guide_curve_verts.size() - 2];
-        }
-        else {
-            auto vec1 = guide_curve_verts[next_vert_id] -
-                        guide_curve_verts[this_vert_id];
-            auto vec2 = guide_curve_verts[this_vert_id] -
-                        guide_curve_verts[prev_vert_id];
-
-            auto l1 = vec1.Normalize();
-            auto l2 = vec2.Normalize();
-            auto weight_1 = l2 / (l1 + l2);
+    // Per curve offsets of the guide vertices and segments.
+    size_t curve_count = guide_counts.size();
+    std::vector<size_t> vert_offsets(curve_count + 1, 0);
+    std::vector<size_t> segment_offsets(curve_count + 1, 0);
+    for (size_t c = 0; c < curve_count; ++c) {
+        size_t count = guide_counts[c];
+        size_t segments = count < 2                     ? 0
+                          : guide_periodic && count > 2 ? count
+                                                        : count - 1;
+        vert_offsets[c + 1] = vert_offsets[c] + count;
+        segment_offsets[c + 1] = segment_offsets[c] + segments;
+    }
+    if (vert_offsets.back() != guide_verts.size()) {
+        throw std::runtime_error("Curve vertex counts do not match points.");
+    }
 
-            tangent = weight_1 * vec2 + (1 - weight_1) * vec1;
+    std::vector<SweepFrame> frames(guide_verts.size());
+    WorkParallelForN(curve_count, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            auto first = vert_offsets[c];
+            auto count = vert_offsets[c + 1] - first;
+            if (!count) {
+                continue;
+            }
+            compute_rotation_minimizing_frames(
+                guide_verts.cdata() + first,
+                count,
+                guide_periodic && count > 2,
+                has_normals ? curve_normals.cdata() + first : nullptr,
+                frames.data() + first);
         }
-        tangent.Normalize();
-        auto bitangent = GfCross(normal, tangent);
+    });
 
-        GfMatrix3f tbn;
+    // Vertex v * profile_count + j is profile vertex j at guide vertex v.
+    VtArray<GfVec3f> vertices(guide_verts.size() * profile_count);
+    auto vertex_data = vertices.data();
+    WorkParallelForN(
+        guide_verts.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                auto& frame = frames[v];
+                auto origin = guide_verts[v];
+                for (size_t j = 0; j < profile_count; ++j) {
+                    auto& p = profile_verts[j];
+                    vertex_data[v * profile_count + j] =
+                        origin + frame.normal * p[0] +
+                        frame.bitangent * p[1] + frame.tangent * p[2];
+                }
+            }
+        },
+        1024);
 
-        tbn.SetColumn(2, tangent);
-        tbn.SetColumn(1, bitangent);
-        tbn.SetColumn(0, normal);
+    size_t face_count = segment_offsets.back() * profile_segments;
+    VtArray<int> face_vertex_counts(face_count, 4);
+    VtArray<int> face_vertex_indices(face_count * 4);
+    VtArray<GfVec2f> texcoords_array(face_count * 4);
+    auto index_data = face_vertex_indices.data();
+    auto texcoord_data = texcoords_array.data();
 
-        for (int j = 0; j < profile_curve_verts.size(); ++j) {
-            auto new_pos = tbn * profile_curve_verts[j] + guide_curve_verts[i];
-        }
+    WorkParallelForN(
+        segment_offsets.back(),
+        [&](size_t begin, size_t end) {
+            // The curve holding the first segment of this range.
+            size_t c = std::upper_bound(
+                           segment_offsets.begin(),
+                           segment_offsets.end(),
+                           begin) -
+                       segment_offsets.begin() - 1;
+            for (size_t s = begin; s < end; ++s) {
+                while (s >= segment_offsets[c + 1]) {
+                    ++c;
+                }
+                size_t count = vert_offsets[c + 1] - vert_offsets[c];
+                size_t segments = segment_offsets[c + 1] - segment_offsets[c];
+                size_t i = s - segment_offsets[c];
+                size_t ring = (vert_offsets[c] + i) * profile_count;
+                size_t next_ring =
+                    (vert_offsets[c] + (i + 1) % count) * profile_count;
+                float v0 = float(i) / segments;
+                float v1 = float(i + 1) / segments;
 
-        if (!last_of_nonperiodic) {
-            face_vertex_counts.push_back(4);
-        }
-    }
+                for (size_t j = 0; j < profile_segments; ++j) {
+                    size_t j1 = (j + 1) % profile_count;
+                    float u0 = float(j) / profile_segments;
+                    float u1 = float(j + 1) / profile_segments;
 
-    mesh->set_vertices(verticies);
+                    size_t corner = (s * profile_segments + j) * 4;
+                    index_data[corner + 0] = int(ring + j);
+                    index_data[corner + 1] = int(ring + j1);
+                    index_data[corner + 2] = int(next_ring + j1);
+                    index_data[corner + 3] = int(next_ring + j);
+                    texcoord_data[corner + 0] = GfVec2f(u0, v0);
+                    texcoord_data[corner + 1] = GfVec2f(u1, v0);
+                    texcoord_data[corner + 2] = GfVec2f(u1, v1);
+                    texcoord_data[corner + 3] = GfVec2f(u0, v1);
+                }
+            }
+        },
+        256);
 
+    auto mesh = mesh_geom.get_component<MeshComponent>();
+    mesh->set_vertices(vertices);
     mesh->set_face_vertex_counts(face_vertex_counts);
-
     mesh->set_face_vertex_indices(face_vertex_indices);
-
     mesh->set_texcoords_array(texcoords_array);
+
+    params.set_output("Mesh", std::move(mesh_geom));
     return true;
 }
 
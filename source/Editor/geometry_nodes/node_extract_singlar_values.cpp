@@ -1,9 +1,7 @@
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
+#include "GCore/util_ddg.h"
 #include "geom_node_base.h"
-#include <cmath>
 #include <Eigen/Dense>
-#include <Eigen/Sparse>
 
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(extract_singular_values)
@@ -28,97 +26,37 @@ NODE_EXECUTION_FUNCTION(extract_singular_values)
         throw std::runtime_error("Singular Values Extraction: Need Geometry Input.");
     }
 
-    // Initialization
-    auto halfedge_mesh = operand_to_openmesh(&input);
-    auto iter_mesh = operand_to_openmesh(&iters);
-    int n_faces = halfedge_mesh->n_faces();
-    int n_vertices = halfedge_mesh->n_vertices();
-
-
-    // Construct a set of new triangles
-    std::vector<std::vector<Eigen::Vector2d>> edges(n_faces);
-    Eigen::SparseMatrix<double> cotangents(n_vertices, n_vertices);
-
-    for (auto const& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        std::vector<int> vertex_idx(3);
-        std::vector<double> edge_length(3);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices())
-            vertex_idx[i++] = vertex_handle.idx();
-
-        for (int i = 0; i < 3; i++)
-            edge_length[i] =
-                (halfedge_mesh->point(
-                     halfedge_mesh->vertex_handle(vertex_idx[(i + 1) % 3])) -
-                 halfedge_mesh->point(
-                     halfedge_mesh->vertex_handle(vertex_idx[(i + 2) % 3])))
-                    .length();
-
-        // Calculate the area of the face
-        double tmp = (edge_length[0] + edge_length[1] + edge_length[2]) / 2;
-
-        // Record the edges of the face
-        // Their indexes are related to the point indexes opposite to them
-        edges[face_idx].resize(3);
-        double cos_angle =
-            (edge_length[1] * edge_length[1] + edge_length[2] * edge_length[2] -
-             edge_length[0] * edge_length[0]) /
-            (2 * edge_length[1] * edge_length[2]);
-        double sin_angle = sqrt(1 - cos_angle * cos_angle);
-        edges[face_idx][1] << -edge_length[1] * cos_angle,
-            -edge_length[1] * sin_angle;
-        edges[face_idx][2] << edge_length[2], 0;
-        edges[face_idx][0] = -edges[face_idx][1] - edges[face_idx][2];
-
-        // Calculate the cotangent values of the angles in this face
-        // Their indexes are related to the edge indexes opposite to them,
-        // orderly
-        for (int i = 0; i < 3; i++) {
-            double cos_value =
-                edges[face_idx][i].dot(edges[face_idx][(i + 1) % 3]) /
-                (edges[face_idx][i].norm() *
-                 edges[face_idx][(i + 1) % 3].norm());
-            double sin_value = sqrt(1 - cos_value * cos_value);
-            cotangents.coeffRef(vertex_idx[i], vertex_idx[(i + 1) % 3]) =
-                cos_value / sin_value;
-        }
+    auto mesh = input.get_component<MeshComponent>();
+    auto iter_mesh = iters.get_component<MeshComponent>();
+    TriangleMeshDDG ddg(
+        mesh->get_vertices(),
+        mesh->get_face_vertex_counts(),
+        mesh->get_face_vertex_indices());
+    auto uv = iter_mesh->get_vertices();
+    if (int(uv.size()) != ddg.vertex_count()) {
+        throw std::runtime_error(
+            "Singular Values Extraction: Parameterization does not match.");
     }
 
-    // A few changes is done here, for some more precomputation for each faces
-    Eigen::MatrixXd X(3, 2);
-    Eigen::MatrixXd Cotangents = Eigen::Matrix3d::Zero();
-    Eigen::MatrixXd U(2, 3);
-    Eigen::MatrixXd Jacobi(2, 2);
-    Eigen::MatrixXd sigmas(n_faces, 2);
-    double energy = 0;
-    for (const auto& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        std::vector<int> vertex_idx(3);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices())
-            vertex_idx[i++] = vertex_handle.idx();
-        for (int i = 0; i < 3; i++) {
-            X.row(i) = edges[face_idx][(i + 2) % 3];
-            Cotangents(i, i) =
-                cotangents.coeffRef(vertex_idx[i], vertex_idx[(i + 1) % 3]);
-            const auto& v0 = iter_mesh->point(iter_mesh->vertex_handle(vertex_idx[i]));
-            const auto& v1 = iter_mesh->point(iter_mesh->vertex_handle(vertex_idx[(i + 1) % 3]));
-            U(0, i) = (v1 - v0)[0];
-            U(1, i) = (v1 - v0)[1];
+    // Singular values of the Jacobian J of every face, J X = U with the edges
+    // from corner 0 of the isometric frame as X and of the uv face as U.
+    Eigen::MatrixXd sigmas(ddg.face_count(), 2);
+    pxr::WorkParallelForN(ddg.face_count(), [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            const int* v = ddg.face(int(f));
+            const auto& frame = ddg.frames()[f];
+            Eigen::Matrix2d X, U;
+            X << frame(1, 0), frame(2, 0), frame(1, 1), frame(2, 1);
+            for (int i = 1; i < 3; ++i) {
+                auto edge = uv[v[i]] - uv[v[0]];
+                U.col(i - 1) << edge[0], edge[1];
+            }
+            Eigen::Matrix2d jacobian = U * X.inverse();
+            sigmas.row(f) = Eigen::JacobiSVD<Eigen::Matrix2d>(jacobian)
+                                .singularValues()
+                                .transpose();
         }
-        Jacobi = U * Cotangents * X;
-
-        // Use SVD deformation to determine whether there is a flip, and set
-        // the sigular values of the Jacobian matrix 1
-        Eigen::JacobiSVD<Eigen::MatrixXd> svd(
-            Jacobi,
-            Eigen::DecompositionOptions::ComputeThinU |
-                Eigen::DecompositionOptions::ComputeThinV);
-
-        sigmas(face_idx, 0) = svd.singularValues()[0];
-        sigmas(face_idx, 1) = svd.singularValues()[1];
-    }
+    });
 
     params.set_output("Output", sigmas);
     return true;
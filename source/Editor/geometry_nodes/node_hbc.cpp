@@ -1,89 +1,177 @@
 #include <Eigen/Eigen>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include "nodes/core/def/node_def.hpp"
+#include "pxr/base/work/loops.h"
 #include <igl/triangle/triangulate.h>
 #include <igl/boundary_loop.h>
-#include <igl/barycentric_coordinates.h>
 #include <igl/harmonic.h>
 
+// Uniform grid over a 2D triangulation. Every cell lists the triangles whose
+// bounding box overlaps it, and cells are sized for about one triangle each,
+// so locating a point only tests a few candidates.
+class TriangleGrid {
+   public:
+    TriangleGrid(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F)
+        : corners_(F.rows()),
+          inverses_(F.rows())
+    {
+        Eigen::Vector2d min = V.colwise().minCoeff().transpose();
+        Eigen::Vector2d max = V.colwise().maxCoeff().transpose();
+        Eigen::Vector2d extent = (max - min).cwiseMax(1e-12);
+        double cell =
+            std::sqrt(extent.prod() / std::max<Eigen::Index>(F.rows(), 1));
+        origin_ = min;
+        inv_cell_ = 1 / cell;
+        nx_ = std::max(1, int(std::ceil(extent[0] * inv_cell_)));
+        ny_ = std::max(1, int(std::ceil(extent[1] * inv_cell_)));
+
+        // Barycentric coordinates of a point p are 1 - l1 - l2, l1 and l2 with
+        // (l1, l2) = inverse * (p - a), so the inverse is kept per triangle.
+        std::vector<Eigen::Vector4i> ranges(F.rows());
+        for (int f = 0; f < F.rows(); ++f) {
+            Eigen::Vector2d a = V.row(F(f, 0)).head<2>();
+            Eigen::Vector2d b = V.row(F(f, 1)).head<2>();
+            Eigen::Vector2d c = V.row(F(f, 2)).head<2>();
+            Eigen::Matrix2d edges;
+            edges << b - a, c - a;
+            corners_[f] = a;
+            inverses_[f] = edges.inverse();
+
+            Eigen::Vector2i lo = cell_of(a.cwiseMin(b).cwiseMin(c));
+            Eigen::Vector2i hi = cell_of(a.cwiseMax(b).cwiseMax(c));
+            ranges[f] << lo, hi;
+        }
+
+        offsets_.assign(nx_ * ny_ + 1, 0);
+        for (auto& r : ranges) {
+            for (int y = r[1]; y <= r[3]; ++y) {
+                for (int x = r[0]; x <= r[2]; ++x) {
+                    ++offsets_[y * nx_ + x + 1];
+                }
+            }
+        }
+        for (int i = 0; i < nx_ * ny_; ++i) {
+            offsets_[i + 1] += offsets_[i];
+        }
+        triangles_.resize(offsets_.back());
+        std::vector<int> next(offsets_.begin(), offsets_.end() - 1);
+        for (int f = 0; f < F.rows(); ++f) {
+            auto& r = ranges[f];
+            for (int y = r[1]; y <= r[3]; ++y) {
+                for (int x = r[0]; x <= r[2]; ++x) {
+                    triangles_[next[y * nx_ + x]++] = f;
+                }
+            }
+        }
+    }
+
+    // Returns the triangle containing p and the barycentric coordinates of p
+    // in it, or -1 when p is outside of the triangulation.
+    int locate(const Eigen::Vector2d& p, Eigen::Vector3d& bary) const
+    {
+        Eigen::Vector2i c = cell_of(p);
+        int cell = c[1] * nx_ + c[0];
+        for (int k = offsets_[cell]; k < offsets_[cell + 1]; ++k) {
+            int f = triangles_[k];
+            Eigen::Vector2d l = inverses_[f] * (p - corners_[f]);
+            bary << 1 - l[0] - l[1], l[0], l[1];
+            if ((bary.array() >= -1e-10).all()) {
+                return f;
+            }
+        }
+        return -1;
+    }
+
+   private:
+    Eigen::Vector2i cell_of(const Eigen::Vector2d& p) const
+    {
+        Eigen::Vector2d t = (p - origin_) * inv_cell_;
+        return Eigen::Vector2i(
+            std::clamp(int(std::floor(t[0])), 0, nx_ - 1),
+            std::clamp(int(std::floor(t[1])), 0, ny_ - 1));
+    }
+
+    Eigen::Vector2d origin_;
+    double inv_cell_;
+    int nx_, ny_;
+    std::vector<int> offsets_;
+    std::vector<int> triangles_;
+    std::vector<Eigen::Vector2d> corners_;
+    std::vector<Eigen::Matrix2d> inverses_;
+};
+
+// The cage is triangulated and the harmonic weights are solved for once, the
+// returned function only interpolates them at the queried points.
 std::function<Eigen::MatrixXd(const Eigen::MatrixXd&)> generate_weight_function(
     const Eigen::MatrixXd& C,
     const Eigen::MatrixXi& E)
 {
-    return [C, E](const Eigen::MatrixXd& V) -> Eigen::MatrixXd {
-        int k = C.rows();
-
-        // Define the list of holes (no holes in this example)
-        Eigen::MatrixXd H(0, 2);  // Empty matrix
-
-        // Variables to store the output
-        Eigen::MatrixXd V2;  // New vertices (after triangulation)
-        Eigen::MatrixXi F2;  // Triangles (faces)
-
-        // Set the flags to control the triangulation
-        std::string flags = "pq30a0.001";
-        // 'p': Constrained Delaunay triangulation
-        // 'q30': Enforce a minimum angle of 30 degrees for all triangles
-        // 'a0.1': Limit the maximum area of each triangle to 0.1
-
-        // Perform triangulation
-        igl::triangle::triangulate(C, E, H, flags, V2, F2);
-
-        Eigen::VectorXi b;
-        igl::boundary_loop(F2, b);
-
-        Eigen::MatrixXd bc = Eigen::MatrixXd::Zero(b.rows(), k);
-        // for (int i = 0; i < k; ++i) {
-        //     bc(i, i) = 1.0;
-        // }
-        // std::cout << "Boundary conditions:\n" << bc << std::endl;
-        std::vector<int> control_index(k);
-        for (int i = 0; i < b.size(); ++i) {
-            int control_idx = b[i];
-            if (control_idx >= 0 && control_idx < k) {
-                control_index[control_idx] = i;
-            }
+    int k = C.rows();
+
+    // Define the list of holes (no holes in this example)
+    Eigen::MatrixXd H(0, 2);  // Empty matrix
+
+    // Variables to store the output
+    Eigen::MatrixXd V2;  // New vertices (after triangulation)
+    Eigen::MatrixXi F2;  // Triangles (faces)
+
+    // Set the flags to control the triangulation
+    std::string flags = "pq30a0.001";
+    // 'p': Constrained Delaunay triangulation
+    // 'q30': Enforce a minimum angle of 30 degrees for all triangles
+    // 'a0.1': Limit the maximum area of each triangle to 0.1
+
+    // Perform triangulation
+    igl::triangle::triangulate(C, E, H, flags, V2, F2);
+
+    Eigen::VectorXi b;
+    igl::boundary_loop(F2, b);
+
+    Eigen::MatrixXd bc = Eigen::MatrixXd::Zero(b.rows(), k);
+    std::vector<int> control_index(k);
+    for (int i = 0; i < b.size(); ++i) {
+        int control_idx = b[i];
+        if (control_idx >= 0 && control_idx < k) {
+            control_index[control_idx] = i;
         }
-        for (int p = 0; p < k; ++p) {
-            int curr_pos = control_index[p];
-            int next_pos = control_index[(p + 1) % k];
-
-            for (int i = curr_pos; i != next_pos; i = (i + 1) % b.size()) {
-                double dist_curr = (V2.row(b[i]) - V2.row(b[next_pos])).norm();
-                double dist_next = (V2.row(b[i]) - V2.row(b[curr_pos])).norm();
-                double total_dist = dist_curr + dist_next;
-                bc(i, p) = dist_curr / total_dist;
-                bc(i, (p + 1) % k) = dist_next / total_dist;
-            }
+    }
+    for (int p = 0; p < k; ++p) {
+        int curr_pos = control_index[p];
+        int next_pos = control_index[(p + 1) % k];
+
+        for (int i = curr_pos; i != next_pos; i = (i + 1) % b.size()) {
+            double dist_curr = (V2.row(b[i]) - V2.row(b[next_pos])).norm();
+            double dist_next = (V2.row(b[i]) - V2.row(b[curr_pos])).norm();
+            double total_dist = dist_curr + dist_next;
+            bc(i, p) = dist_curr / total_dist;
+            bc(i, (p + 1) % k) = dist_next / total_dist;
         }
-        Eigen::MatrixXd W(V2.size(), k);
-        bool success = igl::harmonic(V2, F2, b, bc, 1, W);
+    }
+    Eigen::MatrixXd W;
+    igl::harmonic(V2, F2, b, bc, 1, W);
+
+    auto grid = std::make_shared<const TriangleGrid>(V2, F2);
 
+    return [k, F2 = std::move(F2), W = std::move(W), grid](
+               const Eigen::MatrixXd& V) -> Eigen::MatrixXd {
         Eigen::MatrixXd WW(V.rows(), k);
 
-        for (int i = 0; i < V.rows(); ++i) {
-            Eigen::MatrixXd L;
-            int index = -1;
-            for (int j = 0; j < F2.rows(); ++j) {
-                igl::barycentric_coordinates(
-                    V.row(i),
-                    V2.row(F2(j, 0)),
-                    V2.row(F2(j, 1)),
-                    V2.row(F2(j, 2)),
-                    L);
-                if ((L.array() >= -1e-10).all()) {
-                    index = j;
-                    break;
+        pxr::WorkParallelForN(V.rows(), [&](size_t begin, size_t end) {
+            Eigen::Vector3d L;
+            for (size_t i = begin; i < end; ++i) {
+                int index = grid->locate(V.row(i).head<2>().transpose(), L);
+                if (index != -1) {
+                    WW.row(i) = L[0] * W.row(F2(index, 0)) +
+                                L[1] * W.row(F2(index, 1)) +
+                                L[2] * W.row(F2(index, 2));
+                }
+                else {
+                    WW.row(i).setZero();
                 }
             }
-            if (index != -1) {
-                WW.row(i) = L(0, 0) * W.row(F2(index, 0)) +
-                            L(0, 1) * W.row(F2(index, 1)) +
-                            L(0, 2) * W.row(F2(index, 2));
-            }
-            else {
-                WW.row(i) = Eigen::RowVectorXd::Zero(k);
-            }
-        }
+        });
         return WW;
     };
 }
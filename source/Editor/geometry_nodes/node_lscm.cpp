@@ -1,4 +1,5 @@
 #include "GCore/Components/MeshOperand.h"
+#include "GCore/util_ddg.h"
 #include "GCore/util_openmesh_bind.h"
 #include "geom_node_base.h"
 #include <cmath>
@@ -32,39 +33,12 @@ NODE_EXECUTION_FUNCTION(lscm)
     int n_faces = halfedge_mesh->n_faces();
     int n_vertices = halfedge_mesh->n_vertices();
 
-    // Construct a set of new triangles
-    std::vector<double> area(n_faces);
-    std::vector<std::vector<Eigen::Vector2d>> edges(n_faces);
-
-    for (auto const& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        std::vector<int> vertex_idx(3);
-        std::vector<double> edge_length(3);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices())
-            vertex_idx[i++] = vertex_handle.idx();
-
-        for (int i = 0; i < 3; i++)
-            edge_length[i] = (halfedge_mesh->point(halfedge_mesh->vertex_handle(vertex_idx[(i + 1) % 3])) -
-                              halfedge_mesh->point(halfedge_mesh->vertex_handle(vertex_idx[(i + 2) % 3])))
-                              .length();
-
-        // Calculate the area of the face
-        double tmp = (edge_length[0] + edge_length[1] + edge_length[2]) / 2;
-        area[face_idx] = tmp;
-        for (int i = 0; i < 3; i++)
-            area[face_idx] *= tmp - edge_length[i];
-        area[face_idx] = sqrt(area[face_idx]);
-
-        // Record the edges of the face
-        // Their indexes are related to the point indexes opposite to them 
-        edges[face_idx].resize(3);
-        double cos_angle = (edge_length[1] * edge_length[1] + edge_length[2] * edge_length[2] - edge_length[0] * edge_length[0]) / (2 * edge_length[1] * edge_length[2]);
-        double sin_angle = sqrt(1 - cos_angle * cos_angle);
-        edges[face_idx][1] << -edge_length[1] * cos_angle, -edge_length[1] * sin_angle;
-        edges[face_idx][2] << edge_length[2], 0;
-        edges[face_idx][0] = -edges[face_idx][1] - edges[face_idx][2];
-    }
+    auto mesh = input.get_component<MeshComponent>();
+    TriangleMeshDDG ddg(
+        mesh->get_vertices(),
+        mesh->get_face_vertex_counts(),
+        mesh->get_face_vertex_indices());
+    const auto& area = ddg.areas();
 
     // Two ensured points
     int fixed = 2;
@@ -106,44 +80,52 @@ NODE_EXECUTION_FUNCTION(lscm)
             ori2mat[idx] = count++;
     }
 
-    // Construct the matrix and vector of the function
-    Eigen::SparseMatrix<double> A(2 * n_faces, 2 * (n_vertices - fixed));
-    Eigen::SparseMatrix<double> B(2 * n_faces, 2 * fixed);
-    Eigen::VectorXd b(2 * n_faces);
-    for (const auto& face_handle : halfedge_mesh->faces()) {
-        int face_idx = face_handle.idx();
-        double coeff = sqrt(2 * area[face_idx]);
-        int i = 0;
-        for (const auto& vertex_handle : face_handle.vertices()) {
-            int vertex_idx = vertex_handle.idx();
-            int mat_idx = ori2mat[vertex_idx];
-            double dx = edges[face_idx][i][0] / coeff;
-            double dy = edges[face_idx][i][1] / coeff;
-            if (mat_idx == -1) {
-                // Fixed points
-                if (vertex_idx == idx1) {
-                    B.coeffRef(face_idx, 0) = dx;
-                    B.coeffRef(face_idx + n_faces, 0) = dy;
-                    B.coeffRef(face_idx, 2) = -dy;
-                    B.coeffRef(face_idx + n_faces, 2) = dx;
+    // Construct the matrix and vector of the function. Every face fills its
+    // own 4 triplets per corner, the free and the fixed ones apart.
+    std::vector<Eigen::Triplet<double>> A_triplets(n_faces * 12);
+    std::vector<Eigen::Triplet<double>> B_triplets(n_faces * 12);
+    pxr::WorkParallelForN(n_faces, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            int face_idx = int(f);
+            const int* v = ddg.face(face_idx);
+            const auto& frame = ddg.frames()[f];
+            double coeff = sqrt(2 * area[face_idx]);
+            for (int i = 0; i < 3; i++) {
+                int vertex_idx = v[i];
+                int mat_idx = ori2mat[vertex_idx];
+                // The edge opposite to the corner
+                Eigen::Vector2d edge =
+                    frame.row((i + 2) % 3) - frame.row((i + 1) % 3);
+                double dx = edge[0] / coeff;
+                double dy = edge[1] / coeff;
+                auto* a = A_triplets.data() + f * 12 + i * 4;
+                auto* b = B_triplets.data() + f * 12 + i * 4;
+                if (mat_idx == -1) {
+                    // Fixed points
+                    int col = vertex_idx == idx1 ? 0 : 1;
+                    b[0] = { face_idx, col, dx };
+                    b[1] = { face_idx + n_faces, col, dy };
+                    b[2] = { face_idx, col + 2, -dy };
+                    b[3] = { face_idx + n_faces, col + 2, dx };
+                    std::fill(a, a + 4, Eigen::Triplet<double>(0, 0, 0));
                 }
-                else if (vertex_idx == idx2) {
-                    B.coeffRef(face_idx, 1) = dx;
-                    B.coeffRef(face_idx + n_faces, 1) = dy;
-                    B.coeffRef(face_idx, 3) = -dy;
-                    B.coeffRef(face_idx + n_faces, 3) = dx;
+                else {
+                    // Free points
+                    int mat_idy = mat_idx + n_vertices - fixed;
+                    a[0] = { face_idx, mat_idx, dx };
+                    a[1] = { face_idx + n_faces, mat_idx, dy };
+                    a[2] = { face_idx, mat_idy, -dy };
+                    a[3] = { face_idx + n_faces, mat_idy, dx };
+                    std::fill(b, b + 4, Eigen::Triplet<double>(0, 0, 0));
                 }
             }
-            else {
-                // Free points
-                A.coeffRef(face_idx, mat_idx) = dx;
-                A.coeffRef(face_idx + n_faces, mat_idx) = dy;
-                A.coeffRef(face_idx, mat_idx + n_vertices - fixed) = -dy;
-                A.coeffRef(face_idx + n_faces, mat_idx + n_vertices - fixed) = dx;
-            }
-            i++;
         }
-    }
+    });
+    Eigen::SparseMatrix<double> A(2 * n_faces, 2 * (n_vertices - fixed));
+    Eigen::SparseMatrix<double> B(2 * n_faces, 2 * fixed);
+    A.setFromTriplets(A_triplets.begin(), A_triplets.end());
+    B.setFromTriplets(B_triplets.begin(), B_triplets.end());
+    Eigen::VectorXd b(2 * n_faces);
 
     // Solve the least square problem
     Eigen::LeastSquaresConjugateGradient<Eigen::SparseMatrix<double>> solver;
@@ -171,5 +153,6 @@ NODE_EXECUTION_FUNCTION(lscm)
     return true;
 }
 
+NODE_DECLARATION_PURE(lscm);
 NODE_DECLARATION_UI(lscm);
 NODE_DEF_CLOSE_SCOPE
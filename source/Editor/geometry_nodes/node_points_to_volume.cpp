@@ -0,0 +1,46 @@
+#include "GCore/Components/PointsComponent.h"
+#include "GCore/Components/VolumeComponent.h"
+#include "GCore/util_openvdb.h"
+#include "geom_node_base.h"
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(points_to_volume)
+{
+    b.add_input<Geometry>("Points");
+    b.add_input<float>("Voxel Size").min(0.1).max(5).default_val(0.5f);
+    b.add_output<Geometry>("Volume");
+}
+
+// Rasterizes the points as spheres into a level set grid named "surface".
+NODE_EXECUTION_FUNCTION(points_to_volume)
+{
+    auto points_geometry = params.get_input<Geometry>("Points");
+
+    auto points = points_geometry.get_component<PointsComponent>();
+
+    if (!points || points->get_vertices().empty()) {
+        throw std::runtime_error("Input does not contain points");
+    }
+
+    pxr::VtArray<pxr::GfVec3f> points_vertices = points->get_vertices();
+    pxr::VtArray<float> points_widths = points->get_width();
+    if (points_widths.empty()) {
+        points_widths.resize(points_vertices.size(), 0.1f);
+    }
+
+    float voxelSize = params.get_input<float>("Voxel Size");
+    voxelSize = std::clamp(voxelSize, .001f, std::numeric_limits<float>::max());
+
+    auto volume_geometry = Geometry();
+    auto volume_component = std::make_shared<VolumeComponent>(&volume_geometry);
+    volume_geometry.attach_component(volume_component);
+    volume_component->add_grid(
+        spheres_to_level_set(points_vertices, points_widths, voxelSize));
+
+    params.set_output("Volume", std::move(volume_geometry));
+
+    return true;
+}
+
+NODE_DECLARATION_UI(points_to_volume);
+NODE_DEF_CLOSE_SCOPE
@@ -19,6 +19,7 @@
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/Components/SkelComponent.h"
 #include "GCore/Components/XformComponent.h"
+#include "GCore/usd_stage_cache.h"
 #include "geom_node_base.h"
 #include "pxr/usd/usdSkel/animation.h"
 #include "pxr/usd/usdSkel/bindingAPI.h"
@@ -26,6 +27,42 @@
 
 NODE_DEF_OPEN_SCOPE
 
+// Kept by read_usd, so the mesh prim is only copied from the file when the
+// stage, the prim or its topology changed. Otherwise the geometry of the last
+// copy is duplicated from memory.
+struct ReadUsdStorage {
+    static constexpr bool has_storage = false;
+
+    pxr::UsdStagePtr stage;
+    pxr::SdfPath path;
+    pxr::VtArray<int> face_vertex_counts;
+    pxr::VtArray<int> face_vertex_indices;
+    Geometry geometry;
+
+    void update(const pxr::UsdGeomMesh& usdgeom)
+    {
+        pxr::VtArray<int> counts, indices;
+        usdgeom.GetFaceVertexCountsAttr().Get(&counts);
+        usdgeom.GetFaceVertexIndicesAttr().Get(&indices);
+        if (geometry.get_component<MeshComponent>() &&
+            stage == usdgeom.GetPrim().GetStage() &&
+            path == usdgeom.GetPath() && face_vertex_counts == counts &&
+            face_vertex_indices == indices) {
+            return;
+        }
+
+        geometry = Geometry();
+        auto mesh = std::make_shared<MeshComponent>(&geometry);
+        geometry.attach_component(mesh);
+        mesh->set_mesh_geom(usdgeom);
+
+        stage = usdgeom.GetPrim().GetStage();
+        path = usdgeom.GetPath();
+        face_vertex_counts = counts;
+        face_vertex_indices = indices;
+    }
+};
+
 NODE_DECLARATION_FUNCTION(read_usd)
 {
     b.add_input<std::string>("File Name").default_val("Default");
@@ -40,9 +77,7 @@ NODE_EXECUTION_FUNCTION(read_usd)
     auto prim_path = params.get_input<std::string>("Prim Path");
 
     Geometry geometry;
-    std::shared_ptr<MeshComponent> mesh =
-        std::make_shared<MeshComponent>(&geometry);
-    geometry.attach_component(mesh);
+    std::shared_ptr<MeshComponent> mesh;
 
     auto t = params.get_input<float>("Time Code");
     pxr::UsdTimeCode time = pxr::UsdTimeCode(t);
@@ -50,15 +85,21 @@ NODE_EXECUTION_FUNCTION(read_usd)
         time = pxr::UsdTimeCode::Default();
     }
 
-    auto stage = pxr::UsdStage::Open(file_name.c_str());
+    // Stages are shared and kept open across executions, so playing back a
+    // file does not recompose it every frame.
+    auto cached = UsdFileStageCache::instance().open(file_name);
+    auto stage = cached.stage;
 
     if (stage) {
         // Here 'c_str' call is necessary since prim_path
         auto sdf_path = pxr::SdfPath(prim_path.c_str());
         pxr::UsdGeomMesh usdgeom = pxr::UsdGeomMesh::Get(stage, sdf_path);
-        
+
         if (usdgeom) {
-            mesh->set_mesh_geom(usdgeom);
+            auto& storage = params.get_storage<ReadUsdStorage&>();
+            storage.update(usdgeom);
+            geometry = storage.geometry;
+            mesh = geometry.get_component<MeshComponent>();
 
             pxr::GfMatrix4d final_transform =
                 usdgeom.ComputeLocalToWorldTransform(time);
@@ -81,43 +122,54 @@ NODE_EXECUTION_FUNCTION(read_usd)
             UsdSkelBindingAPI binding = UsdSkelBindingAPI(usdgeom);
             SdfPathVector targets;
             binding.GetSkeletonRel().GetTargets(&targets);
+
+            UsdSkelSkeleton skeleton;
+            UsdSkelSkeletonQuery skelQuery;
             if (targets.size() == 1) {
-                auto prim = stage->GetPrimAtPath(targets[0]);
+                skeleton = UsdSkelSkeleton(stage->GetPrimAtPath(targets[0]));
+                if (!skeleton) {
+                    log::warning("Unable to read the skeleton.");
+                    return false;
+                }
+                skelQuery = cached.skel_cache->GetSkelQuery(skeleton);
+            }
+
+            // Points and joint transforms of the upcoming samples are read
+            // ahead in the background.
+            auto animation = UsdFileStageCache::instance().open_animation(
+                file_name, usdgeom, skelQuery);
+            auto frame = animation->fetch(time);
 
-                pxr::UsdSkelSkeleton skeleton(prim);
-                if (skeleton) {
-                    using namespace pxr;
-                    UsdSkelCache skelCache;
-                    UsdSkelSkeletonQuery skelQuery =
-                        skelCache.GetSkelQuery(skeleton);
+            if (!time.IsDefault() && !frame.points.empty()) {
+                mesh->set_vertices(frame.points);
+            }
 
-                    auto skel_component =
-                        std::make_shared<SkelComponent>(&geometry);
-                    geometry.attach_component(skel_component);
+            if (skeleton) {
+                auto skel_component =
+                    std::make_shared<SkelComponent>(&geometry);
+                geometry.attach_component(skel_component);
 
-                    VtArray<GfMatrix4f> xforms;
-                    skelQuery.ComputeJointLocalTransforms(&xforms, time);
+                skel_component->localTransforms =
+                    std::move(frame.joint_local_transforms);
+                skel_component->jointOrder = skelQuery.GetJointOrder();
+                skel_component->topology = skelQuery.GetTopology();
 
-                    skel_component->localTransforms = xforms;
-                    skel_component->jointOrder = skelQuery.GetJointOrder();
-                    skel_component->topology = skelQuery.GetTopology();
+                VtArray<float> jointWeight;
+                binding.GetJointWeightsAttr().Get(&jointWeight, time);
 
-                    VtArray<float> jointWeight;
-                    binding.GetJointWeightsAttr().Get(&jointWeight, time);
+                VtArray<GfMatrix4d> bindTransforms;
+                skeleton.GetBindTransformsAttr().Get(&bindTransforms, time);
+                skel_component->bindTransforms = bindTransforms;
 
-                    VtArray<GfMatrix4d> bindTransforms;
-                    skeleton.GetBindTransformsAttr().Get(&bindTransforms, time);
-                    skel_component->bindTransforms = bindTransforms;
+                VtArray<int> jointIndices;
+                binding.GetJointIndicesAttr().Get(&jointIndices, time);
+                skel_component->jointWeight = jointWeight;
+                skel_component->jointIndices = jointIndices;
 
-                    VtArray<int> jointIndices;
-                    binding.GetJointIndicesAttr().Get(&jointIndices, time);
-                    skel_component->jointWeight = jointWeight;
-                    skel_component->jointIndices = jointIndices;
-                }
-                else {
-                    log::warning("Unable to read the skeleton.");
-                    return false;
-                }
+                auto influences = binding.GetJointIndicesPrimvar();
+                skel_component->jointInterpolation =
+                    influences.GetInterpolation();
+                skel_component->jointElementSize = influences.GetElementSize();
             }
         }
 
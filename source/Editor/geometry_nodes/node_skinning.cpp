@@ -0,0 +1,340 @@
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/usdSkel/utils.h>
+
+#include <cmath>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/Components/SkelComponent.h"
+#include "GCore/util_skinning.h"
+#include "geom_node_base.h"
+
+// A joint transform as the rows of its linear part followed by the
+// translation. Points are row vectors as in Gf, so they transform as
+// p * linear + translation. Blending works on all twelve floats at once.
+struct SkinningMatrix {
+    float m[12];
+};
+
+// A rigid joint transform as a unit dual quaternion, both parts in
+// (w, x, y, z) order.
+struct SkinningDualQuaternion {
+    float real[4];
+    float dual[4];
+};
+
+// The influence layout only depends on the joint indices and weights and how
+// they are bound, so it is kept in the node storage and rebuilt when they
+// change. Holding the arrays keeps their buffers alive, so comparing the data
+// pointers is enough to detect a change.
+struct SkinningStorage {
+    static constexpr bool has_storage = false;
+
+    pxr::VtArray<int> joint_indices;
+    pxr::VtArray<float> joint_weights;
+    pxr::TfToken joint_interpolation;
+    int joint_element_size = 0;
+    size_t point_count = 0;
+    size_t joint_count = 0;
+
+    SkinningInfluences influences;
+};
+
+static bool influence_layout_valid(
+    const SkinningStorage& storage,
+    const SkelComponent& skel,
+    size_t point_count,
+    size_t joint_count)
+{
+    return storage.joint_indices.cdata() == skel.jointIndices.cdata() &&
+           storage.joint_indices.size() == skel.jointIndices.size() &&
+           storage.joint_weights.cdata() == skel.jointWeight.cdata() &&
+           storage.joint_weights.size() == skel.jointWeight.size() &&
+           storage.joint_interpolation == skel.jointInterpolation &&
+           storage.joint_element_size == skel.jointElementSize &&
+           storage.point_count == point_count &&
+           storage.joint_count == joint_count;
+}
+
+static void build_influence_layout(
+    SkinningStorage& storage,
+    const SkelComponent& skel,
+    size_t point_count,
+    size_t joint_count)
+{
+    storage.influences =
+        build_skinning_influences(skel, point_count, joint_count);
+    storage.joint_indices = skel.jointIndices;
+    storage.joint_weights = skel.jointWeight;
+    storage.joint_interpolation = skel.jointInterpolation;
+    storage.joint_element_size = skel.jointElementSize;
+    storage.point_count = point_count;
+    storage.joint_count = joint_count;
+}
+
+static SkinningMatrix to_skinning_matrix(const pxr::GfMatrix4f& matrix)
+{
+    SkinningMatrix result;
+    for (int row = 0; row < 4; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            result.m[row * 3 + column] = matrix[row][column];
+        }
+    }
+    return result;
+}
+
+static void quaternion_multiply(const float* a, const float* b, float* out)
+{
+    out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+// Scale and shear are dropped, dual quaternions only blend rigid transforms.
+static SkinningDualQuaternion to_dual_quaternion(const SkinningMatrix& matrix)
+{
+    // Rotation matrix in column vector convention, the transpose of ours.
+    auto r = [&](int i, int j) { return matrix.m[j * 3 + i]; };
+
+    float q[4];
+    float trace = r(0, 0) + r(1, 1) + r(2, 2);
+    if (trace > 0) {
+        float s = 2 * std::sqrt(trace + 1);
+        q[0] = s / 4;
+        q[1] = (r(2, 1) - r(1, 2)) / s;
+        q[2] = (r(0, 2) - r(2, 0)) / s;
+        q[3] = (r(1, 0) - r(0, 1)) / s;
+    }
+    else if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2)) {
+        float s = 2 * std::sqrt(1 + r(0, 0) - r(1, 1) - r(2, 2));
+        q[0] = (r(2, 1) - r(1, 2)) / s;
+        q[1] = s / 4;
+        q[2] = (r(0, 1) + r(1, 0)) / s;
+        q[3] = (r(0, 2) + r(2, 0)) / s;
+    }
+    else if (r(1, 1) > r(2, 2)) {
+        float s = 2 * std::sqrt(1 + r(1, 1) - r(0, 0) - r(2, 2));
+        q[0] = (r(0, 2) - r(2, 0)) / s;
+        q[1] = (r(0, 1) + r(1, 0)) / s;
+        q[2] = s / 4;
+        q[3] = (r(1, 2) + r(2, 1)) / s;
+    }
+    else {
+        float s = 2 * std::sqrt(1 + r(2, 2) - r(0, 0) - r(1, 1));
+        q[0] = (r(1, 0) - r(0, 1)) / s;
+        q[1] = (r(0, 2) + r(2, 0)) / s;
+        q[2] = (r(1, 2) + r(2, 1)) / s;
+        q[3] = s / 4;
+    }
+    float length =
+        std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    SkinningDualQuaternion result;
+    for (int i = 0; i < 4; ++i) {
+        result.real[i] = q[i] / length;
+    }
+    float t[4] = { 0, matrix.m[9], matrix.m[10], matrix.m[11] };
+    quaternion_multiply(t, result.real, result.dual);
+    for (int i = 0; i < 4; ++i) {
+        result.dual[i] *= 0.5f;
+    }
+    return result;
+}
+
+static void blend_matrix(
+    const SkinningMatrix* matrices,
+    const int* indices,
+    const float* weights,
+    size_t influence_count,
+    float* out)
+{
+    for (int c = 0; c < 12; ++c) {
+        out[c] = 0;
+    }
+    for (size_t k = 0; k < influence_count; ++k) {
+        auto& m = matrices[indices[k]].m;
+        float w = weights[k];
+        for (int c = 0; c < 12; ++c) {
+            out[c] += w * m[c];
+        }
+    }
+}
+
+// Blends the dual quaternions and converts the result back to a matrix, so
+// points and normals are transformed like in linear blending.
+static void blend_dual_quaternion(
+    const SkinningDualQuaternion* quaternions,
+    const int* indices,
+    const float* weights,
+    size_t influence_count,
+    float* out)
+{
+    float real[4] = {};
+    float dual[4] = {};
+    auto& pivot = quaternions[indices[0]].real;
+    for (size_t k = 0; k < influence_count; ++k) {
+        auto& q = quaternions[indices[k]];
+        // Take the shortest path relative to the first influence.
+        float dot = q.real[0] * pivot[0] + q.real[1] * pivot[1] +
+                    q.real[2] * pivot[2] + q.real[3] * pivot[3];
+        float w = dot < 0 ? -weights[k] : weights[k];
+        for (int i = 0; i < 4; ++i) {
+            real[i] += w * q.real[i];
+            dual[i] += w * q.dual[i];
+        }
+    }
+
+    float length = std::sqrt(
+        real[0] * real[0] + real[1] * real[1] + real[2] * real[2] +
+        real[3] * real[3]);
+    for (int i = 0; i < 4; ++i) {
+        real[i] /= length;
+        dual[i] /= length;
+    }
+
+    float w = real[0], x = real[1], y = real[2], z = real[3];
+    // Rows of the rotation for row vectors.
+    out[0] = 1 - 2 * (y * y + z * z);
+    out[1] = 2 * (x * y + w * z);
+    out[2] = 2 * (x * z - w * y);
+    out[3] = 2 * (x * y - w * z);
+    out[4] = 1 - 2 * (x * x + z * z);
+    out[5] = 2 * (y * z + w * x);
+    out[6] = 2 * (x * z + w * y);
+    out[7] = 2 * (y * z - w * x);
+    out[8] = 1 - 2 * (x * x + y * y);
+
+    float conjugate[4] = { w, -x, -y, -z };
+    float t[4];
+    quaternion_multiply(dual, conjugate, t);
+    out[9] = 2 * t[1];
+    out[10] = 2 * t[2];
+    out[11] = 2 * t[3];
+}
+
+static pxr::GfVec3f transform_point(const float* m, const pxr::GfVec3f& p)
+{
+    return pxr::GfVec3f(
+        p[0] * m[0] + p[1] * m[3] + p[2] * m[6] + m[9],
+        p[0] * m[1] + p[1] * m[4] + p[2] * m[7] + m[10],
+        p[0] * m[2] + p[1] * m[5] + p[2] * m[8] + m[11]);
+}
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(skinning)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<bool>("Dual Quaternion").default_val(false);
+    b.add_output<Geometry>("Geometry");
+}
+
+// Deforms the mesh with the joint transforms of its skeleton. The mesh is
+// assumed to be bound with an identity geomBindTransform and in the joint
+// order of the skeleton.
+NODE_EXECUTION_FUNCTION(skinning)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    auto mesh = geometry.get_component<MeshComponent>();
+    auto skel = geometry.get_component<SkelComponent>();
+    if (!mesh || !skel) {
+        throw std::runtime_error("Skinning requires a mesh and a skeleton.");
+    }
+
+    auto points = mesh->get_vertices();
+    auto joint_count = skel->topology.GetNumJoints();
+    if (points.empty() || !joint_count) {
+        params.set_output("Geometry", std::move(geometry));
+        return true;
+    }
+    if (skel->localTransforms.size() != joint_count ||
+        skel->bindTransforms.size() != joint_count) {
+        throw std::runtime_error("Joint transforms do not match the joints.");
+    }
+
+    auto& storage = params.get_storage<SkinningStorage&>();
+    if (!influence_layout_valid(storage, *skel, points.size(), joint_count)) {
+        build_influence_layout(storage, *skel, points.size(), joint_count);
+    }
+
+    // Skinning transforms of this frame: from bind pose to skeleton space.
+    pxr::VtArray<pxr::GfMatrix4f> skel_transforms(joint_count);
+    pxr::UsdSkelConcatJointTransforms(
+        skel->topology,
+        pxr::TfSpan<const pxr::GfMatrix4f>(skel->localTransforms),
+        pxr::TfSpan<pxr::GfMatrix4f>(skel_transforms));
+
+    std::vector<SkinningMatrix> matrices(joint_count);
+    for (size_t j = 0; j < joint_count; ++j) {
+        auto inverse_bind =
+            pxr::GfMatrix4f(skel->bindTransforms[j].GetInverse());
+        matrices[j] = to_skinning_matrix(inverse_bind * skel_transforms[j]);
+    }
+
+    auto dual_quaternion = params.get_input<bool>("Dual Quaternion");
+    std::vector<SkinningDualQuaternion> quaternions;
+    if (dual_quaternion) {
+        quaternions.resize(joint_count);
+        for (size_t j = 0; j < joint_count; ++j) {
+            quaternions[j] = to_dual_quaternion(matrices[j]);
+        }
+    }
+
+    auto normals = mesh->get_normals();
+    bool skin_normals = normals.size() == points.size();
+
+    auto& influences = storage.influences;
+    auto influence_count = influences.influence_count;
+    auto blend = [&](size_t row, float* out) {
+        auto indices = influences.indices.data() + row * influence_count;
+        auto weights = influences.weights.data() + row * influence_count;
+        if (weights[0] == 0) {
+            return false;
+        }
+        if (dual_quaternion) {
+            blend_dual_quaternion(
+                quaternions.data(), indices, weights, influence_count, out);
+        }
+        else {
+            blend_matrix(
+                matrices.data(), indices, weights, influence_count, out);
+        }
+        return true;
+    };
+
+    float constant_matrix[12];
+    bool constant_skinned = influences.constant && blend(0, constant_matrix);
+    if (!influences.constant || constant_skinned) {
+        auto point_data = points.data();
+        auto normal_data = skin_normals ? normals.data() : nullptr;
+        pxr::WorkParallelForN(
+            points.size(),
+            [&](size_t begin, size_t end) {
+                float matrix[12];
+                for (size_t i = begin; i < end; ++i) {
+                    const float* m = constant_matrix;
+                    if (!influences.constant) {
+                        if (!blend(i, matrix)) {
+                            continue;
+                        }
+                        m = matrix;
+                    }
+                    point_data[i] = transform_point(m, point_data[i]);
+                    if (normal_data) {
+                        normal_data[i] = skin_normal(m, normal_data[i]);
+                    }
+                }
+            },
+            4096);
+    }
+
+    mesh->set_vertices(points);
+    if (skin_normals) {
+        mesh->set_normals(normals);
+    }
+
+    params.set_output("Geometry", std::move(geometry));
+    return true;
+}
+
+NODE_DECLARATION_UI(skinning);
+NODE_DEF_CLOSE_SCOPE
@@ -109,5 +109,6 @@ NODE_EXECUTION_FUNCTION(tutte)
     return true;
 }
 
+NODE_DECLARATION_PURE(tutte);
 NODE_DECLARATION_UI(tutte);
 NODE_DEF_CLOSE_SCOPE
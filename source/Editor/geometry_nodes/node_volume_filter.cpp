@@ -0,0 +1,51 @@
+#include <openvdb/tools/LevelSetFilter.h>
+
+#include "GCore/Components/VolumeComponent.h"
+#include "geom_node_base.h"
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(volume_filter)
+{
+    b.add_input<Geometry>("Volume");
+    b.add_input<int>("Smooth Iterations").min(0).max(20).default_val(1);
+    b.add_input<int>("Smooth Width").min(1).max(5).default_val(1);
+    b.add_input<float>("Offset").min(-2).max(2).default_val(0.f);
+    b.add_output<Geometry>("Volume");
+}
+
+// Gaussian smoothing and dilation (positive offset) or erosion of the level
+// set. Other grids are passed along untouched and stay shared.
+NODE_EXECUTION_FUNCTION(volume_filter)
+{
+    auto volume_geometry = params.get_input<Geometry>("Volume");
+    auto volume = volume_geometry.get_component<VolumeComponent>();
+    if (!volume) {
+        throw std::runtime_error("Input does not contain a volume");
+    }
+
+    auto grid = volume->get_grid_for_write<openvdb::FloatGrid>("surface");
+    if (!grid || grid->getGridClass() != openvdb::GRID_LEVEL_SET) {
+        throw std::runtime_error("Volume does not contain a level set");
+    }
+
+    auto iterations = params.get_input<int>("Smooth Iterations");
+    auto width = std::max(params.get_input<int>("Smooth Width"), 1);
+    auto offset = params.get_input<float>("Offset");
+
+    openvdb::tools::LevelSetFilter<openvdb::FloatGrid> filter(*grid);
+    for (int i = 0; i < iterations; ++i) {
+        filter.gaussian(width);
+    }
+    if (offset != 0.f) {
+        // The filter offsets the distance values, negative values grow the
+        // surface.
+        filter.offset(-offset);
+    }
+
+    params.set_output("Volume", std::move(volume_geometry));
+
+    return true;
+}
+
+NODE_DECLARATION_UI(volume_filter);
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,38 @@
+#include "GCore/Components/VolumeComponent.h"
+#include "GCore/util_openvdb.h"
+#include "geom_node_base.h"
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(volume_to_mesh)
+{
+    b.add_input<Geometry>("Volume");
+    b.add_input<float>("Isovalue").min(-2).max(2).default_val(0.f);
+    b.add_input<float>("Adaptivity").min(0).max(1).default_val(0.f);
+    b.add_output<Geometry>("Mesh");
+}
+
+NODE_EXECUTION_FUNCTION(volume_to_mesh)
+{
+    auto volume_geometry = params.get_input<Geometry>("Volume");
+    auto volume = volume_geometry.get_component<VolumeComponent>();
+    if (!volume) {
+        throw std::runtime_error("Input does not contain a volume");
+    }
+
+    auto grid = volume->get_grid<openvdb::FloatGrid>("surface");
+    if (!grid) {
+        throw std::runtime_error("Volume does not contain a surface grid");
+    }
+
+    auto isovalue = params.get_input<float>("Isovalue");
+    auto adaptivity =
+        std::clamp(params.get_input<float>("Adaptivity"), 0.f, 1.f);
+
+    params.set_output(
+        "Mesh", level_set_to_operand(*grid, isovalue, adaptivity));
+
+    return true;
+}
+
+NODE_DECLARATION_UI(volume_to_mesh);
+NODE_DEF_CLOSE_SCOPE
@@ -1,11 +1,24 @@
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/listOp.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/sdf/relationshipSpec.h>
 #include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/tokens.h>
 #include <pxr/usd/usdGeom/basisCurves.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/points.h>
 #include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/tokens.h>
 #include <pxr/usd/usdShade/material.h>
 #include <pxr/usd/usdShade/materialBindingAPI.h>
 
+#include <algorithm>
+#include <cctype>
+#include <string>
+
 #include "GCore/Components/CurveComponent.h"
 #include "GCore/Components/MaterialComponent.h"
 #include "GCore/Components/MeshOperand.h"
@@ -22,6 +35,11 @@ NODE_DECLARATION_FUNCTION(write_usd)
     b.add_input<Geometry>("Geometry");
 }
 
+NODE_DECLARATION_FUNCTION(write_usd_batch)
+{
+    b.add_input_group<Geometry>("Geometries").set_runtime_dynamic(true);
+}
+
 bool legal(const std::string& string)
 {
     if (string.empty()) {
@@ -35,140 +53,110 @@ bool legal(const std::string& string)
     return false;
 }
 
-NODE_EXECUTION_FUNCTION(write_usd)
+// Everything to author for one geometry. It is gathered from the components
+// before any authoring happens, so that several geometries can be read in
+// parallel and then written to the layer in a single change block.
+struct AttributeWrite {
+    pxr::TfToken name;
+    pxr::SdfValueTypeName type;
+    pxr::SdfVariability variability = pxr::SdfVariabilityVarying;
+    pxr::VtValue value;
+    bool time_sampled = false;
+    bool custom = false;
+    pxr::TfToken interpolation;
+    int element_size = 0;
+};
+
+struct GeometryWrite {
+    pxr::SdfPath path;
+    pxr::TfToken type_name;
+    std::vector<AttributeWrite> attributes;
+    std::string texture;
+    pxr::GfMatrix4d transform = pxr::GfMatrix4d(1);
+};
+
+static void gather_prim_attributes(
+    const pxr::UsdPrim& from,
+    std::vector<AttributeWrite>& attributes)
 {
-    auto& global_payload = params.get_global_payload<GeomPayload&>();
+    for (pxr::UsdAttribute attr : from.GetAuthoredAttributes()) {
+        AttributeWrite write;
+        if (!attr.Get(&write.value)) {
+            continue;
+        }
+        write.name = attr.GetName();
+        write.type = attr.GetTypeName();
+        write.variability = attr.GetVariability();
+
+        pxr::UsdGeomPrimvar primvar(attr);
+        if (primvar) {
+            write.interpolation = primvar.GetInterpolation();
+            write.element_size = primvar.GetElementSize();
+        }
+        attributes.push_back(std::move(write));
+    }
+}
 
-    auto geometry = params.get_input<Geometry>("Geometry");
+static GeometryWrite gather_geometry(
+    const Geometry& geometry,
+    const pxr::SdfPath& path)
+{
+    GeometryWrite write;
+    write.path = path;
 
     auto mesh = geometry.get_component<MeshComponent>();
-
     auto points = geometry.get_component<PointsComponent>();
-
     auto curve = geometry.get_component<CurveComponent>();
 
     assert(!(points && mesh));
 
-    pxr::UsdTimeCode time = global_payload.current_time;
-
-    auto stage = global_payload.stage;
-    auto sdf_path = global_payload.prim_path;
-
     if (mesh) {
-        pxr::UsdGeomMesh usdgeom = pxr::UsdGeomMesh::Define(stage, sdf_path);
-        if (usdgeom) {
-            copy_prim(mesh->get_usd_mesh().GetPrim(), usdgeom.GetPrim());
-            usdgeom.CreateDoubleSidedAttr().Set(true);
-        }
+        write.type_name = pxr::TfToken("Mesh");
+        gather_prim_attributes(
+            mesh->get_usd_mesh().GetPrim(), write.attributes);
+        write.attributes.push_back({ pxr::UsdGeomTokens->doubleSided,
+                                     pxr::SdfValueTypeNames->Bool,
+                                     pxr::SdfVariabilityUniform,
+                                     pxr::VtValue(true) });
     }
     else if (points) {
-        pxr::UsdGeomPoints usdpoints =
-            pxr::UsdGeomPoints::Define(stage, sdf_path);
-
-        usdpoints.CreatePointsAttr().Set(points->get_vertices(), time);
-
-        if (points->get_width().size() > 0) {
-            usdpoints.CreateWidthsAttr().Set(points->get_width(), time);
+        write.type_name = pxr::TfToken("Points");
+        write.attributes.push_back({ pxr::UsdGeomTokens->points,
+                                     pxr::SdfValueTypeNames->Point3fArray,
+                                     pxr::SdfVariabilityVarying,
+                                     pxr::VtValue(points->get_vertices()),
+                                     true });
+
+        auto width = points->get_width();
+        if (width.size() > 0) {
+            write.attributes.push_back({ pxr::UsdGeomTokens->widths,
+                                         pxr::SdfValueTypeNames->FloatArray,
+                                         pxr::SdfVariabilityVarying,
+                                         pxr::VtValue(width),
+                                         true });
         }
 
-        auto PrimVarAPI = pxr::UsdGeomPrimvarsAPI(usdpoints);
-        if (points->get_display_color().size() > 0) {
-            pxr::UsdGeomPrimvar colorPrimvar = PrimVarAPI.CreatePrimvar(
-                pxr::TfToken("displayColor"),
-                pxr::SdfValueTypeNames->Color3fArray);
-            colorPrimvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-            colorPrimvar.Set(points->get_display_color(), time);
+        auto display_color = points->get_display_color();
+        if (display_color.size() > 0) {
+            write.attributes.push_back({ pxr::TfToken("primvars:displayColor"),
+                                         pxr::SdfValueTypeNames->Color3fArray,
+                                         pxr::SdfVariabilityVarying,
+                                         pxr::VtValue(display_color),
+                                         true,
+                                         false,
+                                         pxr::UsdGeomTokens->vertex });
         }
     }
     else if (curve) {
-        pxr::UsdGeomBasisCurves usd_curve =
-            pxr::UsdGeomBasisCurves::Define(stage, sdf_path);
-        if (usd_curve) {
-            copy_prim(curve->get_usd_curve().GetPrim(), usd_curve.GetPrim());
-        }
+        write.type_name = pxr::TfToken("BasisCurves");
+        gather_prim_attributes(
+            curve->get_usd_curve().GetPrim(), write.attributes);
     }
 
-    // Material and Texture
     auto material_component = geometry.get_component<MaterialComponent>();
-    if (material_component) {
-        auto usdgeom = pxr::UsdGeomXformable ::Get(stage, sdf_path);
-        if (legal(std::string(material_component->textures[0].c_str()))) {
-            auto texture_name =
-                std::string(material_component->textures[0].c_str());
-            std::filesystem::path p =
-                std::filesystem::path(texture_name).replace_extension();
-            auto file_name = "texture" + p.filename().string();
-
-            auto material_path_root = pxr::SdfPath("/TexModel");
-            auto material_path =
-                material_path_root.AppendPath(pxr::SdfPath(file_name + "Mat"));
-            auto material_shader_path =
-                material_path.AppendPath(pxr::SdfPath("PBRShader"));
-            auto material_stReader_path =
-                material_path.AppendPath(pxr::SdfPath("stReader"));
-            auto material_texture_path =
-                material_path.AppendPath(pxr::SdfPath("diffuseTexture"));
-
-            auto material = pxr::UsdShadeMaterial::Define(stage, material_path);
-            auto pbrShader =
-                pxr::UsdShadeShader::Define(stage, material_shader_path);
-
-            pbrShader.CreateIdAttr(
-                pxr::VtValue(pxr::TfToken("UsdPreviewSurface")));
-            material.CreateSurfaceOutput().ConnectToSource(
-                pbrShader.ConnectableAPI(), pxr::TfToken("surface"));
-
-            auto stReader =
-                pxr::UsdShadeShader::Define(stage, material_stReader_path);
-            stReader.CreateIdAttr(
-                pxr::VtValue(pxr::TfToken("UsdPrimvarReader_float2")));
-
-            auto diffuseTextureSampler =
-                pxr::UsdShadeShader::Define(stage, material_texture_path);
-
-            diffuseTextureSampler.CreateIdAttr(
-                pxr::VtValue(pxr::TfToken("UsdUVTexture")));
-            diffuseTextureSampler
-                .CreateInput(
-                    pxr::TfToken("file"), pxr::SdfValueTypeNames->Asset)
-                .Set(pxr::SdfAssetPath(texture_name));
-            diffuseTextureSampler
-                .CreateInput(pxr::TfToken("st"), pxr::SdfValueTypeNames->Float2)
-                .ConnectToSource(
-                    stReader.ConnectableAPI(), pxr::TfToken("result"));
-            diffuseTextureSampler.CreateOutput(
-                pxr::TfToken("rgb"), pxr::SdfValueTypeNames->Float3);
-
-            diffuseTextureSampler
-                .CreateInput(
-                    pxr::TfToken("wrapS"), pxr::SdfValueTypeNames->Token)
-                .Set(pxr::TfToken("mirror"));
-
-            diffuseTextureSampler
-                .CreateInput(
-                    pxr::TfToken("wrapT"), pxr::SdfValueTypeNames->Token)
-                .Set(pxr::TfToken("mirror"));
-
-            pbrShader
-                .CreateInput(
-                    pxr::TfToken("diffuseColor"),
-                    pxr::SdfValueTypeNames->Color3f)
-                .ConnectToSource(
-                    diffuseTextureSampler.ConnectableAPI(),
-                    pxr::TfToken("rgb"));
-
-            auto stInput = material.CreateInput(
-                pxr::TfToken("frame:stPrimvarName"),
-                pxr::SdfValueTypeNames->Token);
-            stInput.Set(pxr::TfToken("UVMap"));
-
-            stReader
-                .CreateInput(
-                    pxr::TfToken("varname"), pxr::SdfValueTypeNames->Token)
-                .ConnectToSource(stInput);
-
-            usdgeom.GetPrim().ApplyAPI(pxr::UsdShadeTokens->MaterialBindingAPI);
-            pxr::UsdShadeMaterialBindingAPI(usdgeom).Bind(material);
+    if (material_component && !material_component->textures.empty()) {
+        if (legal(material_component->textures[0])) {
+            write.texture = material_component->textures[0];
         }
         else {
             // TODO: Throw something
@@ -177,47 +165,430 @@ NODE_EXECUTION_FUNCTION(write_usd)
 
     auto xform_component = geometry.get_component<XformComponent>();
     if (xform_component) {
-        auto usdgeom = pxr::UsdGeomXformable ::Get(stage, sdf_path);
-        // Transform
         assert(
             xform_component->translation.size() ==
             xform_component->rotation.size());
+        write.transform = xform_component->get_transform();
+    }
+    return write;
+}
+
+// Authors gathered geometries directly as specs in the edit target layer.
+// Going through Sdf skips the per-call composition and validation of the
+// Usd schema API, and lets all the edits be sent as one notification.
+class SdfGeometryWriter {
+   public:
+    SdfGeometryWriter(const pxr::UsdStageRefPtr& stage, pxr::UsdTimeCode time)
+        : layer(stage->GetEditTarget().GetLayer()),
+          edit_target(stage->GetEditTarget()),
+          time(time)
+    {
+    }
+
+    void write(const GeometryWrite& geometry)
+    {
+        auto prim = define(geometry.path, geometry.type_name);
+        if (!prim) {
+            return;
+        }
+
+        for (auto& attribute : geometry.attributes) {
+            auto spec = create_attribute(
+                prim,
+                attribute.name,
+                attribute.type,
+                attribute.variability,
+                attribute.custom);
+            if (!spec) {
+                continue;
+            }
+            if (!attribute.interpolation.IsEmpty()) {
+                spec->SetInfo(
+                    pxr::UsdGeomTokens->interpolation,
+                    pxr::VtValue(attribute.interpolation));
+            }
+            if (attribute.element_size > 1) {
+                spec->SetInfo(
+                    pxr::UsdGeomTokens->elementSize,
+                    pxr::VtValue(attribute.element_size));
+            }
+            set(spec, attribute.value, attribute.time_sampled);
+        }
+
+        if (!geometry.texture.empty()) {
+            bind_material(prim, write_material(geometry.texture));
+        }
+
+        write_transform(prim, geometry.transform);
+
+        set(create_attribute(
+                prim,
+                pxr::UsdGeomTokens->visibility,
+                pxr::SdfValueTypeNames->Token),
+            pxr::VtValue(pxr::UsdGeomTokens->inherited),
+            false);
+    }
+
+    void set_animatable(const pxr::SdfPath& path, bool animatable)
+    {
+        auto prim = layer->GetPrimAtPath(edit_target.MapToSpecPath(path));
+        if (!prim) {
+            prim = define(path, pxr::TfToken());
+        }
+        set(create_attribute(
+                prim,
+                pxr::TfToken("Animatable"),
+                pxr::SdfValueTypeNames->Bool,
+                pxr::SdfVariabilityVarying,
+                true),
+            pxr::VtValue(animatable),
+            false);
+    }
+
+    // Removes the batch children geometry_<i> of path with i >= count, left
+    // over from a larger batch.
+    void remove_batch_children(const pxr::SdfPath& path, size_t count)
+    {
+        auto prim = layer->GetPrimAtPath(edit_target.MapToSpecPath(path));
+        if (!prim) {
+            return;
+        }
+        static const std::string prefix = "geometry_";
+        std::vector<pxr::SdfPrimSpecHandle> stale;
+        for (auto&& child : prim->GetNameChildren()) {
+            auto& name = child->GetName();
+            if (name.size() <= prefix.size() ||
+                name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            auto index = name.substr(prefix.size());
+            auto is_digit = [](unsigned char c) { return std::isdigit(c); };
+            if (std::all_of(index.begin(), index.end(), is_digit) &&
+                std::stoull(index) >= count) {
+                stale.push_back(child);
+            }
+        }
+        for (auto& child : stale) {
+            prim->RemoveNameChild(child);
+        }
+    }
+
+   private:
+    // Like UsdStage::DefinePrim, ancestors missing from the layer are defined
+    // as typeless prims rather than left as the 'over's Sdf creates.
+    pxr::SdfPrimSpecHandle define(
+        const pxr::SdfPath& path,
+        const pxr::TfToken& type_name)
+    {
+        auto spec_path = edit_target.MapToSpecPath(path);
+
+        pxr::SdfPathVector missing;
+        for (auto p = spec_path.GetParentPath();
+             p != pxr::SdfPath::AbsoluteRootPath();
+             p = p.GetParentPath()) {
+            if (!layer->GetPrimAtPath(p)) {
+                missing.push_back(p);
+            }
+        }
+
+        auto prim = pxr::SdfCreatePrimInLayer(layer, spec_path);
+        if (!prim) {
+            return prim;
+        }
+        for (auto& p : missing) {
+            layer->GetPrimAtPath(p)->SetSpecifier(pxr::SdfSpecifierDef);
+        }
+        if (prim->GetSpecifier() != pxr::SdfSpecifierDef) {
+            prim->SetSpecifier(pxr::SdfSpecifierDef);
+        }
+        if (!type_name.IsEmpty() && prim->GetTypeName() != type_name) {
+            prim->SetTypeName(type_name);
+        }
+        return prim;
+    }
+
+    pxr::SdfAttributeSpecHandle create_attribute(
+        const pxr::SdfPrimSpecHandle& prim,
+        const pxr::TfToken& name,
+        const pxr::SdfValueTypeName& type,
+        pxr::SdfVariability variability = pxr::SdfVariabilityVarying,
+        bool custom = false)
+    {
+        auto spec =
+            layer->GetAttributeAtPath(prim->GetPath().AppendProperty(name));
+        if (spec) {
+            if (spec->GetTypeName() == type) {
+                return spec;
+            }
+            prim->RemoveProperty(spec);
+        }
+        return pxr::SdfAttributeSpec::New(
+            prim, name, type, variability, custom);
+    }
+
+    void set(
+        const pxr::SdfAttributeSpecHandle& spec,
+        const pxr::VtValue& value,
+        bool time_sampled)
+    {
+        if (!spec) {
+            return;
+        }
+        if (time_sampled && !time.IsDefault()) {
+            layer->SetTimeSample(spec->GetPath(), time.GetValue(), value);
+        }
+        else {
+            spec->SetDefaultValue(value);
+        }
+    }
+
+    void connect(
+        const pxr::SdfAttributeSpecHandle& spec,
+        const pxr::SdfPath& source)
+    {
+        if (!spec) {
+            return;
+        }
+        auto connections = spec->GetConnectionPathList();
+        connections.ClearEditsAndMakeExplicit();
+        connections.Add(source);
+    }
+
+    pxr::SdfAttributeSpecHandle create_output(
+        const pxr::SdfPrimSpecHandle& prim,
+        const char* name,
+        const pxr::SdfValueTypeName& type)
+    {
+        return create_attribute(
+            prim, pxr::TfToken(std::string("outputs:") + name), type);
+    }
+
+    pxr::SdfAttributeSpecHandle create_input(
+        const pxr::SdfPrimSpecHandle& prim,
+        const char* name,
+        const pxr::SdfValueTypeName& type)
+    {
+        return create_attribute(
+            prim, pxr::TfToken(std::string("inputs:") + name), type);
+    }
+
+    pxr::SdfPrimSpecHandle define_shader(
+        const pxr::SdfPath& path,
+        const char* shader_id)
+    {
+        auto shader = define(path, pxr::TfToken("Shader"));
+        set(create_attribute(
+                shader,
+                pxr::UsdShadeTokens->infoId,
+                pxr::SdfValueTypeNames->Token,
+                pxr::SdfVariabilityUniform),
+            pxr::VtValue(pxr::TfToken(shader_id)),
+            false);
+        return shader;
+    }
+
+    // The network only depends on the texture, so an existing one pointing to
+    // the same file is reused as is.
+    pxr::SdfPath write_material(const std::string& texture_name)
+    {
+        std::filesystem::path p =
+            std::filesystem::path(texture_name).replace_extension();
+        auto file_name = "texture" + p.filename().string();
+
+        auto material_path_root = pxr::SdfPath("/TexModel");
+        auto material_path =
+            material_path_root.AppendPath(pxr::SdfPath(file_name + "Mat"));
+        auto material_shader_path =
+            material_path.AppendPath(pxr::SdfPath("PBRShader"));
+        auto material_stReader_path =
+            material_path.AppendPath(pxr::SdfPath("stReader"));
+        auto material_texture_path =
+            material_path.AppendPath(pxr::SdfPath("diffuseTexture"));
+
+        auto file_attr = layer->GetAttributeAtPath(
+            edit_target.MapToSpecPath(material_texture_path)
+                .AppendProperty(pxr::TfToken("inputs:file")));
+        if (file_attr && file_attr->GetDefaultValue() ==
+                             pxr::VtValue(pxr::SdfAssetPath(texture_name))) {
+            return material_path;
+        }
 
-        pxr::GfMatrix4d final_transform = xform_component->get_transform();
+        auto material = define(material_path, pxr::TfToken("Material"));
+        auto pbrShader =
+            define_shader(material_shader_path, "UsdPreviewSurface");
+        auto stReader =
+            define_shader(material_stReader_path, "UsdPrimvarReader_float2");
+        auto diffuseTextureSampler =
+            define_shader(material_texture_path, "UsdUVTexture");
+
+        auto surface =
+            create_output(pbrShader, "surface", pxr::SdfValueTypeNames->Token);
+        connect(
+            create_output(material, "surface", pxr::SdfValueTypeNames->Token),
+            surface->GetPath());
+
+        auto st_result =
+            create_output(stReader, "result", pxr::SdfValueTypeNames->Float2);
+
+        set(create_input(
+                diffuseTextureSampler, "file", pxr::SdfValueTypeNames->Asset),
+            pxr::VtValue(pxr::SdfAssetPath(texture_name)),
+            false);
+        connect(
+            create_input(
+                diffuseTextureSampler, "st", pxr::SdfValueTypeNames->Float2),
+            st_result->GetPath());
+        auto rgb = create_output(
+            diffuseTextureSampler, "rgb", pxr::SdfValueTypeNames->Float3);
+        set(create_input(
+                diffuseTextureSampler, "wrapS", pxr::SdfValueTypeNames->Token),
+            pxr::VtValue(pxr::TfToken("mirror")),
+            false);
+        set(create_input(
+                diffuseTextureSampler, "wrapT", pxr::SdfValueTypeNames->Token),
+            pxr::VtValue(pxr::TfToken("mirror")),
+            false);
+
+        connect(
+            create_input(
+                pbrShader, "diffuseColor", pxr::SdfValueTypeNames->Color3f),
+            rgb->GetPath());
+
+        auto stInput = create_input(
+            material, "frame:stPrimvarName", pxr::SdfValueTypeNames->Token);
+        set(stInput, pxr::VtValue(pxr::TfToken("UVMap")), false);
+
+        connect(
+            create_input(stReader, "varname", pxr::SdfValueTypeNames->Token),
+            stInput->GetPath());
+
+        return material_path;
+    }
+
+    void bind_material(
+        const pxr::SdfPrimSpecHandle& prim,
+        const pxr::SdfPath& material_path)
+    {
+        auto schemas = prim->GetInfo(pxr::UsdTokens->apiSchemas);
+        pxr::SdfTokenListOp list_op;
+        if (schemas.IsHolding<pxr::SdfTokenListOp>()) {
+            list_op = schemas.UncheckedGet<pxr::SdfTokenListOp>();
+        }
+        if (!list_op.HasItem(pxr::UsdShadeTokens->MaterialBindingAPI)) {
+            auto prepended = list_op.GetPrependedItems();
+            prepended.push_back(pxr::UsdShadeTokens->MaterialBindingAPI);
+            list_op.SetPrependedItems(prepended);
+            prim->SetInfo(pxr::UsdTokens->apiSchemas, pxr::VtValue(list_op));
+        }
 
-        auto xform_op = usdgeom.GetTransformOp();
-        if (!xform_op) {
-            xform_op = usdgeom.AddTransformOp();
+        auto binding = layer->GetRelationshipAtPath(
+            prim->GetPath().AppendProperty(
+                pxr::UsdShadeTokens->materialBinding));
+        if (!binding) {
+            binding = pxr::SdfRelationshipSpec::New(
+                prim, pxr::UsdShadeTokens->materialBinding, false);
         }
-        xform_op.Set(final_transform, time);
+        auto targets = binding->GetTargetPathList();
+        targets.ClearEditsAndMakeExplicit();
+        targets.Add(edit_target.MapToSpecPath(material_path));
     }
-    else {
-        auto usdgeom = pxr::UsdGeomXformable ::Get(stage, sdf_path);
-        auto xform_op = usdgeom.GetTransformOp();
-        if (!xform_op) {
-            xform_op = usdgeom.AddTransformOp();
+
+    void write_transform(
+        const pxr::SdfPrimSpecHandle& prim,
+        const pxr::GfMatrix4d& transform)
+    {
+        static const pxr::TfToken transform_op("xformOp:transform");
+
+        set(create_attribute(
+                prim, transform_op, pxr::SdfValueTypeNames->Matrix4d),
+            pxr::VtValue(transform),
+            true);
+
+        auto order_spec = create_attribute(
+            prim,
+            pxr::UsdGeomTokens->xformOpOrder,
+            pxr::SdfValueTypeNames->TokenArray,
+            pxr::SdfVariabilityUniform);
+        pxr::VtArray<pxr::TfToken> order;
+        auto order_value = order_spec->GetDefaultValue();
+        if (order_value.IsHolding<pxr::VtArray<pxr::TfToken>>()) {
+            order = order_value.UncheckedGet<pxr::VtArray<pxr::TfToken>>();
+        }
+        if (std::find(order.begin(), order.end(), transform_op) ==
+            order.end()) {
+            order.push_back(transform_op);
+            set(order_spec, pxr::VtValue(order), false);
         }
-        xform_op.Set(pxr::GfMatrix4d(1), time);
     }
 
-    if (global_payload.has_simulation) {
-        pxr::UsdPrim prim = stage->GetPrimAtPath(sdf_path);
-        prim.CreateAttribute(
-                pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool)
-            .Set(true);
+    pxr::SdfLayerHandle layer;
+    pxr::UsdEditTarget edit_target;
+    pxr::UsdTimeCode time;
+};
+
+static void write_geometries(
+    GeomPayload& global_payload,
+    const std::vector<const Geometry*>& geometries,
+    const std::vector<pxr::SdfPath>& paths,
+    bool batch = false)
+{
+    std::vector<GeometryWrite> writes(geometries.size());
+    pxr::WorkParallelForN(geometries.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            writes[i] = gather_geometry(*geometries[i], paths[i]);
+        }
+    });
+
+    SdfGeometryWriter writer(
+        global_payload.stage, global_payload.current_time);
+
+    pxr::SdfChangeBlock change_block;
+    for (auto& write : writes) {
+        writer.write(write);
+    }
+    if (batch) {
+        writer.remove_batch_children(
+            global_payload.prim_path, geometries.size());
     }
-    else {
-        pxr::UsdPrim prim = stage->GetPrimAtPath(sdf_path);
-        prim.CreateAttribute(
-                pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool)
-            .Set(false);
+    writer.set_animatable(
+        global_payload.prim_path, global_payload.has_simulation);
+}
+
+NODE_EXECUTION_FUNCTION(write_usd)
+{
+    auto& global_payload = params.get_global_payload<GeomPayload&>();
+
+    auto geometry = params.get_input<Geometry>("Geometry");
+
+    write_geometries(
+        global_payload, { &geometry }, { global_payload.prim_path });
+    return true;
+}
+
+// Each geometry of the group is written as a child prim of the payload prim,
+// all of them in a single pass. Children beyond the size of the group are
+// removed.
+NODE_EXECUTION_FUNCTION(write_usd_batch)
+{
+    auto& global_payload = params.get_global_payload<GeomPayload&>();
+
+    auto geometries = params.get_input_group<Geometry>("Geometries");
+
+    std::vector<const Geometry*> inputs;
+    std::vector<pxr::SdfPath> paths;
+    for (size_t i = 0; i < geometries.size(); ++i) {
+        inputs.push_back(&geometries[i]);
+        paths.push_back(global_payload.prim_path.AppendChild(
+            pxr::TfToken("geometry_" + std::to_string(i))));
     }
 
-    pxr::UsdGeomImageable(stage->GetPrimAtPath(sdf_path)).MakeVisible();
+    write_geometries(global_payload, inputs, paths, true);
     return true;
 }
 
 NODE_DECLARATION_REQUIRED(write_usd);
+NODE_DECLARATION_REQUIRED(write_usd_batch);
 
 NODE_DECLARATION_UI(write_usd);
+NODE_DECLARATION_UI(write_usd_batch);
 NODE_DEF_CLOSE_SCOPE
@@ -1,9 +1,5 @@
 #include "geom_node_base.h"
-
-struct SimulationStorage {
-    std::vector<entt::meta_any> data;
-    static constexpr bool has_storage = false;
-};
+#include "nodes/core/simulation_zone.hpp"
 
 NODE_DEF_OPEN_SCOPE
 
@@ -18,23 +14,7 @@ NODE_EXECUTION_FUNCTION(simulation_in)
     auto& global_payload = params.get_global_payload<GeomPayload&>();
     global_payload.has_simulation = true;
 
-    std::vector<entt::meta_any*> inputs;
-    if (!global_payload.is_simulating) {
-        inputs = params.get_input_group("Simulation In");
-        std::vector<entt::meta_any> outputs;
-
-        for (auto& input : inputs) {
-            outputs.push_back(*input);
-        }
-
-        params.set_output_group("Simulation Out", outputs);
-    }
-    else {
-        auto& outputs = params.get_storage<SimulationStorage&>().data;
-        params.set_output_group("Simulation Out", outputs);
-    }
-
-    return true;
+    return execute_simulation_in(params, global_payload.is_simulating);
 }
 
 NODE_DECLARATION_FUNCTION(simulation_out)
@@ -45,16 +25,7 @@ NODE_DECLARATION_FUNCTION(simulation_out)
 
 NODE_EXECUTION_FUNCTION(simulation_out)
 {
-    auto inputs = params.get_input_group("Simulation In");
-
-    std::vector<entt::meta_any> outputs;
-
-    for (auto& input : inputs) {
-        outputs.push_back(*input);
-    }
-    params.get_storage<SimulationStorage&>().data = outputs;
-    params.set_output_group("Simulation Out", outputs);
-    return true;
+    return execute_simulation_out(params);
 }
 
-NODE_DEF_CLOSE_SCOPE
\ No newline at end of file
+NODE_DEF_CLOSE_SCOPE
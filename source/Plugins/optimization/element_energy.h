@@ -0,0 +1,195 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <Eigen/Sparse>
+#include <autodiff/forward/dual.hpp>
+#include <autodiff/forward/dual/eigen.hpp>
+#include <functional>
+#include <vector>
+
+#include "USTC_CG.h"
+#include "pxr/base/work/loops.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// An energy that is a sum of small terms, each depending on a few variables,
+// such as the coordinates of the vertices of one edge or triangle. Derivatives
+// are taken per element with forward mode autodiff over its local variables
+// only, and assembled in parallel into the gradient and a sparse Hessian.
+class ElementEnergy {
+   public:
+    // Energy of one element, x holds its variables in the order of its
+    // indices.
+    using LocalFunction = std::function<autodiff::dual2nd(
+        const autodiff::ArrayXdual2nd& x,
+        size_t element)>;
+
+    ElementEnergy() = default;
+
+    explicit ElementEnergy(int variable_count)
+        : variable_count_(variable_count)
+    {
+    }
+
+    int variable_count() const
+    {
+        return variable_count_;
+    }
+
+    // Adds one element for every arity consecutive indices.
+    void add_term(int arity, std::vector<int> indices, LocalFunction function)
+    {
+        terms_.push_back({ arity, std::move(indices), std::move(function) });
+    }
+
+    double value(const Eigen::VectorXd& x) const
+    {
+        return evaluate(x, nullptr, nullptr, false);
+    }
+
+    double gradient(const Eigen::VectorXd& x, Eigen::VectorXd& g) const
+    {
+        return evaluate(x, &g, nullptr, false);
+    }
+
+    // With project_psd the negative eigenvalues of every element Hessian are
+    // clamped to zero, so the assembled Hessian is positive semi-definite.
+    // The sparsity pattern only depends on the elements, not on x.
+    double hessian(
+        const Eigen::VectorXd& x,
+        Eigen::VectorXd& g,
+        Eigen::SparseMatrix<double>& H,
+        bool project_psd) const
+    {
+        return evaluate(x, &g, &H, project_psd);
+    }
+
+   private:
+    struct Term {
+        int arity;
+        std::vector<int> indices;
+        LocalFunction function;
+
+        size_t element_count() const
+        {
+            return indices.size() / arity;
+        }
+    };
+
+    static void project_to_psd(Eigen::MatrixXd& H)
+    {
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(H);
+        if (solver.eigenvalues().minCoeff() >= 0) {
+            return;
+        }
+        H = solver.eigenvectors() *
+            solver.eigenvalues().cwiseMax(0).asDiagonal() *
+            solver.eigenvectors().transpose();
+    }
+
+    double evaluate(
+        const Eigen::VectorXd& x,
+        Eigen::VectorXd* g,
+        Eigen::SparseMatrix<double>* H,
+        bool project_psd) const;
+
+    int variable_count_ = 0;
+    std::vector<Term> terms_;
+};
+
+// Elements write their value, gradient and Hessian entries to their own
+// slots, so the local derivatives are computed in parallel without locking.
+// Summing into the gradient and building the matrix from the triplets, which
+// adds up duplicates, is done afterwards.
+inline double ElementEnergy::evaluate(
+    const Eigen::VectorXd& x,
+    Eigen::VectorXd* g,
+    Eigen::SparseMatrix<double>* H,
+    bool project_psd) const
+{
+    using namespace autodiff;
+
+    std::vector<Eigen::Triplet<double>> triplets;
+    if (H) {
+        size_t triplet_count = 0;
+        for (auto& term : terms_) {
+            triplet_count += term.element_count() * term.arity * term.arity;
+        }
+        triplets.resize(triplet_count);
+    }
+    if (g) {
+        g->setZero(variable_count_);
+    }
+
+    double total = 0;
+    size_t triplet_offset = 0;
+    for (auto& term : terms_) {
+        const int k = term.arity;
+        const size_t count = term.element_count();
+        std::vector<double> values(count);
+        std::vector<double> gradients(g ? count * k : 0);
+
+        pxr::WorkParallelForN(count, [&](size_t begin, size_t end) {
+            ArrayXdual2nd local(k);
+            Eigen::VectorXd local_g;
+            Eigen::MatrixXd local_H;
+            for (size_t e = begin; e < end; ++e) {
+                const int* indices = term.indices.data() + e * k;
+                for (int i = 0; i < k; ++i) {
+                    local[i] = x[indices[i]];
+                }
+                auto f = [&](const ArrayXdual2nd& y) {
+                    return term.function(y, e);
+                };
+
+                dual2nd u;
+                if (H) {
+                    autodiff::hessian(
+                        f, wrt(local), at(local), u, local_g, local_H);
+                    if (project_psd) {
+                        project_to_psd(local_H);
+                    }
+                    auto slot = triplets.data() + triplet_offset + e * k * k;
+                    for (int i = 0; i < k; ++i) {
+                        for (int j = 0; j < k; ++j) {
+                            slot[i * k + j] = Eigen::Triplet<double>(
+                                indices[i], indices[j], local_H(i, j));
+                        }
+                    }
+                }
+                else if (g) {
+                    autodiff::gradient(f, wrt(local), at(local), u, local_g);
+                }
+                else {
+                    u = f(local);
+                }
+
+                values[e] = val(u);
+                if (g) {
+                    std::copy(
+                        local_g.data(),
+                        local_g.data() + k,
+                        gradients.data() + e * k);
+                }
+            }
+        });
+
+        for (size_t e = 0; e < count; ++e) {
+            total += values[e];
+            if (g) {
+                for (int i = 0; i < k; ++i) {
+                    (*g)[term.indices[e * k + i]] += gradients[e * k + i];
+                }
+            }
+        }
+        triplet_offset += count * k * k;
+    }
+
+    if (H) {
+        H->resize(variable_count_, variable_count_);
+        H->setFromTriplets(triplets.begin(), triplets.end());
+    }
+    return total;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -3,6 +3,7 @@
 #include <autodiff/reverse/var/eigen.hpp>
 
 #include "nodes/core/def/node_def.hpp"
+#include "point_input.h"
 using namespace autodiff;
 
 NODE_DEF_OPEN_SCOPE
@@ -10,16 +11,14 @@ NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(gradient_backward)
 {
     b.add_input<std::function<var(const ArrayXvar&)>>("Function");
-//    b.add_input<Eigen::VectorXd>("Target Point");
+    b.add_input<Eigen::VectorXd>("Target Point");
     b.add_output<Eigen::VectorXd>("Gradient");
 }
 
 NODE_EXECUTION_FUNCTION(gradient_backward)
 {
     auto f = params.get_input<std::function<var(const ArrayXvar&)>>("Function");
-    Eigen::VectorXd x0(3);
-//    Eigen::VectorXd x0 = params.get_input<Eigen::VectorXd>("Target Point");
-    x0 << 1, 2, 3;
+    Eigen::VectorXd x0 = get_point_input(params, "Target Point", "Gradient");
     ArrayXvar x = x0.template cast<var>();
     var y = f(x);
     Eigen::VectorXd g = gradient(y, x);
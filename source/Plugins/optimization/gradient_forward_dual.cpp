@@ -3,6 +3,7 @@
 #include <autodiff/forward/dual/eigen.hpp>
 
 #include "nodes/core/def/node_def.hpp"
+#include "point_input.h"
 using namespace autodiff;
 
 NODE_DEF_OPEN_SCOPE
@@ -10,7 +11,7 @@ NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(gradient_forward_dual)
 {
     b.add_input<std::function<dual(const ArrayXdual&)>>("Function");
-    //    b.add_input<Eigen::VectorXd>("Target Point");
+    b.add_input<Eigen::VectorXd>("Target Point");
     b.add_output<Eigen::VectorXd>("Gradient");
 }
 
@@ -19,10 +20,7 @@ NODE_EXECUTION_FUNCTION(gradient_forward_dual)
     auto f =
         params.get_input<std::function<dual(const ArrayXdual&)>>(
         "Function");
-    Eigen::VectorXd x0(3);
-    //    Eigen::VectorXd x0 = params.get_input<Eigen::VectorXd>("Target
-    //    Point");
-    x0 << 1, 2, 3;
+    Eigen::VectorXd x0 = get_point_input(params, "Target Point", "Gradient");
     ArrayXdual x = x0.template cast<dual>();
     dual y;
     Eigen::VectorXd g;
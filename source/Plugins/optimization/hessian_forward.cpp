@@ -3,6 +3,7 @@
 #include <autodiff/forward/dual/eigen.hpp>
 
 #include "nodes/core/def/node_def.hpp"
+#include "point_input.h"
 using namespace autodiff;
 
 NODE_DEF_OPEN_SCOPE
@@ -10,7 +11,7 @@ NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(hessian_forward)
 {
     b.add_input<std::function<dual2nd(const ArrayXdual2nd&)>>("Function");
-    // b.add_input<Eigen::VectorXd>("Target Point");
+    b.add_input<Eigen::VectorXd>("Target Point");
     b.add_output<Eigen::MatrixXd>("Hessian");
 }
 
@@ -18,9 +19,7 @@ NODE_EXECUTION_FUNCTION(hessian_forward)
 {
     auto f = params.get_input<std::function<dual2nd(const ArrayXdual2nd&)>>(
         "Function");
-    Eigen::VectorXd x0(3);
-    x0 << 1, 2, 3;
-    // Eigen::VectorXd x0 = params.get_input<Eigen::VectorXd>("Target Point");
+    Eigen::VectorXd x0 = get_point_input(params, "Target Point", "Hessian");
     ArrayXdual2nd x = x0.template cast<dual2nd>();
     dual2nd y;
     Eigen::VectorXd g;
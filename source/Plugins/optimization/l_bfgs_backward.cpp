@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "nodes/core/def/node_def.hpp"
+#include "point_input.h"
 
 NODE_DEF_OPEN_SCOPE
 
@@ -12,10 +13,10 @@ using namespace autodiff;
 NODE_DECLARATION_FUNCTION(l_bfgs_backward)
 {
     b.add_input<std::function<var(const ArrayXvar&)>>("Cost function");
-    //b.add_input<Eigen::VectorXd>("Initial point");
-    //b.add_input<int>("Max iterations");
-    //b.add_input<double>("Tolerance");
-    //b.add_input<int>("Memory step size");
+    b.add_input<Eigen::VectorXd>("Initial point");
+    b.add_input<int>("Max iterations").min(1).max(1000).default_val(100);
+    b.add_input<double>("Tolerance").min(0).max(1).default_val(1e-6);
+    b.add_input<int>("Memory step size").min(1).max(50).default_val(5);
     b.add_output<Eigen::VectorXd>("Minimum point");
     b.add_output<double>("Minimum");
 }
@@ -25,15 +26,10 @@ NODE_EXECUTION_FUNCTION(l_bfgs_backward)
     auto f =
         params.get_input<std::function<var(const ArrayXvar&)>>("Cost function");
 
-    //Eigen::VectorXd x0 = params.get_input<Eigen::VectorXd>("Initial point");
-    //int max_iterations = params.get_input<int>("Max iterations");
-    //double tolerance = params.get_input<double>("Tolerance");
-    //int m = params.get_input<int>("Memory step size");
-    Eigen::VectorXd x0(3);
-    x0 << 1, 1, 1;
-    int max_iterations = 100;
-    double tolerance = 1e-6;
-    int m = 5;
+    Eigen::VectorXd x0 = get_point_input(params, "Initial point", "L-BFGS");
+    int max_iterations = params.get_input<int>("Max iterations");
+    double tolerance = params.get_input<double>("Tolerance");
+    int m = params.get_input<int>("Memory step size");
 
     VectorXvar x = x0.template cast<var>();
 
@@ -0,0 +1,111 @@
+#include <deque>
+
+#include "element_energy.h"
+#include "nodes/core/def/node_def.hpp"
+
+NODE_DEF_OPEN_SCOPE
+
+NODE_DECLARATION_FUNCTION(l_bfgs_element_energy)
+{
+    b.add_input<ElementEnergy>("Energy");
+    b.add_input<Eigen::VectorXd>("Initial point");
+    b.add_input<int>("Max iterations").min(1).max(1000).default_val(100);
+    b.add_input<double>("Tolerance").min(0).max(1).default_val(1e-6);
+    b.add_input<int>("Memory step size").min(1).max(50).default_val(5);
+    b.add_output<Eigen::VectorXd>("Minimum point");
+    b.add_output<double>("Minimum");
+}
+
+// Only the last m correction pairs are kept, so memory is O(m n) whatever the
+// number of iterations.
+NODE_EXECUTION_FUNCTION(l_bfgs_element_energy)
+{
+    auto energy = params.get_input<ElementEnergy>("Energy");
+    Eigen::VectorXd x = params.get_input<Eigen::VectorXd>("Initial point");
+    int max_iterations = params.get_input<int>("Max iterations");
+    double tolerance = params.get_input<double>("Tolerance");
+    int m = params.get_input<int>("Memory step size");
+
+    if (x.size() != energy.variable_count()) {
+        throw std::runtime_error(
+            "L-BFGS: the initial point does not match the energy.");
+    }
+
+    std::deque<Eigen::VectorXd> s;
+    std::deque<Eigen::VectorXd> y;
+    std::deque<double> rho;
+    std::vector<double> alpha;
+
+    Eigen::VectorXd g;
+    double fx = energy.gradient(x, g);
+    for (int i = 0; i < max_iterations && g.norm() >= tolerance; ++i) {
+        Eigen::VectorXd q = g;
+        alpha.resize(s.size());
+        for (int j = int(s.size()) - 1; j >= 0; --j) {
+            alpha[j] = rho[j] * s[j].dot(q);
+            q -= alpha[j] * y[j];
+        }
+        if (!s.empty()) {
+            q *= s.back().dot(y.back()) / y.back().squaredNorm();
+        }
+        for (size_t j = 0; j < s.size(); ++j) {
+            double beta = rho[j] * y[j].dot(q);
+            q += s[j] * (alpha[j] - beta);
+        }
+
+        Eigen::VectorXd p = -q;
+        if (g.dot(p) >= 0) {
+            p = -g;
+            s.clear();
+            y.clear();
+            rho.clear();
+        }
+
+        const double c1 = 1e-4;
+        double alpha_ls = 1.0;
+        double fx_new = fx;
+        Eigen::VectorXd x_new = x;
+        for (int ls_iter = 0; ls_iter < 50; ++ls_iter) {
+            x_new = x + alpha_ls * p;
+            fx_new = energy.value(x_new);
+            if (fx_new <= fx + c1 * alpha_ls * g.dot(p)) {
+                break;
+            }
+            alpha_ls *= 0.5;
+        }
+        if (!(fx_new < fx)) {
+            break;
+        }
+
+        Eigen::VectorXd g_new;
+        fx = energy.gradient(x_new, g_new);
+        Eigen::VectorXd d = x_new - x;
+        Eigen::VectorXd dg = g_new - g;
+        double curvature = d.dot(dg);
+        if (curvature > 1e-12) {
+            s.push_back(d);
+            y.push_back(dg);
+            rho.push_back(1.0 / curvature);
+            if (s.size() > size_t(m)) {
+                s.pop_front();
+                y.pop_front();
+                rho.pop_front();
+            }
+        }
+
+        x = std::move(x_new);
+        g = std::move(g_new);
+        if (d.norm() < tolerance) {
+            break;
+        }
+    }
+
+    params.set_output<Eigen::VectorXd>("Minimum point", std::move(x));
+    params.set_output<double>("Minimum", std::move(fx));
+
+    return true;
+}
+
+NODE_DECLARATION_REQUIRED(l_bfgs_element_energy);
+NODE_DECLARATION_UI(l_bfgs_element_energy);
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <utility>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/GOP.h"
+#include "element_energy.h"
+#include "nodes/core/def/node_def.hpp"
+
+using namespace autodiff;
+
+NODE_DEF_OPEN_SCOPE
+
+NODE_DECLARATION_FUNCTION(mesh_spring_energy)
+{
+    b.add_input<Geometry>("Mesh");
+    b.add_input<float>("Rest length scale").min(0.1).max(10).default_val(1);
+    b.add_input<float>("Anchor weight").min(0).max(10).default_val(0.01f);
+    b.add_output<ElementEnergy>("Energy");
+    b.add_output<Eigen::VectorXd>("Initial point");
+}
+
+// Mass spring energy over the edges of a mesh, with the 3 coordinates of each
+// vertex as variables. Every vertex is weakly pulled back to where it starts,
+// which keeps the minimum unique.
+NODE_EXECUTION_FUNCTION(mesh_spring_energy)
+{
+    auto input = params.get_input<Geometry>("Mesh");
+    auto mesh = input.get_component<MeshComponent>();
+    if (!mesh) {
+        throw std::runtime_error("Spring energy: Need a mesh.");
+    }
+    const double scale = params.get_input<float>("Rest length scale");
+    const double anchor_weight = params.get_input<float>("Anchor weight");
+
+    auto vertices = mesh->get_vertices();
+    auto face_vertex_counts = mesh->get_face_vertex_counts();
+    auto face_vertex_indices = mesh->get_face_vertex_indices();
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(face_vertex_indices.size());
+    size_t offset = 0;
+    for (int count : face_vertex_counts) {
+        for (int i = 0; i < count; ++i) {
+            int a = face_vertex_indices[offset + i];
+            int b = face_vertex_indices[offset + (i + 1) % count];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+        offset += count;
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    Eigen::VectorXd x0(vertices.size() * 3);
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        x0.segment<3>(3 * v) << vertices[v][0], vertices[v][1], vertices[v][2];
+    }
+
+    std::vector<int> spring_indices(edges.size() * 6);
+    std::vector<double> rest_lengths(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e) {
+        auto [a, b] = edges[e];
+        for (int i = 0; i < 3; ++i) {
+            spring_indices[6 * e + i] = 3 * a + i;
+            spring_indices[6 * e + 3 + i] = 3 * b + i;
+        }
+        rest_lengths[e] =
+            scale * (x0.segment<3>(3 * a) - x0.segment<3>(3 * b)).norm();
+    }
+
+    ElementEnergy energy(int(x0.size()));
+    energy.add_term(
+        6,
+        std::move(spring_indices),
+        [rest_lengths = std::move(rest_lengths)](
+            const ArrayXdual2nd& x, size_t e) {
+            dual2nd dx = x[0] - x[3];
+            dual2nd dy = x[1] - x[4];
+            dual2nd dz = x[2] - x[5];
+            dual2nd length = sqrt(dx * dx + dy * dy + dz * dz);
+            return (length - rest_lengths[e]) * (length - rest_lengths[e]);
+        });
+
+    if (anchor_weight > 0) {
+        std::vector<int> anchor_indices(x0.size());
+        for (int i = 0; i < x0.size(); ++i) {
+            anchor_indices[i] = i;
+        }
+        energy.add_term(
+            1,
+            std::move(anchor_indices),
+            [x0, anchor_weight](const ArrayXdual2nd& x, size_t i) {
+                dual2nd d = x[0] - x0[i];
+                return anchor_weight * d * d;
+            });
+    }
+
+    params.set_output("Energy", std::move(energy));
+    params.set_output<Eigen::VectorXd>("Initial point", std::move(x0));
+    return true;
+}
+
+NODE_DECLARATION_UI(mesh_spring_energy);
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,103 @@
+#include <Eigen/Sparse>
+
+#include "element_energy.h"
+#include "nodes/core/def/node_def.hpp"
+
+NODE_DEF_OPEN_SCOPE
+
+NODE_DECLARATION_FUNCTION(newton_element_energy)
+{
+    b.add_input<ElementEnergy>("Energy");
+    b.add_input<Eigen::VectorXd>("Initial point");
+    b.add_input<int>("Max iterations").min(1).max(1000).default_val(100);
+    b.add_input<double>("Tolerance").min(0).max(1).default_val(1e-6);
+    b.add_output<Eigen::VectorXd>("Minimum point");
+    b.add_output<double>("Minimum");
+}
+
+// Projected Newton: the element Hessians are made positive semi-definite
+// before assembly and the sparse system is solved with a Cholesky
+// factorization, whose symbolic analysis is done once since the pattern does
+// not change.
+NODE_EXECUTION_FUNCTION(newton_element_energy)
+{
+    auto energy = params.get_input<ElementEnergy>("Energy");
+    Eigen::VectorXd x = params.get_input<Eigen::VectorXd>("Initial point");
+    const int max_iterations = params.get_input<int>("Max iterations");
+    const double tolerance = params.get_input<double>("Tolerance");
+
+    const int n = energy.variable_count();
+    if (x.size() != n) {
+        throw std::runtime_error(
+            "Newton: the initial point does not match the energy.");
+    }
+
+    Eigen::SparseMatrix<double> identity(n, n);
+    identity.setIdentity();
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+    bool analyzed = false;
+
+    Eigen::VectorXd g;
+    Eigen::SparseMatrix<double> H;
+    double fx = energy.hessian(x, g, H, true);
+    for (int i = 0; i < max_iterations && g.norm() >= tolerance; ++i) {
+        // Directions the elements do not constrain, such as rigid motions,
+        // leave the projected Hessian singular. It is shifted until the
+        // solve gives a descent direction.
+        double min_shift =
+            1e-8 * std::max(H.diagonal().cwiseAbs().maxCoeff(), 1.0);
+        double shift = 0;
+        Eigen::VectorXd d;
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            Eigen::SparseMatrix<double> A = H + shift * identity;
+            if (!analyzed) {
+                solver.analyzePattern(A);
+                analyzed = true;
+            }
+            solver.factorize(A);
+            if (solver.info() == Eigen::Success) {
+                d = -solver.solve(g);
+                if (d.allFinite() && d.dot(g) < 0) {
+                    break;
+                }
+            }
+            d.resize(0);
+            shift = shift == 0 ? min_shift : shift * 10;
+        }
+        if (d.size() == 0) {
+            d = -g;
+        }
+
+        const double c1 = 1e-4;
+        double step = 1;
+        double fx_new = fx;
+        Eigen::VectorXd x_new = x;
+        for (int ls_iter = 0; ls_iter < 50; ++ls_iter) {
+            x_new = x + step * d;
+            fx_new = energy.value(x_new);
+            if (fx_new <= fx + c1 * step * g.dot(d)) {
+                break;
+            }
+            step *= 0.5;
+        }
+        if (!(fx_new < fx)) {
+            break;
+        }
+
+        x = std::move(x_new);
+        if (step * d.norm() < tolerance) {
+            fx = fx_new;
+            break;
+        }
+        fx = energy.hessian(x, g, H, true);
+    }
+
+    params.set_output<Eigen::VectorXd>("Minimum point", std::move(x));
+    params.set_output<double>("Minimum", std::move(fx));
+
+    return true;
+}
+
+NODE_DECLARATION_REQUIRED(newton_element_energy);
+NODE_DECLARATION_UI(newton_element_energy);
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <stdexcept>
+#include <string>
+
+#include "nodes/core/node_exec.hpp"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// The point an optimization node starts from or evaluates at. An unlinked
+// point is empty, and there is no sensible default for a function of unknown
+// dimension, so the node fails instead of guessing one.
+inline Eigen::VectorXd get_point_input(
+    const ExeParams& params,
+    const char* identifier,
+    const char* node_name)
+{
+    auto point = params.get_input<Eigen::VectorXd>(identifier);
+    if (point.size() == 0) {
+        throw std::runtime_error(
+            std::string(node_name) + ": " + identifier + " is empty.");
+    }
+    return point;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,197 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "pxr/usd/usdFoam/extentUtils.h"
+
+#include "pxr/base/work/reduce.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+// Spheres per parallel task.
+constexpr size_t _GrainSize = 1 << 15;
+
+// Spheres reduced together. The min/max loop then runs over a fixed number
+// of floats with no dependency on the axis, which compilers vectorize.
+constexpr size_t _BlockSize = 8;
+
+// The affine part of a transform, and the half extent along each axis of a
+// unit sphere after it.
+struct _Transform {
+    float m[4][3];
+    float scale[3];
+};
+
+template <bool Transformed>
+inline void
+_Load(const GfVec3f &p, const _Transform &xf, float *out)
+{
+    if constexpr (Transformed) {
+        for (int a = 0; a < 3; ++a) {
+            out[a] = p[0] * xf.m[0][a] + p[1] * xf.m[1][a] +
+                     p[2] * xf.m[2][a] + xf.m[3][a];
+        }
+    }
+    else {
+        out[0] = p[0];
+        out[1] = p[1];
+        out[2] = p[2];
+    }
+}
+
+template <bool Transformed, bool PerSphereRadius>
+GfRange3f
+_ReduceSpheres(
+    const GfVec3f *centers,
+    const float *radii,
+    float radius,
+    const _Transform &xf,
+    size_t begin,
+    size_t end)
+{
+    constexpr size_t width = 3 * _BlockSize;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    float lo[width], hi[width];
+    std::fill(lo, lo + width, inf);
+    std::fill(hi, hi + width, -inf);
+
+    auto loadSphere = [&](size_t i, float *p, float *r) {
+        _Load<Transformed>(centers[i], xf, p);
+        const float s = PerSphereRadius ? radii[i] : radius;
+        for (int a = 0; a < 3; ++a) {
+            r[a] = Transformed ? s * xf.scale[a] : s;
+        }
+    };
+
+    size_t i = begin;
+    for (; i + _BlockSize <= end; i += _BlockSize) {
+        float p[width], r[width];
+        for (size_t k = 0; k < _BlockSize; ++k) {
+            loadSphere(i + k, p + 3 * k, r + 3 * k);
+        }
+        for (size_t k = 0; k < width; ++k) {
+            lo[k] = std::min(lo[k], p[k] - r[k]);
+            hi[k] = std::max(hi[k], p[k] + r[k]);
+        }
+    }
+    for (; i < end; ++i) {
+        float p[3], r[3];
+        loadSphere(i, p, r);
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], p[a] - r[a]);
+            hi[a] = std::max(hi[a], p[a] + r[a]);
+        }
+    }
+
+    GfVec3f min(lo[0], lo[1], lo[2]);
+    GfVec3f max(hi[0], hi[1], hi[2]);
+    for (size_t k = 3; k < width; ++k) {
+        min[k % 3] = std::min(min[k % 3], lo[k]);
+        max[k % 3] = std::max(max[k % 3], hi[k]);
+    }
+    return GfRange3f(min, max);
+}
+
+template <bool Transformed, bool PerSphereRadius>
+GfRange3f
+_ComputeSphereBounds(
+    const VtVec3fArray &centers,
+    const float *radii,
+    float radius,
+    const _Transform &xf)
+{
+    return WorkParallelReduceN(
+        GfRange3f(),
+        centers.size(),
+        [&](size_t begin, size_t end, const GfRange3f &) {
+            return _ReduceSpheres<Transformed, PerSphereRadius>(
+                centers.cdata(), radii, radius, xf, begin, end);
+        },
+        [](const GfRange3f &a, const GfRange3f &b) {
+            return GfRange3f::GetUnion(a, b);
+        },
+        _GrainSize);
+}
+
+} // anonymous namespace
+
+GfRange3f
+UsdFoam_ComputeSphereBounds(
+    const VtVec3fArray &centers,
+    const VtFloatArray &radii,
+    const GfMatrix4d *transform)
+{
+    if (centers.empty()) {
+        return GfRange3f();
+    }
+
+    const bool perSphere = radii.size() == centers.size();
+    float radius = 0.0f;
+    if (!perSphere && !radii.empty()) {
+        radius = *std::max_element(radii.cbegin(), radii.cend());
+    }
+
+    _Transform xf;
+    if (transform) {
+        const GfMatrix4d &m = *transform;
+        for (int row = 0; row < 4; ++row) {
+            for (int a = 0; a < 3; ++a) {
+                xf.m[row][a] = float(m[row][a]);
+            }
+        }
+        for (int a = 0; a < 3; ++a) {
+            xf.scale[a] = float(std::sqrt(
+                m[0][a] * m[0][a] + m[1][a] * m[1][a] + m[2][a] * m[2][a]));
+        }
+    }
+
+    const float *data = perSphere ? radii.cdata() : nullptr;
+    if (transform) {
+        return perSphere
+            ? _ComputeSphereBounds<true, true>(centers, data, radius, xf)
+            : _ComputeSphereBounds<true, false>(centers, data, radius, xf);
+    }
+    return perSphere
+        ? _ComputeSphereBounds<false, true>(centers, data, radius, xf)
+        : _ComputeSphereBounds<false, false>(centers, data, radius, xf);
+}
+
+bool
+UsdFoam_RangeToExtent(const GfRange3f &range, VtVec3fArray *extent)
+{
+    if (range.IsEmpty()) {
+        return false;
+    }
+    extent->resize(2);
+    (*extent)[0] = range.GetMin();
+    (*extent)[1] = range.GetMax();
+    return true;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,54 @@
+//
+// Copyright 2016 Pixar
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+//    names, trademarks, service marks, or product names of the Licensor
+//    and its affiliates, except as required to comply with Section 4(c) of
+//    the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDFOAM_EXTENT_UTILS_H
+#define USDFOAM_EXTENT_UTILS_H
+
+/// \file usdFoam/extentUtils.h
+
+#include "pxr/pxr.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/range3f.h"
+#include "pxr/base/vt/types.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// Returns the bounds of the spheres at \p centers. \p radii may be empty,
+/// hold one radius shared by all spheres or one radius per sphere; any other
+/// count grows every sphere by the largest radius. If \p transform is given
+/// the bounds are computed in its space. Large arrays are reduced in
+/// parallel.
+GfRange3f
+UsdFoam_ComputeSphereBounds(
+    const VtVec3fArray &centers,
+    const VtFloatArray &radii,
+    const GfMatrix4d *transform);
+
+/// Writes \p range as a two element extent. Returns false if the range is
+/// empty.
+bool
+UsdFoam_RangeToExtent(const GfRange3f &range, VtVec3fArray *extent);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif
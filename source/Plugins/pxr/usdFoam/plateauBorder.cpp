@@ -27,6 +27,10 @@
 
 #include "pxr/usd/sdf/types.h"
 #include "pxr/usd/sdf/assetPath.h"
+#include "pxr/usd/usdFoam/extentUtils.h"
+#include "pxr/usd/usdGeom/boundableComputeExtent.h"
+
+#include <algorithm>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -196,3 +200,54 @@ PXR_NAMESPACE_CLOSE_SCOPE
 // 'PXR_NAMESPACE_OPEN_SCOPE', 'PXR_NAMESPACE_CLOSE_SCOPE'.
 // ===================================================================== //
 // --(BEGIN CUSTOM CODE)--
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+// Radii are given per edge. Each point is grown by the largest radius of the
+// edges meeting at it, which bounds the tubes around the edges.
+static bool
+_ComputeExtentForPlateauBorder(
+    const UsdGeomBoundable &boundable,
+    const UsdTimeCode &time,
+    const GfMatrix4d *transform,
+    VtVec3fArray *extent)
+{
+    const UsdFoamPlateauBorder border(boundable);
+    if (!TF_VERIFY(border)) {
+        return false;
+    }
+
+    VtVec3fArray points;
+    VtIntArray edgeIndices;
+    VtFloatArray radii;
+    border.GetPointsAttr().Get(&points, time);
+    border.GetEdgeIndicesAttr().Get(&edgeIndices, time);
+    border.GetRadiiAttr().Get(&radii, time);
+
+    const size_t edgeCount = edgeIndices.size() / 2;
+    if (!radii.empty() && radii.size() == edgeCount &&
+        radii.size() != points.size()) {
+        VtFloatArray pointRadii(points.size(), 0.0f);
+        for (size_t e = 0; e < edgeCount; ++e) {
+            for (size_t end = 0; end < 2; ++end) {
+                const int p = edgeIndices[2 * e + end];
+                if (p < 0 || size_t(p) >= points.size()) {
+                    continue;
+                }
+                pointRadii[p] = std::max(pointRadii[p], radii[e]);
+            }
+        }
+        radii.swap(pointRadii);
+    }
+
+    return UsdFoam_RangeToExtent(
+        UsdFoam_ComputeSphereBounds(points, radii, transform), extent);
+}
+
+TF_REGISTRY_FUNCTION(UsdGeomBoundable)
+{
+    UsdGeomRegisterComputeExtentFunction<UsdFoamPlateauBorder>(
+        _ComputeExtentForPlateauBorder);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -27,6 +27,8 @@
 
 #include "pxr/usd/sdf/types.h"
 #include "pxr/usd/sdf/assetPath.h"
+#include "pxr/usd/usdFoam/extentUtils.h"
+#include "pxr/usd/usdGeom/boundableComputeExtent.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -178,3 +180,37 @@ PXR_NAMESPACE_CLOSE_SCOPE
 // 'PXR_NAMESPACE_OPEN_SCOPE', 'PXR_NAMESPACE_CLOSE_SCOPE'.
 // ===================================================================== //
 // --(BEGIN CUSTOM CODE)--
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+static bool
+_ComputeExtentForPolygonFilm(
+    const UsdGeomBoundable &boundable,
+    const UsdTimeCode &time,
+    const GfMatrix4d *transform,
+    VtVec3fArray *extent)
+{
+    const UsdFoamPolygonFilm film(boundable);
+    if (!TF_VERIFY(film)) {
+        return false;
+    }
+
+    VtVec3fArray points, centers;
+    VtFloatArray radii;
+    film.GetPointsAttr().Get(&points, time);
+    film.GetSphereCentersAttr().Get(&centers, time);
+    film.GetSphereRadiiAttr().Get(&radii, time);
+
+    GfRange3f range =
+        UsdFoam_ComputeSphereBounds(points, VtFloatArray(), transform);
+    range.UnionWith(UsdFoam_ComputeSphereBounds(centers, radii, transform));
+    return UsdFoam_RangeToExtent(range, extent);
+}
+
+TF_REGISTRY_FUNCTION(UsdGeomBoundable)
+{
+    UsdGeomRegisterComputeExtentFunction<UsdFoamPolygonFilm>(
+        _ComputeExtentForPolygonFilm);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
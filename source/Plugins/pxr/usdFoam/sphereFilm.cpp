@@ -27,6 +27,8 @@
 
 #include "pxr/usd/sdf/types.h"
 #include "pxr/usd/sdf/assetPath.h"
+#include "pxr/usd/usdFoam/extentUtils.h"
+#include "pxr/usd/usdGeom/boundableComputeExtent.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -214,3 +216,40 @@ PXR_NAMESPACE_CLOSE_SCOPE
 // 'PXR_NAMESPACE_OPEN_SCOPE', 'PXR_NAMESPACE_CLOSE_SCOPE'.
 // ===================================================================== //
 // --(BEGIN CUSTOM CODE)--
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+static bool
+_ComputeExtentForSphereFilm(
+    const UsdGeomBoundable &boundable,
+    const UsdTimeCode &time,
+    const GfMatrix4d *transform,
+    VtVec3fArray *extent)
+{
+    const UsdFoamSphereFilm film(boundable);
+    if (!TF_VERIFY(film)) {
+        return false;
+    }
+
+    VtVec3fArray centers, points, polygonPoints;
+    VtFloatArray radii;
+    film.GetSphereCentersAttr().Get(&centers, time);
+    film.GetSphereRadiiAttr().Get(&radii, time);
+    film.GetPointsAttr().Get(&points, time);
+    film.GetPolygonPointsAttr().Get(&polygonPoints, time);
+
+    GfRange3f range = UsdFoam_ComputeSphereBounds(centers, radii, transform);
+    range.UnionWith(
+        UsdFoam_ComputeSphereBounds(points, VtFloatArray(), transform));
+    range.UnionWith(
+        UsdFoam_ComputeSphereBounds(polygonPoints, VtFloatArray(), transform));
+    return UsdFoam_RangeToExtent(range, extent);
+}
+
+TF_REGISTRY_FUNCTION(UsdGeomBoundable)
+{
+    UsdGeomRegisterComputeExtentFunction<UsdFoamSphereFilm>(
+        _ComputeExtentForSphereFilm);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -3,34 +3,67 @@ import re
 import json
 import argparse
 
-def scan_cpp_files(directories, files, pattern):
-    compiled_pattern = re.compile(pattern)
-    nodes = {}
-
+def iterate_cpp_files(directories, files):
     for directory in directories:
         for root, _, dir_files in os.walk(directory):
             for file in dir_files:
                 if file.endswith('.cpp'):
-                    file_path = os.path.join(root, file)
-                    with open(file_path, 'r', encoding = 'utf-8') as f:
-                        content = f.read()
-                        matches = compiled_pattern.findall(content)
-                        if matches:
-                            file_name_without_suffix = os.path.splitext(file)[0]
-                            nodes[file_name_without_suffix] = matches
+                    yield os.path.join(root, file)
 
     for file in files:
         if file.endswith('.cpp'):
-            with open(file, 'r', encoding = 'utf-8') as f:
-                content = f.read()
-                matches = compiled_pattern.findall(content)
-                if matches:
-                    file_name_without_suffix = os.path.splitext(os.path.basename(file))[0]
-                    nodes[file_name_without_suffix] = matches
+            yield file
+
+
+def scan_cpp_files(directories, files, pattern):
+    compiled_pattern = re.compile(pattern)
+    nodes = {}
+
+    for file_path in iterate_cpp_files(directories, files):
+        with open(file_path, 'r', encoding = 'utf-8') as f:
+            content = f.read()
+            matches = compiled_pattern.findall(content)
+            if matches:
+                file_name_without_suffix = os.path.splitext(os.path.basename(file_path))[0]
+                nodes[file_name_without_suffix] = matches
 
     return nodes
 
 
+def scan_node_manifest(directories, files):
+    # What the node system needs to register the nodes of a library without
+    # loading it: the id, ui name, required and pure flags of every node. The
+    # sockets come from the declaration, once the library is loaded.
+    manifest = {}
+
+    for file_path in iterate_cpp_files(directories, files):
+        with open(file_path, 'r', encoding = 'utf-8') as f:
+            content = re.sub(r'/\*.*?\*/|//[^\n]*', '', f.read(), flags = re.S)
+        names = re.findall(r'NODE_EXECUTION_FUNCTION\((\w+)\)', content)
+        if not names:
+            continue
+
+        entries = []
+        for name in names:
+            ui_name = re.search(
+                r'NODE_DECLARATION_UI\(' + name + r'\)\s*\{\s*return\s*"([^"]*)"', content)
+            required = re.search(
+                r'NODE_DECLARATION_REQUIRED\(' + name + r'\)', content)
+            pure = re.search(
+                r'NODE_DECLARATION_PURE\(' + name + r'\)', content)
+            entries.append({
+                'id': name,
+                'ui_name': ui_name.group(1) if ui_name else name,
+                'required': required is not None,
+                'pure': pure is not None,
+            })
+
+        file_name_without_suffix = os.path.splitext(os.path.basename(file_path))[0]
+        manifest[file_name_without_suffix] = entries
+
+    return manifest
+
+
 def main():
     parser = argparse.ArgumentParser(description='Scan cpp files for NODE_EXECUTION_FUNCTION and CONVERSION_EXECUTION_FUNCTION and generate JSON.')
     parser.add_argument('--nodes-dir', nargs='+', type=str, help='Paths to the directories containing node cpp files', default=[])
@@ -45,11 +78,13 @@ def main():
     if args.nodes_dir or args.nodes_files:
         node_pattern = r'NODE_EXECUTION_FUNCTION\((\w+)\)'
         result['nodes'] = scan_cpp_files(args.nodes_dir, args.nodes_files, node_pattern)
+        result['manifest'] = scan_node_manifest(args.nodes_dir, args.nodes_files)
     else:
         result["nodes"] = {}
+        result["manifest"] = {}
 
     if args.conversions_dir or args.conversions_files:
-        conversion_pattern = r'CONVERSION_EXECUTION_FUNCTION\((\w+),\s*(\w+)\)'
+        conversion_pattern = r'(?:CONVERSION_EXECUTION_FUNCTION|CONVERSION_DEFINITION)\((\w+),\s*(\w+)\s*[,)]'
         conversions = scan_cpp_files(args.conversions_dir, args.conversions_files, conversion_pattern)
         result['conversions'] = {k: [f"{match[0]}_to_{match[1]}" for match in v] for k, v in conversions.items()}
     else:
@@ -1,8 +1,11 @@
 #pragma once
 #include "nodes/core/def/node_def.hpp"
 #include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec2i.h"
 #include "pxr/base/gf/vec3f.h"
+#include "pxr/base/gf/vec3i.h"
 #include "pxr/base/gf/vec4f.h"
+#include "pxr/base/gf/vec4i.h"
 #include "pxr/base/vt/array.h"
 
 using float1Buffer = pxr::VtArray<float>;
@@ -13,4 +16,15 @@ using float4Buffer = pxr::VtArray<pxr::GfVec4f>;
 using int1Buffer = pxr::VtArray<int>;
 using int2Buffer = pxr::VtArray<pxr::GfVec2i>;
 using int3Buffer = pxr::VtArray<pxr::GfVec3i>;
-using int4Buffer = pxr::VtArray<pxr::GfVec4i>;
\ No newline at end of file
+using int4Buffer = pxr::VtArray<pxr::GfVec4i>;
+#include "buffer_field.h"
+
+using float1Field = USTC_CG::BufferField<float>;
+using float2Field = USTC_CG::BufferField<pxr::GfVec2f>;
+using float3Field = USTC_CG::BufferField<pxr::GfVec3f>;
+using float4Field = USTC_CG::BufferField<pxr::GfVec4f>;
+
+using int1Field = USTC_CG::BufferField<int>;
+using int2Field = USTC_CG::BufferField<pxr::GfVec2i>;
+using int3Field = USTC_CG::BufferField<pxr::GfVec3i>;
+using int4Field = USTC_CG::BufferField<pxr::GfVec4i>;
@@ -0,0 +1,234 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "USTC_CG.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/reduce.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// A buffer that is described by a kernel instead of being stored. Element-wise
+// buffer nodes hand fields to each other, so a chain of them runs as a single
+// blocked, multithreaded loop once a consumer materializes the result, and no
+// intermediate array is written.
+//
+// A field made from an array keeps the array and reads it directly. A kernel
+// runs at most once over the whole field: materializing it stores the result,
+// which every copy of the field reads from then on. Nodes that read a field
+// several times, or hand parts of it to several consumers, materialize it
+// first, so no kernel is run again for each of its readers.
+template<typename T>
+class BufferField {
+   public:
+    using value_type = T;
+    // Writes elements [begin, end) of the field to out[0, end - begin).
+    // Ranges are never longer than block_size.
+    using Kernel = std::function<void(size_t begin, size_t end, T* out)>;
+
+    // Small enough that the scratch of a nested kernel lives on the stack and
+    // stays in cache.
+    static constexpr size_t block_size = 512;
+
+    BufferField() = default;
+
+    BufferField(size_t size, Kernel kernel)
+        : size_(size),
+          kernel_(std::make_shared<const Kernel>(std::move(kernel))),
+          cache_(std::make_shared<Cache>())
+    {
+    }
+
+    explicit BufferField(pxr::VtArray<T> array)
+        : size_(array.size()),
+          array_(std::move(array))
+    {
+    }
+
+    static BufferField constant(const T& value, size_t size)
+    {
+        return BufferField(size, [value](size_t begin, size_t end, T* out) {
+            std::fill(out, out + (end - begin), value);
+        });
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    // True when reading the field does not run a kernel.
+    bool is_stored() const
+    {
+        return !kernel_ || cache_->ready.load(std::memory_order_acquire);
+    }
+
+    // Returns elements [begin, end). A stored field returns a pointer into
+    // its array, otherwise the kernel writes them to scratch.
+    const T* evaluate(size_t begin, size_t end, T* scratch) const
+    {
+        assert(end - begin <= block_size);
+        if (!kernel_) {
+            return array_.cdata() + begin;
+        }
+        if (cache_->ready.load(std::memory_order_acquire)) {
+            return cache_->array.cdata() + begin;
+        }
+        (*kernel_)(begin, end, scratch);
+        return scratch;
+    }
+
+    // Calls fn(begin, end, values) for every block of the field, blocks being
+    // processed in parallel. values is only valid during the call.
+    template<typename Fn>
+    void for_each_block(Fn&& fn) const
+    {
+        pxr::WorkParallelForN(block_count(), [&](size_t first, size_t last) {
+            T scratch[block_size];
+            for (size_t block = first; block < last; ++block) {
+                size_t begin = block * block_size;
+                size_t end = std::min(begin + block_size, size_);
+                fn(begin, end, evaluate(begin, end, scratch));
+            }
+        });
+    }
+
+    // Reduces the field block by block in parallel. fn(begin, end, values)
+    // returns the value of one block and join combines two of them.
+    template<typename V, typename Fn, typename Join>
+    V reduce(const V& identity, Fn&& fn, Join&& join) const
+    {
+        return pxr::WorkParallelReduceN(
+            identity,
+            block_count(),
+            [&](size_t first, size_t last, const V& init) {
+                T scratch[block_size];
+                V result = init;
+                for (size_t block = first; block < last; ++block) {
+                    size_t begin = block * block_size;
+                    size_t end = std::min(begin + block_size, size_);
+                    result = join(
+                        result, fn(begin, end, evaluate(begin, end, scratch)));
+                }
+                return result;
+            },
+            join);
+    }
+
+    // The elements as an array. The kernel runs the first time only, the
+    // array is shared with every copy of the field.
+    pxr::VtArray<T> materialize() const
+    {
+        if (!kernel_) {
+            return array_;
+        }
+
+        std::call_once(cache_->once, [this] {
+            // The kernels write the new storage directly, it is not filled
+            // with default values first.
+            cache_->array.resize(size_, [&](T* data, T*) {
+                pxr::WorkParallelForN(
+                    block_count(), [&](size_t first, size_t last) {
+                        for (size_t block = first; block < last; ++block) {
+                            size_t begin = block * block_size;
+                            size_t end = std::min(begin + block_size, size_);
+                            (*kernel_)(begin, end, data + begin);
+                        }
+                    });
+            });
+            cache_->ready.store(true, std::memory_order_release);
+        });
+        return cache_->array;
+    }
+
+   private:
+    struct Cache {
+        std::once_flag once;
+        std::atomic<bool> ready = false;
+        pxr::VtArray<T> array;
+    };
+
+    size_t block_count() const
+    {
+        return (size_ + block_size - 1) / block_size;
+    }
+
+    size_t size_ = 0;
+    // Shared, so that copying a field between sockets does not copy the
+    // kernels it is built from.
+    std::shared_ptr<const Kernel> kernel_;
+    std::shared_ptr<Cache> cache_;
+    pxr::VtArray<T> array_;
+};
+
+// The field of the vectors made of one field per component. It is as long as
+// its longest component, missing elements of shorter components read as zero.
+// Nothing is evaluated here, the kernel interleaves one block of every
+// component.
+template<typename Vec>
+BufferField<Vec> compose_field(
+    const std::array<BufferField<typename Vec::ScalarType>, Vec::dimension>&
+        components)
+{
+    using Scalar = typename Vec::ScalarType;
+
+    size_t size = 0;
+    for (auto& component : components) {
+        size = std::max(component.size(), size);
+    }
+
+    auto kernel = [components](size_t begin, size_t end, Vec* out) {
+        Scalar scratch[BufferField<Scalar>::block_size];
+        for (size_t i = 0; i < Vec::dimension; ++i) {
+            auto& component = components[i];
+            size_t available =
+                std::clamp(component.size(), begin, end) - begin;
+            if (available) {
+                const Scalar* values =
+                    component.evaluate(begin, begin + available, scratch);
+                for (size_t k = 0; k < available; ++k) {
+                    out[k][i] = values[k];
+                }
+            }
+            for (size_t k = available; k < end - begin; ++k) {
+                out[k][i] = 0;
+            }
+        }
+    };
+    return BufferField<Vec>(size, kernel);
+}
+
+// One field per component of a field of vectors. The components are read
+// from the materialized field, so its kernel runs once for all of them
+// instead of once per component.
+template<typename Vec>
+std::array<BufferField<typename Vec::ScalarType>, Vec::dimension>
+decompose_field(const BufferField<Vec>& field)
+{
+    using Scalar = typename Vec::ScalarType;
+
+    auto values = field.materialize();
+    std::array<BufferField<Scalar>, Vec::dimension> components;
+    for (size_t i = 0; i < Vec::dimension; ++i) {
+        auto kernel = [values, i](size_t begin, size_t end, Scalar* out) {
+            for (size_t k = begin; k < end; ++k) {
+                out[k - begin] = values[k][i];
+            }
+        };
+        components[i] = BufferField<Scalar>(values.size(), kernel);
+    }
+    return components;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
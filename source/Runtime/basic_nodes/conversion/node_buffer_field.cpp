@@ -0,0 +1,37 @@
+#include "../basic_node_base.h"
+
+// Buffers from other nodes enter the buffer nodes as stored fields, which
+// reuse the array. Fields leaving them are materialized in one parallel pass.
+USTC_CG_NAMESPACE_OPEN_SCOPE
+template<typename T>
+static BufferField<T> to_field(pxr::VtArray<T> buffer)
+{
+    return BufferField<T>(std::move(buffer));
+}
+
+template<typename T>
+static pxr::VtArray<T> to_buffer(const BufferField<T>& field)
+{
+    return field.materialize();
+}
+USTC_CG_NAMESPACE_CLOSE_SCOPE
+
+NODE_DEF_OPEN_SCOPE
+CONVERSION_DEFINITION(float1Buffer, float1Field, to_field);
+CONVERSION_DEFINITION(float1Field, float1Buffer, to_buffer);
+CONVERSION_DEFINITION(float2Buffer, float2Field, to_field);
+CONVERSION_DEFINITION(float2Field, float2Buffer, to_buffer);
+CONVERSION_DEFINITION(float3Buffer, float3Field, to_field);
+CONVERSION_DEFINITION(float3Field, float3Buffer, to_buffer);
+CONVERSION_DEFINITION(float4Buffer, float4Field, to_field);
+CONVERSION_DEFINITION(float4Field, float4Buffer, to_buffer);
+
+CONVERSION_DEFINITION(int1Buffer, int1Field, to_field);
+CONVERSION_DEFINITION(int1Field, int1Buffer, to_buffer);
+CONVERSION_DEFINITION(int2Buffer, int2Field, to_field);
+CONVERSION_DEFINITION(int2Field, int2Buffer, to_buffer);
+CONVERSION_DEFINITION(int3Buffer, int3Field, to_field);
+CONVERSION_DEFINITION(int3Field, int3Buffer, to_buffer);
+CONVERSION_DEFINITION(int4Buffer, int4Field, to_field);
+CONVERSION_DEFINITION(int4Field, int4Buffer, to_buffer);
+NODE_DEF_CLOSE_SCOPE
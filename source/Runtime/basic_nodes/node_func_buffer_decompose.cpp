@@ -1,6 +1,6 @@
 #include "basic_node_base.h"
 
-NODE_DEF_OPEN_SCOPE
+USTC_CG_NAMESPACE_OPEN_SCOPE
 static constexpr std::string socket_name(int i)
 {
     switch (i) {
@@ -12,171 +12,96 @@ static constexpr std::string socket_name(int i)
     }
 }
 
+template<typename Vec>
+static bool decompose_buffer(ExeParams& params)
+{
+    auto input = params.get_input<BufferField<Vec>>("Buffer");
+    auto components = decompose_field(input);
+    for (size_t i = 0; i < Vec::dimension; ++i) {
+        params.set_output(socket_name(i).c_str(), std::move(components[i]));
+    }
+    params.set_output("Size", int(input.size()));
+    return true;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
+
+NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(decompose_buffer2f)
 {
-    b.add_input<float2Buffer>("Buffer");
+    b.add_input<float2Field>("Buffer");
     for (int i = 0; i < 2; ++i) {
-        b.add_output<float1Buffer>(socket_name(i).c_str());
+        b.add_output<float1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 NODE_DECLARATION_FUNCTION(decompose_buffer3f)
 {
-    b.add_input<float3Buffer>("Buffer");
+    b.add_input<float3Field>("Buffer");
     for (int i = 0; i < 3; ++i) {
-        b.add_output<float1Buffer>(socket_name(i).c_str());
+        b.add_output<float1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 NODE_DECLARATION_FUNCTION(decompose_buffer4f)
 {
-    b.add_input<float4Buffer>("Buffer");
+    b.add_input<float4Field>("Buffer");
     for (int i = 0; i < 4; ++i) {
-        b.add_output<float1Buffer>(socket_name(i).c_str());
+        b.add_output<float1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 
 NODE_DECLARATION_FUNCTION(decompose_buffer2i)
 {
-    b.add_input<int2Buffer>("Buffer");
+    b.add_input<int2Field>("Buffer");
     for (int i = 0; i < 2; ++i) {
-        b.add_output<int1Buffer>(socket_name(i).c_str());
+        b.add_output<int1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 NODE_DECLARATION_FUNCTION(decompose_buffer3i)
 {
-    b.add_input<int3Buffer>("Buffer");
+    b.add_input<int3Field>("Buffer");
     for (int i = 0; i < 3; ++i) {
-        b.add_output<int1Buffer>(socket_name(i).c_str());
+        b.add_output<int1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 NODE_DECLARATION_FUNCTION(decompose_buffer4i)
 {
-    b.add_input<int4Buffer>("Buffer");
+    b.add_input<int4Field>("Buffer");
     for (int i = 0; i < 4; ++i) {
-        b.add_output<int1Buffer>(socket_name(i).c_str());
+        b.add_output<int1Field>(socket_name(i).c_str());
     }
     b.add_output<int>("Size");
 };
 
 NODE_EXECUTION_FUNCTION(decompose_buffer2f)
 {
-    pxr::VtArray<float> val[2];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec2f>>("Buffer");
-    for (int i = 0; i < 2; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 2; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 2; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec2f>(params);
 };
-;
 NODE_EXECUTION_FUNCTION(decompose_buffer3f)
 {
-    pxr::VtArray<float> val[3];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec3f>>("Buffer");
-    for (int i = 0; i < 3; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 3; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 3; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec3f>(params);
 };
-;
 NODE_EXECUTION_FUNCTION(decompose_buffer4f)
 {
-    pxr::VtArray<float> val[4];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec4f>>("Buffer");
-    for (int i = 0; i < 4; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 4; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 4; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec4f>(params);
 };
-;
 
 NODE_EXECUTION_FUNCTION(decompose_buffer2i)
 {
-    pxr::VtArray<int> val[2];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec2i>>("Buffer");
-    for (int i = 0; i < 2; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 2; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 2; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec2i>(params);
 };
-;
 NODE_EXECUTION_FUNCTION(decompose_buffer3i)
 {
-    pxr::VtArray<int> val[3];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec3i>>("Buffer");
-    for (int i = 0; i < 3; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 3; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 3; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec3i>(params);
 };
-;
 NODE_EXECUTION_FUNCTION(decompose_buffer4i)
 {
-    pxr::VtArray<int> val[4];
-    auto input = params.get_input<pxr::VtArray<pxr::GfVec4i>>("Buffer");
-    for (int i = 0; i < 4; ++i) {
-        val[i].resize(input.size());
-    }
-    for (int idx = 0; idx < input.size(); ++idx) {
-        for (int i = 0; i < 4; ++i) {
-            val[i][idx] = input[idx][i];
-        }
-    }
-    for (int i = 0; i < 4; ++i) {
-        params.set_output(socket_name(i).c_str(), val[i]);
-    }
-    params.set_output("Size", int(input.size()));
-    return true;
+    return decompose_buffer<pxr::GfVec4i>(params);
 };
-;
 
 NODE_DECLARATION_UI(buffer_decompose);
 NODE_DEF_CLOSE_SCOPE
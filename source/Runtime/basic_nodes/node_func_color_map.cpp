@@ -1,55 +1,82 @@
 #include <algorithm>
+#include <limits>
+#include <utility>
 
 #include "basic_node_base.h"
 
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(func_color_map)
 {
-    b.add_input<float1Buffer>("Vals");
+    b.add_input<float1Field>("Vals");
 
     b.add_output<float3Buffer>("Colors");
 }
 
+// The values are read twice, once for their range and once to write the
+// colors, so they are materialized first instead of running their kernel for
+// each pass.
 NODE_EXECUTION_FUNCTION(func_color_map)
 {
-    auto input = params.get_input<pxr::VtArray<float>>("Vals");
+    auto vals = params.get_input<float1Field>("Vals");
 
-    if (input.empty()) {
+    if (vals.empty()) {
         throw std::runtime_error("Func Color Map: Require input data");
     }
+    float1Field input(vals.materialize());
 
-    auto minmax = std::minmax_element(input.begin(), input.end());
-    float min = *minmax.first;
-    float max = *minmax.second;
-
-    pxr::VtArray<pxr::GfVec3f> colors(input.size());
-
-    for (size_t i = 0; i < input.size(); ++i) {
-        float normalizedValue;
-        if (input[i] <= 0) {
-            float minToZeroRange = 0 - min;
-            normalizedValue = (input[i] - min) / minToZeroRange * 0.5;
-        }
-        else {
-            float zeroToMaxRange = max - 0;
-            normalizedValue = 0.5 + (input[i] / zeroToMaxRange) * 0.5;
-        }
-
-        pxr::GfVec3f color(1 - normalizedValue, normalizedValue, 0);
-        if (normalizedValue <= 0.5) {
-            color = pxr::GfVec3f(
-                2 * (0.5 - normalizedValue),
-                1 - 2 * (0.5 - normalizedValue),
-                0);
-        }
-        else {
-            color = pxr::GfVec3f(
-                2 * (1 - normalizedValue), 2 * (normalizedValue - 0.5), 0);
-        }
-        colors[i] = color;
-    }
+    using Range = std::pair<float, float>;
+    Range range = input.reduce(
+        Range(
+            std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::lowest()),
+        [](size_t begin, size_t end, const float* values) {
+            auto minmax = std::minmax_element(values, values + (end - begin));
+            return Range(*minmax.first, *minmax.second);
+        },
+        [](const Range& a, const Range& b) {
+            return Range(
+                std::min(a.first, b.first), std::max(a.second, b.second));
+        });
+    float min = range.first;
+    float max = range.second;
+
+    pxr::VtArray<pxr::GfVec3f> colors;
+    colors.resize(input.size(), [&](pxr::GfVec3f* data, pxr::GfVec3f*) {
+        input.for_each_block(
+            [&](size_t begin, size_t end, const float* values) {
+                for (size_t i = 0; i < end - begin; ++i) {
+                    float normalizedValue;
+                    if (values[i] <= 0) {
+                        float minToZeroRange = 0 - min;
+                        normalizedValue =
+                            (values[i] - min) / minToZeroRange * 0.5;
+                    }
+                    else {
+                        float zeroToMaxRange = max - 0;
+                        normalizedValue =
+                            0.5 + (values[i] / zeroToMaxRange) * 0.5;
+                    }
+
+                    pxr::GfVec3f color;
+                    if (normalizedValue <= 0.5) {
+                        color = pxr::GfVec3f(
+                            2 * (0.5 - normalizedValue),
+                            1 - 2 * (0.5 - normalizedValue),
+                            0);
+                    }
+                    else {
+                        color = pxr::GfVec3f(
+                            2 * (1 - normalizedValue),
+                            2 * (normalizedValue - 0.5),
+                            0);
+                    }
+                    data[begin + i] = color;
+                }
+            });
+    });
 
     params.set_output("Colors", colors);
+    return true;
 }
 
 NODE_DECLARATION_UI(func_color_map);
@@ -1,6 +1,8 @@
+#include <cstring>
+
 #include "basic_node_base.h"
 
-NODE_DEF_OPEN_SCOPE
+USTC_CG_NAMESPACE_OPEN_SCOPE
 static constexpr std::string socket_name(int i)
 {
     switch (i) {
@@ -12,6 +14,27 @@ static constexpr std::string socket_name(int i)
     }
 }
 
+// A constant buffer is a field that is never stored, the value is written
+// straight into whatever array the buffer ends up in.
+template<typename T, typename Scalar>
+static bool create_buffer(ExeParams& params)
+{
+    constexpr int dimension = sizeof(T) / sizeof(Scalar);
+    Scalar val[dimension];
+    for (int i = 0; i < dimension; ++i) {
+        val[i] = params.get_input<Scalar>(socket_name(i).c_str());
+    }
+    auto s = params.get_input<int>("Size");
+    T data;
+    memcpy(&data, val, sizeof(T));
+    params.set_output(
+        "Buffer", BufferField<T>::constant(data, size_t(std::max(s, 0))));
+    return true;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
+
+NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(create_buffer1f)
 {
     for (int i = 0; i < 1; ++i) {
@@ -21,7 +44,7 @@ NODE_DECLARATION_FUNCTION(create_buffer1f)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<float1Buffer>("Buffer");
+    b.add_output<float1Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer2f)
 {
@@ -32,7 +55,7 @@ NODE_DECLARATION_FUNCTION(create_buffer2f)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<float2Buffer>("Buffer");
+    b.add_output<float2Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer3f)
 {
@@ -43,7 +66,7 @@ NODE_DECLARATION_FUNCTION(create_buffer3f)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<float3Buffer>("Buffer");
+    b.add_output<float3Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer4f)
 {
@@ -54,7 +77,7 @@ NODE_DECLARATION_FUNCTION(create_buffer4f)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<float4Buffer>("Buffer");
+    b.add_output<float4Field>("Buffer");
 };
 
 NODE_DECLARATION_FUNCTION(create_float3f)
@@ -87,7 +110,7 @@ NODE_DECLARATION_FUNCTION(create_buffer1i)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<int1Buffer>("Buffer");
+    b.add_output<int1Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer2i)
 {
@@ -98,7 +121,7 @@ NODE_DECLARATION_FUNCTION(create_buffer2i)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<int2Buffer>("Buffer");
+    b.add_output<int2Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer3i)
 {
@@ -109,7 +132,7 @@ NODE_DECLARATION_FUNCTION(create_buffer3i)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<int3Buffer>("Buffer");
+    b.add_output<int3Field>("Buffer");
 };
 NODE_DECLARATION_FUNCTION(create_buffer4i)
 {
@@ -120,80 +143,24 @@ NODE_DECLARATION_FUNCTION(create_buffer4i)
             .default_val(0);
     }
     b.add_input<int>("Size").min(1).max(200).default_val(1);
-    b.add_output<int4Buffer>("Buffer");
+    b.add_output<int4Field>("Buffer");
 };
 
-#define NodeExec(type, base_type, suffix, size)                       \
-    static void node_create_buffer##size##suffix(ExeParams params)    \
-    {                                                                 \
-        base_type val[size];                                          \
-        for (int i = 0; i < size; ++i) {                              \
-            val[i] = params.get_input<float>(socket_name(i).c_str()); \
-        }                                                             \
-        auto s = params.get_input<int>("Size");                       \
-                                                                      \
-        type data;                                                    \
-        memcpy(&data, val, sizeof(type));                             \
-                                                                      \
-        pxr::VtArray<type> arr;                                       \
-        arr.resize(s, data);                                          \
-        params.set_output("Buffer", arr);                             \
-    }
 NODE_EXECUTION_FUNCTION(create_buffer1f)
 {
-    float val[1];
-    for (int i = 0; i < 1; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    float data;
-    memcpy(&data, val, sizeof(float));
-    pxr::VtArray<float> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<float, float>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer2f)
 {
-    float val[2];
-    for (int i = 0; i < 2; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec2f data;
-    memcpy(&data, val, sizeof(pxr::GfVec2f));
-    pxr::VtArray<pxr::GfVec2f> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec2f, float>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer3f)
 {
-    float val[3];
-    for (int i = 0; i < 3; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec3f data;
-    memcpy(&data, val, sizeof(pxr::GfVec3f));
-    pxr::VtArray<pxr::GfVec3f> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec3f, float>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer4f)
 {
-    float val[4];
-    for (int i = 0; i < 4; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec4f data;
-    memcpy(&data, val, sizeof(pxr::GfVec4f));
-    pxr::VtArray<pxr::GfVec4f> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec4f, float>(params);
 };
 
 NODE_EXECUTION_FUNCTION(create_float3f)
@@ -209,7 +176,7 @@ NODE_EXECUTION_FUNCTION(create_float3f)
 };
 NODE_EXECUTION_FUNCTION(create_int3)
 {
-    float val[3];
+    int val[3];
     for (int i = 0; i < 3; ++i) {
         val[i] = params.get_input<int>(socket_name(i).c_str());
     }
@@ -221,59 +188,19 @@ NODE_EXECUTION_FUNCTION(create_int3)
 
 NODE_EXECUTION_FUNCTION(create_buffer1i)
 {
-    int val[1];
-    for (int i = 0; i < 1; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    int data;
-    memcpy(&data, val, sizeof(int));
-    pxr::VtArray<int> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<int, int>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer2i)
 {
-    int val[2];
-    for (int i = 0; i < 2; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec2i data;
-    memcpy(&data, val, sizeof(pxr::GfVec2i));
-    pxr::VtArray<pxr::GfVec2i> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec2i, int>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer3i)
 {
-    int val[3];
-    for (int i = 0; i < 3; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec3i data;
-    memcpy(&data, val, sizeof(pxr::GfVec3i));
-    pxr::VtArray<pxr::GfVec3i> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec3i, int>(params);
 };
 NODE_EXECUTION_FUNCTION(create_buffer4i)
 {
-    int val[4];
-    for (int i = 0; i < 4; ++i) {
-        val[i] = params.get_input<float>(socket_name(i).c_str());
-    }
-    auto s = params.get_input<int>("Size");
-    pxr::GfVec4i data;
-    memcpy(&data, val, sizeof(pxr::GfVec4i));
-    pxr::VtArray<pxr::GfVec4i> arr;
-    arr.resize(s, data);
-    params.set_output("Buffer", arr);
-    return true;
+    return create_buffer<pxr::GfVec4i, int>(params);
 };
 
 NODE_DECLARATION_UI(create_buffer);
@@ -1,29 +1,50 @@
 #include "basic_node_base.h"
 
 NODE_DEF_OPEN_SCOPE
-NODE_DECLARATION_FUNCTION(iteration_end)
+// The executor runs the nodes between iteration_begin and iteration_end
+// repeatedly. The values of "Iteration In" on the end are handed back to
+// "Iteration Out" of the beginning for the next iteration, until "Count"
+// iterations are done or "Converged" is true.
+NODE_DECLARATION_FUNCTION(iteration_begin)
 {
-    b.add_input<std::string>("Name").default_val("Iteration");
-    b.add_input<entt::meta_any>("iteration");
+    b.add_input<int>("Count").min(1).max(1000).default_val(10);
+    b.add_output<int>("Index");
+    b.add_input_group("Iteration In");
+    b.add_output_group("Iteration Out");
 }
 
-NODE_EXECUTION_FUNCTION(iteration_end)
+NODE_EXECUTION_FUNCTION(iteration_begin)
 {
+    auto inputs = params.get_input_group("Iteration In");
+
+    std::vector<entt::meta_any> outputs;
+    for (auto& input : inputs) {
+        outputs.push_back(*input);
+    }
+    params.set_output_group("Iteration Out", outputs);
+    params.set_output("Index", 0);
     return true;
 }
 
-NODE_DECLARATION_FUNCTION(iteration_begin)
+NODE_DECLARATION_FUNCTION(iteration_end)
 {
-    b.add_input<std::string>("Name").default_val("Iteration");
-    b.add_output<entt::meta_any>("iteration");
+    b.add_input<bool>("Converged").default_val(false);
+    b.add_input_group("Iteration In");
+    b.add_output_group("Iteration Out");
 }
 
-NODE_EXECUTION_FUNCTION(iteration_begin)
+NODE_EXECUTION_FUNCTION(iteration_end)
 {
+    auto inputs = params.get_input_group("Iteration In");
+
+    std::vector<entt::meta_any> outputs;
+    for (auto& input : inputs) {
+        outputs.push_back(std::move(*input));
+    }
+    params.set_output_group("Iteration Out", outputs);
     return true;
 }
 
-
-
-NODE_DECLARATION_UI(iteration);
+NODE_DECLARATION_UI(iteration_begin);
+NODE_DECLARATION_UI(iteration_end);
 NODE_DEF_CLOSE_SCOPE
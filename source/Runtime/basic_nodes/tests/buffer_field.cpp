@@ -0,0 +1,107 @@
+#include "../buffer_field.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "pxr/base/gf/vec3f.h"
+
+using namespace USTC_CG;
+
+using float1Field = BufferField<float>;
+using float3Field = BufferField<pxr::GfVec3f>;
+
+// 0, 1, 2, ... counting the elements the kernel writes.
+static float1Field counting_field(size_t size, std::atomic<size_t>& written)
+{
+    return float1Field(size, [&written](size_t begin, size_t end, float* out) {
+        for (size_t i = begin; i < end; ++i) {
+            out[i - begin] = float(i);
+        }
+        written += end - begin;
+    });
+}
+
+TEST(BufferField, ComposeShorterComponents)
+{
+    constexpr size_t size = 3 * float1Field::block_size + 7;
+    std::atomic<size_t> written = 0;
+
+    pxr::VtArray<float> stored(size / 2);
+    for (size_t i = 0; i < stored.size(); ++i) {
+        stored[i] = -float(i);
+    }
+
+    auto composed = compose_field<pxr::GfVec3f>(
+        { counting_field(size, written),
+          float1Field(stored),
+          float1Field::constant(2, 5) });
+    ASSERT_EQ(composed.size(), size);
+    EXPECT_EQ(written, 0);
+
+    auto values = composed.materialize();
+    ASSERT_EQ(values.size(), size);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(values[i][0], float(i));
+        EXPECT_EQ(values[i][1], i < stored.size() ? -float(i) : 0.f);
+        EXPECT_EQ(values[i][2], i < 5 ? 2.f : 0.f);
+    }
+    EXPECT_EQ(written, size);
+}
+
+TEST(BufferField, MaterializeRunsKernelOnce)
+{
+    constexpr size_t size = 2 * float1Field::block_size + 1;
+    std::atomic<size_t> written = 0;
+
+    auto field = counting_field(size, written);
+    auto copy = field;
+    EXPECT_FALSE(copy.is_stored());
+
+    auto values = field.materialize();
+    EXPECT_EQ(written, size);
+
+    // Copies share the result, reading it does not run the kernel.
+    EXPECT_TRUE(copy.is_stored());
+    auto again = copy.materialize();
+    float sum = copy.reduce(
+        0.f,
+        [](size_t begin, size_t end, const float* values) {
+            float sum = 0;
+            for (size_t i = 0; i < end - begin; ++i) {
+                sum += values[i];
+            }
+            return sum;
+        },
+        [](float a, float b) { return a + b; });
+    EXPECT_EQ(written, size);
+    EXPECT_EQ(again.cdata(), values.cdata());
+    EXPECT_EQ(sum, float(size * (size - 1) / 2));
+}
+
+TEST(BufferField, DecomposeEvaluatesInputOnce)
+{
+    constexpr size_t size = 4 * float1Field::block_size + 3;
+    std::atomic<size_t> written = 0;
+
+    auto x = counting_field(size, written);
+    auto input = compose_field<pxr::GfVec3f>(
+        { x, x, float1Field::constant(1, size) });
+
+    // Composing the components again and again only reads the input.
+    auto components = decompose_field(input);
+    auto output = compose_field<pxr::GfVec3f>(
+        { components[2], components[1], components[0] });
+    for (int depth = 0; depth < 4; ++depth) {
+        components = decompose_field(output);
+        output = compose_field<pxr::GfVec3f>(
+            { components[2], components[1], components[0] });
+    }
+
+    auto values = output.materialize();
+    ASSERT_EQ(values.size(), size);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(values[i], pxr::GfVec3f(1.f, float(i), float(i)));
+    }
+    EXPECT_EQ(written, 2 * size);
+}
@@ -185,36 +185,31 @@ void Hd_USTC_CG_Mesh::create_gpu_resources(Hd_USTC_CG_RenderParam* render_param)
         computedNormals.size() * 3);
 
     normalBuffer->write_data(computedNormals.data());
+
+    nvrhi::rt::GeometryDesc geometry_desc;
+    geometry_desc.geometryType = nvrhi::rt::GeometryType::Triangles;
+    nvrhi::rt::GeometryTriangles triangles;
+    triangles.setVertexBuffer(vertexBuffer->get_device_buffer())
+        .setVertexOffset(vertexBuffer->offset)
+        .setIndexBuffer(indexBuffer->get_device_buffer())
+        .setIndexOffset(indexBuffer->offset)
+        .setIndexCount(triangulatedIndices.size() * 3)
+        .setVertexCount(points.size())
+        .setVertexStride(3 * sizeof(float))
+        .setVertexFormat(nvrhi::Format::RGB32_FLOAT)
+        .setIndexFormat(nvrhi::Format::R32_UINT);
+    geometry_desc.setTriangles(triangles);
+
+    blas_desc = nvrhi::rt::AccelStructDesc();
+    blas_desc.addBottomLevelGeometry(geometry_desc);
+    blas_desc.isTopLevel = false;
+    blas_desc.setBuildFlags(nvrhi::rt::AccelStructBuildFlags::AllowUpdate);
     {
         std::lock_guard lock(execution_launch_mutex);
-        nvrhi::rt::AccelStructDesc blas_desc;
-        nvrhi::rt::GeometryDesc geometry_desc;
-        geometry_desc.geometryType = nvrhi::rt::GeometryType::Triangles;
-        nvrhi::rt::GeometryTriangles triangles;
-        triangles.setVertexBuffer(vertexBuffer->get_device_buffer())
-            .setVertexOffset(vertexBuffer->offset)
-            .setIndexBuffer(indexBuffer->get_device_buffer())
-            .setIndexOffset(indexBuffer->offset)
-            .setIndexCount(triangulatedIndices.size() * 3)
-            .setVertexCount(points.size())
-            .setVertexStride(3 * sizeof(float))
-            .setVertexFormat(nvrhi::Format::RGB32_FLOAT)
-            .setIndexFormat(nvrhi::Format::R32_UINT);
-        geometry_desc.setTriangles(triangles);
-        blas_desc.addBottomLevelGeometry(geometry_desc);
-        blas_desc.isTopLevel = false;
         BLAS = device->createAccelStruct(blas_desc);
-
-        auto m_CommandList = device->createCommandList();
-
-        m_CommandList->open();
-        nvrhi::utils::BuildBottomLevelAccelStruct(
-            m_CommandList, BLAS, blas_desc);
-        m_CommandList->close();
-        device->executeCommandList(m_CommandList);
-        device->waitForIdle();
-        device->runGarbageCollection();
     }
+    // Built together with the other meshes in CommitResources.
+    render_param->InstanceCollection->queue_blas_build(BLAS, blas_desc, false);
 
     MeshDesc mesh_desc;
     mesh_desc.vbOffset = vertexBuffer->index();
@@ -226,6 +221,14 @@ void Hd_USTC_CG_Mesh::create_gpu_resources(Hd_USTC_CG_RenderParam* render_param)
     mesh_desc_buffer->write_data(&mesh_desc);
 }
 
+void Hd_USTC_CG_Mesh::update_gpu_points(Hd_USTC_CG_RenderParam* render_param)
+{
+    vertexBuffer->write_data(points.data());
+    normalBuffer->write_data(computedNormals.data());
+
+    render_param->InstanceCollection->queue_blas_build(BLAS, blas_desc, true);
+}
+
 void Hd_USTC_CG_Mesh::updateTLAS(
     Hd_USTC_CG_RenderParam* render_param,
     HdSceneDelegate* sceneDelegate,
@@ -254,6 +257,7 @@ void Hd_USTC_CG_Mesh::updateTLAS(
     auto& rt_instance_pool = render_param->InstanceCollection->rt_instance_pool;
     std::vector<nvrhi::rt::InstanceDesc> instances;
     instances.resize(transforms.size());
+    std::vector<GeometryInstanceData> instance_datas(transforms.size());
 
     rt_instanceBuffer = rt_instance_pool.allocate(instances.size());
 
@@ -284,9 +288,10 @@ void Hd_USTC_CG_Mesh::updateTLAS(
         instance_data.geometryID = mesh_desc_buffer->index();
         instance_data.materialID = 0;
         memcpy(&instance_data.transform, mat.data(), sizeof(pxr::GfMatrix4f));
-        instanceBuffer->write_data(&instance_data, i);
+        instance_datas[i] = instance_data;
     }
     render_param->InstanceCollection->set_require_rebuild_tlas();
+    instanceBuffer->write_data(instance_datas.data(), 0, instance_datas.size());
     rt_instanceBuffer->write_data(instances.data());
 
     draw_indirect =
@@ -344,8 +349,9 @@ void Hd_USTC_CG_Mesh::Sync(
         HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points) ||
         HdChangeTracker::IsTopologyDirty(*dirtyBits, id);
 
+    // The instances only change with the BLAS when it is recreated.
     bool requires_rebuild_tlas =
-        requires_rebuild_blas ||
+        HdChangeTracker::IsTopologyDirty(*dirtyBits, id) ||
         HdChangeTracker::IsInstancerDirty(*dirtyBits, id) ||
         HdChangeTracker::IsTransformDirty(*dirtyBits, id) ||
         HdChangeTracker::IsVisibilityDirty(*dirtyBits, id);
@@ -399,17 +405,27 @@ void Hd_USTC_CG_Mesh::Sync(
         }
         _UpdateComputedPrimvarSources(sceneDelegate, *dirtyBits);
         if (!points.empty()) {
+            auto render_param =
+                static_cast<Hd_USTC_CG_RenderParam*>(renderParam);
             if (requires_rebuild_blas) {
-                create_gpu_resources(
-                    static_cast<Hd_USTC_CG_RenderParam*>(renderParam));
+                // A points only update with the same vertex count keeps the
+                // buffers and the BLAS.
+                bool refit =
+                    BLAS && vertexBuffer &&
+                    !HdChangeTracker::IsTopologyDirty(*dirtyBits, id) &&
+                    vertexBuffer->count() == points.size() * 3;
+                if (refit) {
+                    update_gpu_points(render_param);
+                }
+                else {
+                    create_gpu_resources(render_param);
+                    requires_rebuild_tlas = true;
+                }
             }
 
             if (requires_rebuild_tlas) {
                 if (IsVisible()) {
-                    updateTLAS(
-                        static_cast<Hd_USTC_CG_RenderParam*>(renderParam),
-                        sceneDelegate,
-                        dirtyBits);
+                    updateTLAS(render_param, sceneDelegate, dirtyBits);
                 }
             }
         }
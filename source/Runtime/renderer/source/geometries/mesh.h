@@ -80,7 +80,12 @@ class HD_USTC_CG_API Hd_USTC_CG_Mesh final : public HdMesh {
     static constexpr GLuint normalLocation = 1;
     static constexpr GLuint texcoordLocation = 2;
 
+    nvrhi::rt::AccelStructDesc blas_desc;
+
     void create_gpu_resources(Hd_USTC_CG_RenderParam* render_param);
+    // Rewrites the vertices and normals in place and refits the BLAS, for
+    // updates that keep the topology.
+    void update_gpu_points(Hd_USTC_CG_RenderParam* render_param);
     void updateTLAS(
         Hd_USTC_CG_RenderParam* render_param,
         HdSceneDelegate* sceneDelegate,
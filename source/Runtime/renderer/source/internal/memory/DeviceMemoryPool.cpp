@@ -2,4 +2,176 @@
 #include "DeviceMemoryPool.hpp"
 USTC_CG_NAMESPACE_OPEN_SCOPE
 std::mutex execution_launch_mutex;
-USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
+
+DeviceMemoryPoolBackend::DeviceMemoryPoolBackend(
+    const nvrhi::BufferDesc& desc,
+    size_t byte_size)
+    : desc(desc)
+{
+    nvrhi::IDevice* device = RHI::get_device();
+    nvrhi::CommandListParameters cmd_desc;
+    cmd_desc.enableImmediateExecution = false;
+    cmd_desc.queueType = nvrhi::CommandQueue::Copy;
+    commandList = device->createCommandList(cmd_desc);
+
+    this->desc.byteSize = byte_size;
+    device_buffer = device->createBuffer(this->desc);
+}
+
+void DeviceMemoryPoolBackend::resize(size_t old_size, size_t new_size)
+{
+    auto device = RHI::get_device();
+
+    desc.byteSize = new_size;
+    auto new_device_buffer = device->createBuffer(desc);
+
+    std::lock_guard lock(execution_launch_mutex);
+
+    commandList->open();
+    record_uploads(commandList);
+    commandList->copyBuffer(
+        new_device_buffer, 0, device_buffer, 0, std::min(old_size, new_size));
+    commandList->close();
+    device->executeCommandList(commandList, nvrhi::CommandQueue::Copy);
+
+    device_buffer = new_device_buffer;
+}
+
+void DeviceMemoryPoolBackend::write(
+    const void* data,
+    size_t size,
+    size_t offset)
+{
+    std::lock_guard lock(upload_mutex);
+
+    // A write right behind the previous one extends it.
+    auto arena_offset = upload_arena.size();
+    if (!uploads.empty() &&
+        uploads.back().offset + uploads.back().size == offset) {
+        uploads.back().size += size;
+    }
+    else {
+        uploads.push_back({ offset, size, arena_offset });
+    }
+
+    upload_arena.resize(arena_offset + size);
+    memcpy(upload_arena.data() + arena_offset, data, size);
+}
+
+void DeviceMemoryPoolBackend::record_uploads(nvrhi::ICommandList* command_list)
+{
+    std::vector<std::byte> arena;
+    std::vector<Upload> pending;
+    {
+        std::lock_guard lock(upload_mutex);
+        arena.swap(upload_arena);
+        pending.swap(uploads);
+    }
+
+    for (auto& upload : pending) {
+        command_list->writeBuffer(
+            device_buffer,
+            arena.data() + upload.arena_offset,
+            upload.size,
+            upload.offset);
+    }
+
+    // writeBuffer has copied the data, the arena keeps its capacity for the
+    // next frame.
+    arena.clear();
+    std::lock_guard lock(upload_mutex);
+    if (upload_arena.empty()) {
+        upload_arena.swap(arena);
+    }
+}
+
+void DeviceMemoryPoolBackend::flush()
+{
+    {
+        std::lock_guard lock(upload_mutex);
+        if (uploads.empty()) {
+            return;
+        }
+    }
+
+    std::lock_guard lock(execution_launch_mutex);
+
+    commandList->open();
+    record_uploads(commandList);
+    commandList->close();
+    RHI::get_device()->executeCommandList(
+        commandList, nvrhi::CommandQueue::Copy);
+}
+
+void DeviceMemoryPoolBackend::flush(nvrhi::ICommandList* command_list)
+{
+    record_uploads(command_list);
+}
+
+void DeviceMemoryPoolBackend::read(void* data, size_t size, size_t offset)
+{
+    flush();
+    auto device = RHI::get_device();
+
+    nvrhi::BufferDesc staging_desc = desc;
+    staging_desc.byteSize = size;
+    staging_desc.debugName = "StagingBuffer";
+    staging_desc.cpuAccess = nvrhi::CpuAccessMode::Read;
+    staging_desc.initialState = nvrhi::ResourceStates::CopyDest;
+    auto staging = device->createBuffer(staging_desc);
+
+    {
+        std::lock_guard lock(execution_launch_mutex);
+        commandList->open();
+        commandList->copyBuffer(staging, 0, device_buffer, offset, size);
+        commandList->close();
+        device->executeCommandList(commandList, nvrhi::CommandQueue::Copy);
+    }
+
+    auto mapped_data = device->mapBuffer(staging, nvrhi::CpuAccessMode::Read);
+    memcpy(data, mapped_data, size);
+    device->unmapBuffer(staging);
+}
+
+// A range and its destination may overlap, so the moved ranges are first
+// packed into a scratch buffer and then copied back in one submission.
+void DeviceMemoryPoolBackend::move(const std::vector<Move>& moves)
+{
+    auto device = RHI::get_device();
+
+    size_t scratch_size = 0;
+    for (auto& move : moves) {
+        scratch_size += move.size;
+    }
+
+    nvrhi::BufferDesc scratch_desc = desc;
+    scratch_desc.byteSize = scratch_size;
+    scratch_desc.debugName = "DeviceObjectPoolCompressBuffer";
+    auto scratch = device->createBuffer(scratch_desc);
+
+    std::lock_guard lock(execution_launch_mutex);
+
+    commandList->open();
+    record_uploads(commandList);
+    size_t scratch_offset = 0;
+    for (auto& move : moves) {
+        commandList->copyBuffer(
+            scratch, scratch_offset, device_buffer, move.src, move.size);
+        scratch_offset += move.size;
+    }
+    scratch_offset = 0;
+    for (auto& move : moves) {
+        commandList->copyBuffer(
+            device_buffer, move.dst, scratch, scratch_offset, move.size);
+        scratch_offset += move.size;
+    }
+    commandList->close();
+    device->executeCommandList(commandList, nvrhi::CommandQueue::Copy);
+}
+
+nvrhi::IBuffer* DeviceMemoryPoolBackend::get_device_buffer() const
+{
+    return device_buffer;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
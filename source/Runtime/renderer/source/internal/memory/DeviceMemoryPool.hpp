@@ -1,16 +1,55 @@
 #pragma once
 #include <RHI/rhi.hpp>
 #include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <unordered_map>
 
 #include "../../api.h"
+#include "MemoryPoolBackend.hpp"
+#include "OffsetAllocator.hpp"
 USTC_CG_NAMESPACE_OPEN_SCOPE
 
 HD_USTC_CG_API extern std::mutex execution_launch_mutex;
 
+// Keeps a pool in a device buffer. Writes are copied into a staging arena and
+// submitted together on flush, other operations are submitted on the copy
+// queue right away.
+class HD_USTC_CG_API DeviceMemoryPoolBackend final : public MemoryPoolBackend {
+   public:
+    DeviceMemoryPoolBackend(const nvrhi::BufferDesc& desc, size_t byte_size);
+
+    void resize(size_t old_size, size_t new_size) override;
+    void write(const void* data, size_t size, size_t offset) override;
+    void read(void* data, size_t size, size_t offset) override;
+    void move(const std::vector<Move>& moves) override;
+    void flush() override;
+    void flush(nvrhi::ICommandList* command_list) override;
+
+    nvrhi::IBuffer* get_device_buffer() const override;
+
+   private:
+    struct Upload {
+        size_t offset;
+        size_t size;
+        size_t arena_offset;
+    };
+
+    // Records the pending uploads into an open command list. The caller
+    // holds execution_launch_mutex.
+    void record_uploads(nvrhi::ICommandList* command_list);
+
+    nvrhi::BufferDesc desc;
+    nvrhi::BufferHandle device_buffer;
+    nvrhi::CommandListHandle commandList;
+
+    std::mutex upload_mutex;
+    std::vector<std::byte> upload_arena;
+    std::vector<Upload> uploads;
+};
+
 template<typename T>
 class DeviceMemoryPool {
    public:
@@ -21,6 +60,8 @@ class DeviceMemoryPool {
 
         void write_data(const void* data);
         void write_data(const void* data, size_t bias_count);
+        // Writes count elements starting at element bias_count.
+        void write_data(const void* data, size_t bias_count, size_t count);
 
         size_t index() const
         {
@@ -43,6 +84,8 @@ class DeviceMemoryPool {
        private:
         static constexpr size_t INVALID = -1;
         DeviceMemoryPool* pool;
+        OffsetAllocator::Allocation allocation;
+        size_t allocated_index = INVALID;
         friend class DeviceMemoryPool;
     };
 
@@ -52,30 +95,27 @@ class DeviceMemoryPool {
     DeviceMemoryPool();
 
     explicit DeviceMemoryPool(const nvrhi::BufferDesc& buffer_desc);
+    explicit DeviceMemoryPool(std::unique_ptr<MemoryPoolBackend> backend);
 
     DeviceMemoryPool(const DeviceMemoryPool&) = delete;
     DeviceMemoryPool(DeviceMemoryPool&& other) noexcept
     {
-        this->device_buffer = other.device_buffer;
-        this->h_free_list = other.h_free_list;
-        this->max_count = other.max_count;
-        this->targeted_max_count = other.targeted_max_count;
-        this->current_count = other.current_count;
-        this->current_max_memory_offset = other.current_max_memory_offset;
-        this->handles_allocated = other.handles_allocated;
-        this->base_desc_ = other.base_desc_;
+        *this = std::move(other);
     }
     DeviceMemoryPool& operator=(const DeviceMemoryPool&) = delete;
     DeviceMemoryPool& operator=(DeviceMemoryPool&& other) noexcept
     {
-        this->device_buffer = other.device_buffer;
-        this->h_free_list = other.h_free_list;
+        this->backend_ = std::move(other.backend_);
+        this->allocator = std::move(other.allocator);
         this->max_count = other.max_count;
         this->targeted_max_count = other.targeted_max_count;
         this->current_count = other.current_count;
-        this->current_max_memory_offset = other.current_max_memory_offset;
-        this->handles_allocated = other.handles_allocated;
+        this->handles_allocated = std::move(other.handles_allocated);
         this->base_desc_ = other.base_desc_;
+        other.handles_allocated.clear();
+        for (auto handle : handles_allocated) {
+            handle->pool = this;
+        }
         return *this;
     }
 
@@ -84,13 +124,18 @@ class DeviceMemoryPool {
     ~DeviceMemoryPool();
 
     bool compress();
+    // Submits the writes recorded since the last flush.
+    void flush();
+    void flush(nvrhi::ICommandList* command_list);
     void reserve(size_t size);
     MemoryHandle allocate(size_t count);
 
     nvrhi::IBuffer* get_device_buffer() const;
+    MemoryPoolBackend* backend() const;
     size_t max_memory_offset() const;
     size_t pool_size() const;
     size_t count() const;
+    OffsetAllocator::Statistics statistics() const;
 
     std::string info(bool free_list = true) const;
 
@@ -103,17 +148,14 @@ class DeviceMemoryPool {
     void relocate_buffer();
     void erase(MemoryHandleData* handle);
 
-    // Assume the command list (of the other one) is already opened
-    void adopt(MemoryHandleData* handle_from_another_pool);
+    // Each handle knows its position, so erasing is a swap with the last one.
     std::vector<MemoryHandleData*> handles_allocated;
 
-    nvrhi::BufferHandle device_buffer;
-    std::vector<std::pair<size_t, size_t>> h_free_list;  // offset, size
+    std::unique_ptr<MemoryPoolBackend> backend_;
+    OffsetAllocator allocator;
     size_t max_count = 1;
     size_t targeted_max_count = 1;
     size_t current_count = 0;
-    size_t current_max_memory_offset = 0;
-    nvrhi::CommandListHandle commandList;
 
     // Utility functions
 
@@ -143,15 +185,7 @@ DeviceMemoryPool<T>::MemoryHandleData::create()
 template<typename T>
 void DeviceMemoryPool<T>::MemoryHandleData::write_data(const void* data)
 {
-    std::lock_guard lock(execution_launch_mutex);
-    auto device_buffer = pool->get_device_buffer();
-
-    pool->commandList->open();
-    pool->commandList->writeBuffer(device_buffer, data, size, offset);
-
-    pool->commandList->close();
-
-    RHI::get_device()->executeCommandList(pool->commandList, nvrhi::CommandQueue::Copy);
+    pool->backend_->write(data, size, offset);
 }
 
 template<typename T>
@@ -159,16 +193,18 @@ void DeviceMemoryPool<T>::MemoryHandleData::write_data(
     const void* data,
     size_t bias_count)
 {
-    std::lock_guard lock(execution_launch_mutex);
-    auto device_buffer = pool->get_device_buffer();
-
-    pool->commandList->open();
-    pool->commandList->writeBuffer(
-        device_buffer, data, sizeof(T), offset + bias_count * sizeof(T));
-
-    pool->commandList->close();
+    write_data(data, bias_count, 1);
+}
 
-    RHI::get_device()->executeCommandList(pool->commandList, nvrhi::CommandQueue::Copy);
+template<typename T>
+void DeviceMemoryPool<T>::MemoryHandleData::write_data(
+    const void* data,
+    size_t bias_count,
+    size_t count)
+{
+    assert(bias_count + count <= this->count());
+    pool->backend_->write(
+        data, count * sizeof(T), offset + bias_count * sizeof(T));
 }
 
 template<typename T>
@@ -182,7 +218,7 @@ nvrhi::BindingSetItem DeviceMemoryPool<T>::MemoryHandleData::get_descriptor(
     nvrhi::ResourceType type) const
 {
     nvrhi::BindingSetItem item;
-    item.resourceHandle = pool->device_buffer;
+    item.resourceHandle = pool->get_device_buffer();
     item.range = nvrhi::BufferRange{
         offset,
         size,
@@ -194,44 +230,21 @@ nvrhi::BindingSetItem DeviceMemoryPool<T>::MemoryHandleData::get_descriptor(
 template<typename T>
 nvrhi::IBuffer* DeviceMemoryPool<T>::MemoryHandleData::get_device_buffer() const
 {
-    return pool->device_buffer;
+    return pool->get_device_buffer();
 }
 
 template<typename T>
 void DeviceMemoryPool<T>::MemoryHandleData::read_data(void* data)
 {
-    nvrhi::BufferDesc desc = pool->buffer_desc<T>();
-    desc.byteSize = size;
-    desc.debugName = "StagingBuffer";
-    desc.cpuAccess = nvrhi::CpuAccessMode::Read;
-    desc.initialState = nvrhi::ResourceStates::CopyDest;
-    auto staging = RHI::get_device()->createBuffer(desc);
-
-    pool->commandList->open();
-    pool->commandList->copyBuffer(staging, 0, pool->device_buffer, offset, size);
-    pool->commandList->close();
-    RHI::get_device()->executeCommandList(pool->commandList, nvrhi::CommandQueue::Copy);
-    // RHI::get_device()->waitForIdle();
-    // RHI::get_device()->runGarbageCollection();
-
-    auto mapped_data = RHI::get_device()->mapBuffer(staging, nvrhi::CpuAccessMode::Read);
-    memcpy(data, mapped_data, size);
-    RHI::get_device()->unmapBuffer(staging);
+    pool->backend_->read(data, size, offset);
 }
 
 template<typename T>
 void DeviceMemoryPool<T>::Initialize()
 {
-    nvrhi::IDevice* device = RHI::get_device();
-    nvrhi::CommandListParameters cmd_desc;
-    cmd_desc.enableImmediateExecution = false;
-    cmd_desc.queueType = nvrhi::CommandQueue::Copy;
-    commandList = device->createCommandList(cmd_desc);
-
-    // Initialize device buffer and valid mask
     nvrhi::BufferDesc bufferDesc = buffer_desc<T>();
     bufferDesc.debugName = "DeviceObjectPoolBuffer " + std::string(typeid(T).name());
-    device_buffer = device->createBuffer(bufferDesc);
+    backend_ = std::make_unique<DeviceMemoryPoolBackend>(bufferDesc, bufferDesc.byteSize);
 }
 
 template<typename T>
@@ -247,12 +260,18 @@ DeviceMemoryPool<T>::DeviceMemoryPool(const nvrhi::BufferDesc& buffer_desc)
     Initialize();
 }
 
+template<typename T>
+DeviceMemoryPool<T>::DeviceMemoryPool(std::unique_ptr<MemoryPoolBackend> backend)
+    : backend_(std::move(backend))
+{
+    backend_->resize(0, max_count * sizeof(T));
+}
+
 template<typename T>
 void DeviceMemoryPool<T>::destroy()
 {
     clear();
-    commandList = nullptr;
-    device_buffer = nullptr;
+    backend_ = nullptr;
 }
 
 template<typename T>
@@ -272,31 +291,23 @@ typename DeviceMemoryPool<T>::MemoryHandle DeviceMemoryPool<T>::allocate(size_t
 
     std::lock_guard lock(buffer_write_mutex_);
 
-    for (auto free_handle = h_free_list.begin(); free_handle != h_free_list.end();
-         ++free_handle) {
-        if (std::get<1>(*free_handle) >= size) {
-            handle->offset = std::get<0>(*free_handle);
-
-            if (std::get<1>(*free_handle) > size) {
-                std::get<0>(*free_handle) += size;
-                std::get<1>(*free_handle) -= size;
-            }
-            else {
-                h_free_list.erase(free_handle);
-            }
-            break;
-        }
+    if (size == 0) {
+        handle->offset = allocator.capacity();
     }
-
-    if (handle->offset == MemoryHandleData::INVALID) {
-        handle->offset = current_max_memory_offset;
-        current_max_memory_offset += size;
+    else {
+        // Reuse a hole first, the frontier only moves when none fits.
+        handle->allocation = allocator.allocate(size);
+        if (!handle->allocation) {
+            handle->allocation = allocator.allocate_at_end(size);
+        }
+        handle->offset = handle->allocation.offset;
     }
 
+    handle->allocated_index = handles_allocated.size();
     handles_allocated.push_back(handle.get());
     current_count += count;
 
-    while (targeted_max_count < current_max_memory_offset / sizeof(T)) {
+    while (targeted_max_count < allocator.capacity() / sizeof(T)) {
         targeted_max_count *= 2;
     }
 
@@ -310,29 +321,20 @@ void DeviceMemoryPool<T>::erase(MemoryHandleData* handle)
 {
     std::lock_guard lock(buffer_write_mutex_);
 
-    h_free_list.push_back(std::make_pair(handle->offset, handle->size));
+    if (handle->allocated_index == MemoryHandleData::INVALID) {
+        return;
+    }
+
+    if (handle->allocation) {
+        allocator.free(handle->allocation);
+    }
     current_count -= handle->size / sizeof(T);
-    handles_allocated.erase(
-        std::remove(handles_allocated.begin(), handles_allocated.end(), handle),
-        handles_allocated.end());
-}
 
-template<typename T>
-void DeviceMemoryPool<T>::adopt(MemoryHandleData* handle_from_another_pool)
-{
-    auto old_pool = handle_from_another_pool->pool;
-
-    old_pool->commandList->copyBuffer(  // Copy data from another pool
-        device_buffer,
-        current_max_memory_offset,
-        handle_from_another_pool->pool->get_device_buffer(),
-        handle_from_another_pool->offset,
-        handle_from_another_pool->size);
-
-    current_count += handle_from_another_pool->size / sizeof(T);
-    handles_allocated.push_back(handle_from_another_pool);
-    handle_from_another_pool->offset = current_max_memory_offset;
-    current_max_memory_offset += handle_from_another_pool->size;
+    auto last = handles_allocated.back();
+    last->allocated_index = handle->allocated_index;
+    handles_allocated[handle->allocated_index] = last;
+    handles_allocated.pop_back();
+    handle->allocated_index = MemoryHandleData::INVALID;
 }
 
 template<typename T>
@@ -350,38 +352,80 @@ nvrhi::BufferDesc DeviceMemoryPool<T>::buffer_desc() const
 template<typename T>
 void DeviceMemoryPool<T>::clear()
 {
-    h_free_list.clear();
+    for (auto handle : handles_allocated) {
+        handle->allocation = {};
+        handle->allocated_index = MemoryHandleData::INVALID;
+    }
+    handles_allocated.clear();
+    allocator.reset();
     current_count = 0;
-    current_max_memory_offset = 0;
 }
 
+// Slides every handle after the first hole towards the front. Handles before
+// it keep their place, so nothing is copied for a pool without holes.
 template<typename T>
 bool DeviceMemoryPool<T>::compress()
 {
-    if (h_free_list.empty()) {
+    std::lock_guard lock(buffer_write_mutex_);
+
+    if (allocator.statistics().free_block_count == 0) {
         return false;
     }
 
-    // Create another DeviceMemoryPool and copy into it...
-    DeviceMemoryPool<T> new_pool(this->base_desc_);
-    new_pool.reserve(max_count);
+    std::sort(
+        handles_allocated.begin(),
+        handles_allocated.end(),
+        [](MemoryHandleData* a, MemoryHandleData* b) { return a->offset < b->offset; });
 
-    commandList->open();
-    for (auto handle : handles_allocated) {
-        new_pool.adopt(handle);
-    }
-    commandList->close();
-    auto device = RHI::get_device();
+    std::vector<MemoryPoolBackend::Move> moves;
+    allocator.reset();
+    for (size_t i = 0; i < handles_allocated.size(); ++i) {
+        auto handle = handles_allocated[i];
+        handle->allocated_index = i;
+
+        auto offset = allocator.capacity();
+        if (handle->size == 0) {
+            handle->offset = offset;
+            handle->allocation = {};
+            continue;
+        }
 
-    std::lock_guard lock(execution_launch_mutex);
-    device->executeCommandList(commandList, nvrhi::CommandQueue::Copy);
-    // device->waitForIdle();
-    // device->runGarbageCollection();
+        if (handle->offset != offset) {
+            // Neighbours that move by the same distance are copied together.
+            if (!moves.empty() && moves.back().src + moves.back().size == handle->offset &&
+                moves.back().dst + moves.back().size == offset) {
+                moves.back().size += handle->size;
+            }
+            else {
+                moves.push_back({ handle->offset, offset, handle->size });
+            }
+            handle->offset = offset;
+        }
+        handle->allocation = allocator.allocate_at_end(handle->size);
+    }
 
-    *this = std::move(new_pool);
+    if (!moves.empty()) {
+        backend_->move(moves);
+    }
     return true;
 }
 
+template<typename T>
+void DeviceMemoryPool<T>::flush()
+{
+    if (backend_) {
+        backend_->flush();
+    }
+}
+
+template<typename T>
+void DeviceMemoryPool<T>::flush(nvrhi::ICommandList* command_list)
+{
+    if (backend_) {
+        backend_->flush(command_list);
+    }
+}
+
 template<typename T>
 std::string DeviceMemoryPool<T>::info(bool free_list) const
 {
@@ -389,14 +433,14 @@ std::string DeviceMemoryPool<T>::info(bool free_list) const
 
     ss << "[size]: " << current_count << std::endl;
     ss << "[max size]: " << max_count << std::endl;
-    ss << "[max memory offset]: " << current_max_memory_offset << std::endl;
+    ss << "[max memory offset]: " << allocator.capacity() << std::endl;
 
     if (free_list) {
-        ss << "[Free list]: " << std::endl;
-        for (int i = 0; i < h_free_list.size(); ++i) {
-            ss << "  " << i << ": " << h_free_list[i].first / sizeof(T) << " - "
-               << (h_free_list[i].first + h_free_list[i].second) / sizeof(T) << std::endl;
-        }
+        auto statistics = allocator.statistics();
+        ss << "[Free blocks]: " << statistics.free_block_count << std::endl;
+        ss << "[Free size]: " << statistics.free_size / sizeof(T) << std::endl;
+        ss << "[Largest free block]: " << statistics.largest_free_block / sizeof(T)
+           << std::endl;
     }
     return ss.str();
 }
@@ -410,6 +454,10 @@ bool DeviceMemoryPool<T>::sanitize()
         handles_allocated.end(),
         [](MemoryHandleData* a, MemoryHandleData* b) { return a->offset < b->offset; });
 
+    for (size_t i = 0; i < handles_allocated.size(); ++i) {
+        handles_allocated[i]->allocated_index = i;
+    }
+
     for (auto handle : handles_allocated) {
         if (handle->offset != current_offset) {
             return false;
@@ -422,13 +470,19 @@ bool DeviceMemoryPool<T>::sanitize()
 template<typename T>
 nvrhi::IBuffer* DeviceMemoryPool<T>::get_device_buffer() const
 {
-    return device_buffer;
+    return backend_->get_device_buffer();
+}
+
+template<typename T>
+MemoryPoolBackend* DeviceMemoryPool<T>::backend() const
+{
+    return backend_.get();
 }
 
 template<typename T>
 size_t DeviceMemoryPool<T>::max_memory_offset() const
 {
-    return current_max_memory_offset;
+    return allocator.capacity();
 }
 
 template<typename T>
@@ -443,30 +497,19 @@ size_t DeviceMemoryPool<T>::count() const
     return current_count;
 }
 
+template<typename T>
+OffsetAllocator::Statistics DeviceMemoryPool<T>::statistics() const
+{
+    return allocator.statistics();
+}
+
 template<typename T>
 void DeviceMemoryPool<T>::relocate_buffer()
 {
     if (max_count != targeted_max_count) {
-        nvrhi::BufferDesc bufferDesc = buffer_desc<T>();
-        bufferDesc.byteSize = targeted_max_count * sizeof(T);
-        bufferDesc.debugName = "DeviceObjectPoolBuffer";
-        auto new_device_buffer = RHI::get_device()->createBuffer(bufferDesc);
-
-        std::lock_guard lock(execution_launch_mutex);
-
-        commandList->open();
-        commandList->copyBuffer(
-            new_device_buffer, 0, device_buffer, 0, max_count * sizeof(T));
-
-        commandList->close();
-        RHI::get_device()->executeCommandList(commandList, nvrhi::CommandQueue::Copy);
-        // RHI::get_device()->waitForIdle();
-        // RHI::get_device()->runGarbageCollection();
-
+        backend_->resize(max_count * sizeof(T), targeted_max_count * sizeof(T));
         max_count = targeted_max_count;
-
-        device_buffer = new_device_buffer;
     }
 }
 
-USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
+USTC_CG_NAMESPACE_CLOSE_SCOPE
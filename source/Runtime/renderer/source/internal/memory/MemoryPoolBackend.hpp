@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "../../api.h"
+
+namespace nvrhi {
+class IBuffer;
+class ICommandList;
+}
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// The storage a DeviceMemoryPool sub-allocates from. Offsets and sizes are in
+// bytes.
+class MemoryPoolBackend {
+   public:
+    struct Move {
+        size_t src;
+        size_t dst;
+        size_t size;
+    };
+
+    virtual ~MemoryPoolBackend() = default;
+
+    // Grows the storage, keeping the first old_size bytes.
+    virtual void resize(size_t old_size, size_t new_size) = 0;
+    virtual void write(const void* data, size_t size, size_t offset) = 0;
+    virtual void read(void* data, size_t size, size_t offset) = 0;
+
+    // Moves ranges towards the front. They are sorted by destination, and no
+    // range moves to a higher offset.
+    virtual void move(const std::vector<Move>& moves) = 0;
+
+    // Writes may be recorded and only submitted here. Reads, resizes and
+    // moves see every write made before them.
+    virtual void flush()
+    {
+    }
+
+    // Records the pending writes into an open command list, so that they are
+    // submitted together with the work that reads them.
+    virtual void flush(nvrhi::ICommandList* command_list)
+    {
+        flush();
+    }
+
+    virtual nvrhi::IBuffer* get_device_buffer() const
+    {
+        return nullptr;
+    }
+};
+
+// Keeps the pool in host memory, so that the allocation behaviour can be
+// tested and measured without a device.
+class HostMemoryPoolBackend final : public MemoryPoolBackend {
+   public:
+    void resize(size_t old_size, size_t new_size) override
+    {
+        memory.resize(new_size);
+    }
+
+    void write(const void* data, size_t size, size_t offset) override
+    {
+        std::memcpy(memory.data() + offset, data, size);
+    }
+
+    void read(void* data, size_t size, size_t offset) override
+    {
+        std::memcpy(data, memory.data() + offset, size);
+    }
+
+    void move(const std::vector<Move>& moves) override
+    {
+        for (auto& move : moves) {
+            std::memmove(
+                memory.data() + move.dst, memory.data() + move.src, move.size);
+        }
+    }
+
+    const std::byte* data() const
+    {
+        return memory.data();
+    }
+
+   private:
+    std::vector<std::byte> memory;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,285 @@
+#include "OffsetAllocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+OffsetAllocator::OffsetAllocator(size_t capacity)
+{
+    reset(capacity);
+}
+
+void OffsetAllocator::reset(size_t capacity)
+{
+    nodes.clear();
+    released_nodes.clear();
+    fl_bitmap = 0;
+    sl_bitmap.fill(0);
+    bin_heads.fill(INVALID_NODE);
+
+    last_node = INVALID_NODE;
+    capacity_ = 0;
+    free_size = 0;
+    free_block_count = 0;
+    allocation_count = 0;
+
+    if (capacity > 0) {
+        last_node = create_node(0, capacity);
+        capacity_ = capacity;
+        insert_free(last_node);
+    }
+}
+
+// Sizes below SL_COUNT get a bin each. Above, every power of two range is
+// split into SL_COUNT bins of equal width.
+uint32_t OffsetAllocator::bin_of(size_t size)
+{
+    if (size < SL_COUNT) {
+        return uint32_t(size);
+    }
+    uint32_t msb = 63 - std::countl_zero(uint64_t(size));
+    uint32_t fl = msb - SL_BITS + 1;
+    uint32_t sl = uint32_t(size >> (msb - SL_BITS)) & (SL_COUNT - 1);
+    return fl * SL_COUNT + sl;
+}
+
+// The first bin whose blocks are all at least size large.
+uint32_t OffsetAllocator::bin_fitting(size_t size)
+{
+    if (size >= SL_COUNT) {
+        uint32_t msb = 63 - std::countl_zero(uint64_t(size));
+        size_t round = (size_t(1) << (msb - SL_BITS)) - 1;
+        if (size + round > size) {
+            size += round;
+        }
+    }
+    return bin_of(size);
+}
+
+OffsetAllocator::NodeIndex OffsetAllocator::create_node(
+    size_t offset,
+    size_t size)
+{
+    NodeIndex index;
+    if (!released_nodes.empty()) {
+        index = released_nodes.back();
+        released_nodes.pop_back();
+        nodes[index] = Node{};
+    }
+    else {
+        index = NodeIndex(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[index].offset = offset;
+    nodes[index].size = size;
+    return index;
+}
+
+void OffsetAllocator::release_node(NodeIndex node)
+{
+    released_nodes.push_back(node);
+}
+
+void OffsetAllocator::insert_free(NodeIndex node)
+{
+    auto bin = bin_of(nodes[node].size);
+    auto fl = bin / SL_COUNT;
+    auto sl = bin % SL_COUNT;
+
+    auto head = bin_heads[bin];
+    nodes[node].bin_prev = INVALID_NODE;
+    nodes[node].bin_next = head;
+    if (head != INVALID_NODE) {
+        nodes[head].bin_prev = node;
+    }
+    bin_heads[bin] = node;
+
+    fl_bitmap |= uint64_t(1) << fl;
+    sl_bitmap[fl] |= uint8_t(1 << sl);
+
+    free_size += nodes[node].size;
+    ++free_block_count;
+}
+
+void OffsetAllocator::remove_free(NodeIndex node)
+{
+    auto bin = bin_of(nodes[node].size);
+    auto fl = bin / SL_COUNT;
+    auto sl = bin % SL_COUNT;
+
+    auto prev = nodes[node].bin_prev;
+    auto next = nodes[node].bin_next;
+    if (prev != INVALID_NODE) {
+        nodes[prev].bin_next = next;
+    }
+    else {
+        bin_heads[bin] = next;
+    }
+    if (next != INVALID_NODE) {
+        nodes[next].bin_prev = prev;
+    }
+
+    if (bin_heads[bin] == INVALID_NODE) {
+        sl_bitmap[fl] &= uint8_t(~(1 << sl));
+        if (!sl_bitmap[fl]) {
+            fl_bitmap &= ~(uint64_t(1) << fl);
+        }
+    }
+
+    free_size -= nodes[node].size;
+    --free_block_count;
+}
+
+OffsetAllocator::NodeIndex OffsetAllocator::find_free(size_t size)
+{
+    auto bin = bin_fitting(size);
+    auto fl = bin / SL_COUNT;
+    auto sl = bin % SL_COUNT;
+
+    if (fl < FL_COUNT) {
+        uint32_t sl_map = sl_bitmap[fl] & (~0u << sl);
+        if (!sl_map && fl + 1 < 64) {
+            uint64_t fl_map = fl_bitmap & (~uint64_t(0) << (fl + 1));
+            if (fl_map) {
+                fl = std::countr_zero(fl_map);
+                sl_map = sl_bitmap[fl];
+            }
+        }
+        if (sl_map) {
+            auto node = bin_heads[fl * SL_COUNT + std::countr_zero(sl_map)];
+            remove_free(node);
+            return node;
+        }
+    }
+
+    // The bin of the size itself mixes smaller and larger blocks, its head
+    // is the only one checked to stay O(1).
+    auto node = bin_heads[bin_of(size)];
+    if (node != INVALID_NODE && nodes[node].size >= size) {
+        remove_free(node);
+        return node;
+    }
+    return INVALID_NODE;
+}
+
+OffsetAllocator::Allocation OffsetAllocator::allocate(size_t size)
+{
+    assert(size > 0);
+
+    auto node = find_free(size);
+    if (node == INVALID_NODE) {
+        return {};
+    }
+
+    if (nodes[node].size > size) {
+        auto remainder =
+            create_node(nodes[node].offset + size, nodes[node].size - size);
+        nodes[node].size = size;
+
+        auto next = nodes[node].neighbor_next;
+        nodes[remainder].neighbor_prev = node;
+        nodes[remainder].neighbor_next = next;
+        if (next != INVALID_NODE) {
+            nodes[next].neighbor_prev = remainder;
+        }
+        else {
+            last_node = remainder;
+        }
+        nodes[node].neighbor_next = remainder;
+        insert_free(remainder);
+    }
+
+    nodes[node].used = true;
+    ++allocation_count;
+    return { nodes[node].offset, node };
+}
+
+OffsetAllocator::Allocation OffsetAllocator::allocate_at_end(size_t size)
+{
+    assert(size > 0);
+
+    auto node = create_node(capacity_, size);
+    nodes[node].used = true;
+    nodes[node].neighbor_prev = last_node;
+    if (last_node != INVALID_NODE) {
+        nodes[last_node].neighbor_next = node;
+    }
+    last_node = node;
+    capacity_ += size;
+
+    ++allocation_count;
+    return { nodes[node].offset, node };
+}
+
+void OffsetAllocator::free(Allocation allocation)
+{
+    auto node = allocation.node;
+    assert(node < nodes.size() && nodes[node].used);
+
+    nodes[node].used = false;
+    --allocation_count;
+
+    // Removes merged from the neighbour chain, its range now belongs to the
+    // block before it.
+    auto unlink = [this](NodeIndex merged) {
+        auto prev = nodes[merged].neighbor_prev;
+        auto next = nodes[merged].neighbor_next;
+        nodes[prev].neighbor_next = next;
+        if (next != INVALID_NODE) {
+            nodes[next].neighbor_prev = prev;
+        }
+        else {
+            last_node = prev;
+        }
+        release_node(merged);
+    };
+
+    auto prev = nodes[node].neighbor_prev;
+    if (prev != INVALID_NODE && !nodes[prev].used) {
+        remove_free(prev);
+        nodes[prev].size += nodes[node].size;
+        unlink(node);
+        node = prev;
+    }
+
+    auto next = nodes[node].neighbor_next;
+    if (next != INVALID_NODE && !nodes[next].used) {
+        remove_free(next);
+        nodes[node].size += nodes[next].size;
+        unlink(next);
+    }
+
+    insert_free(node);
+}
+
+size_t OffsetAllocator::allocation_size(Allocation allocation) const
+{
+    if (!allocation) {
+        return 0;
+    }
+    return nodes[allocation.node].size;
+}
+
+OffsetAllocator::Statistics OffsetAllocator::statistics() const
+{
+    Statistics statistics;
+    statistics.capacity = capacity_;
+    statistics.free_size = free_size;
+    statistics.free_block_count = free_block_count;
+    statistics.allocation_count = allocation_count;
+
+    if (fl_bitmap) {
+        auto fl = 63 - std::countl_zero(fl_bitmap);
+        auto sl = 7 - std::countl_zero(sl_bitmap[fl]);
+        for (auto node = bin_heads[fl * SL_COUNT + sl]; node != INVALID_NODE;
+             node = nodes[node].bin_next) {
+            statistics.largest_free_block =
+                std::max(statistics.largest_free_block, nodes[node].size);
+        }
+    }
+    return statistics;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../api.h"
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Two level segregated fit (TLSF) allocator over a range of offsets. It only
+// does the bookkeeping, the memory itself is owned by a MemoryPoolBackend.
+// Allocation and free are O(1), and freed blocks are merged with their free
+// neighbours immediately.
+class HD_USTC_CG_API OffsetAllocator {
+   public:
+    using NodeIndex = uint32_t;
+    static constexpr NodeIndex INVALID_NODE = ~NodeIndex(0);
+    static constexpr size_t INVALID_OFFSET = ~size_t(0);
+
+    struct Allocation {
+        size_t offset = INVALID_OFFSET;
+        NodeIndex node = INVALID_NODE;
+
+        explicit operator bool() const
+        {
+            return node != INVALID_NODE;
+        }
+    };
+
+    struct Statistics {
+        size_t capacity = 0;
+        size_t free_size = 0;
+        size_t largest_free_block = 0;
+        size_t free_block_count = 0;
+        size_t allocation_count = 0;
+    };
+
+    explicit OffsetAllocator(size_t capacity = 0);
+
+    // Returns an invalid allocation when no free block is large enough.
+    Allocation allocate(size_t size);
+
+    // Extends the range by size and allocates the added part. The extension
+    // is not merged with a free block at the old end, so it always lands
+    // there.
+    Allocation allocate_at_end(size_t size);
+
+    void free(Allocation allocation);
+
+    void reset(size_t capacity = 0);
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    size_t allocation_size(Allocation allocation) const;
+    Statistics statistics() const;
+
+   private:
+    static constexpr uint32_t SL_BITS = 3;
+    static constexpr uint32_t SL_COUNT = 1 << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 64 - SL_BITS + 1;
+
+    struct Node {
+        size_t offset = 0;
+        size_t size = 0;
+        NodeIndex bin_prev = INVALID_NODE;
+        NodeIndex bin_next = INVALID_NODE;
+        NodeIndex neighbor_prev = INVALID_NODE;
+        NodeIndex neighbor_next = INVALID_NODE;
+        bool used = false;
+    };
+
+    static uint32_t bin_of(size_t size);
+    static uint32_t bin_fitting(size_t size);
+
+    NodeIndex find_free(size_t size);
+    void insert_free(NodeIndex node);
+    void remove_free(NodeIndex node);
+
+    NodeIndex create_node(size_t offset, size_t size);
+    void release_node(NodeIndex node);
+
+    std::vector<Node> nodes;
+    std::vector<NodeIndex> released_nodes;
+
+    uint64_t fl_bitmap = 0;
+    std::array<uint8_t, FL_COUNT> sl_bitmap = {};
+    std::array<NodeIndex, FL_COUNT * SL_COUNT> bin_heads;
+
+    NodeIndex last_node = INVALID_NODE;
+    size_t capacity_ = 0;
+    size_t free_size = 0;
+    size_t free_block_count = 0;
+    size_t allocation_count = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
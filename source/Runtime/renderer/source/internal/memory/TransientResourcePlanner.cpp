@@ -0,0 +1,80 @@
+#include "TransientResourcePlanner.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+TransientResourcePlan TransientResourcePlanner::plan(
+    const std::vector<TransientResource>& resources)
+{
+    TransientResourcePlan plan;
+    plan.slots.resize(resources.size());
+
+    std::vector<size_t> order(resources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&resources](size_t a, size_t b) {
+        if (resources[a].first != resources[b].first) {
+            return resources[a].first < resources[b].first;
+        }
+        return resources[a].last < resources[b].last;
+    });
+
+    // Per key, the slots ordered by the position after which they are free.
+    using FreeSlot = std::pair<size_t, size_t>;
+    using FreeSlots = std::priority_queue<
+        FreeSlot,
+        std::vector<FreeSlot>,
+        std::greater<FreeSlot>>;
+    std::unordered_map<size_t, FreeSlots> free_slots;
+
+    for (auto i : order) {
+        auto& resource = resources[i];
+        auto& slots = free_slots[resource.compatibility_key];
+
+        size_t slot;
+        // The last consumer still reads the old resource while the producer
+        // at the same position writes the new one, so lifetimes touching at
+        // one position overlap.
+        if (!slots.empty() && slots.top().first < resource.first) {
+            slot = slots.top().second;
+            slots.pop();
+            plan.slot_sizes[slot] =
+                std::max(plan.slot_sizes[slot], resource.size);
+        }
+        else {
+            slot = plan.slot_sizes.size();
+            plan.slot_sizes.push_back(resource.size);
+        }
+        slots.emplace(resource.last, slot);
+        plan.slots[i] = slot;
+
+        plan.unaliased_memory += resource.size;
+    }
+
+    plan.aliased_memory =
+        std::accumulate(plan.slot_sizes.begin(), plan.slot_sizes.end(), size_t(0));
+
+    // Sweep over the lifetimes, a resource is released after its last use.
+    std::vector<std::pair<size_t, ptrdiff_t>> events;
+    events.reserve(resources.size() * 2);
+    for (auto& resource : resources) {
+        events.emplace_back(resource.first, ptrdiff_t(resource.size));
+        events.emplace_back(resource.last + 1, -ptrdiff_t(resource.size));
+    }
+    std::sort(events.begin(), events.end());
+
+    ptrdiff_t live = 0;
+    for (auto& [position, delta] : events) {
+        live += delta;
+        plan.peak_memory = std::max(plan.peak_memory, size_t(live));
+    }
+
+    return plan;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "../../api.h"
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// A resource that only lives while the render graph executes. first and last
+// are the positions of the node producing it and of its last consumer in the
+// execution order, both inclusive.
+struct TransientResource {
+    size_t first = 0;
+    size_t last = 0;
+    size_t size = 0;
+    // Only resources with equal keys may share a slot.
+    size_t compatibility_key = 0;
+};
+
+struct TransientResourcePlan {
+    // The slot of each resource, in the order they were given.
+    std::vector<size_t> slots;
+    std::vector<size_t> slot_sizes;
+
+    // The largest set of resources alive at the same time.
+    size_t peak_memory = 0;
+    // Memory held by the slots, at least peak_memory.
+    size_t aliased_memory = 0;
+    // Memory held when every resource has its own allocation.
+    size_t unaliased_memory = 0;
+};
+
+// Assigns resources with disjoint lifetimes to shared slots. Within one
+// compatibility key this is interval partitioning, so the number of slots
+// equals the largest number of resources of that key alive at once.
+class HD_USTC_CG_API TransientResourcePlanner {
+   public:
+    static TransientResourcePlan plan(
+        const std::vector<TransientResource>& resources);
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
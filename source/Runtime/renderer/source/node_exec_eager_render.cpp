@@ -1,7 +1,10 @@
 #include "node_exec_eager_render.hpp"
 
+#include <optional>
 #include <set>
+#include <unordered_map>
 
+#include "Logger/Logger.h"
 #include "hd_USTC_CG/render_global_payload.hpp"
 #include "nodes/core/node_exec.hpp"
 #include "nodes/core/node_exec_eager.hpp"
@@ -10,12 +13,15 @@ USTC_CG_NAMESPACE_OPEN_SCOPE
 
 bool EagerNodeTreeExecutorRender::execute_node(NodeTree* tree, Node* node)
 {
+    hand_over_slots(node);
     if (EagerNodeTreeExecutor::execute_node(tree, node)) {
+        record_transient_outputs(node);
         for (auto&& input : node->get_inputs()) {
             auto& input_state = input_states[index_cache[input]];
             if (!node->typeinfo->ALWAYS_REQUIRED && input_state.is_last_used) {
-                if (input_state.value && !input_state.keep_alive)
-                    resource_allocator().destroy(input_state.value);
+                if (input_state.value && !input_state.keep_alive &&
+                    !keep_in_slot(input, input_state.value))
+                    release(input_state.value);
                 input_state.is_last_used = false;
             }
         }
@@ -24,13 +30,20 @@ bool EagerNodeTreeExecutorRender::execute_node(NodeTree* tree, Node* node)
     for (auto&& output : node->get_outputs()) {
         {
             if (output_states[index_cache[output]].value)
-                resource_allocator().destroy(
-                    output_states[index_cache[output]].value);
+                release(output_states[index_cache[output]].value);
         }
     }
     return false;
 }
 
+// The allocator takes a copy of the handle, the slot lets go of its own so a
+// cached resource is only referenced by the cache, which can then free it.
+void EagerNodeTreeExecutorRender::release(entt::meta_any& value)
+{
+    resource_allocator().destroy(value);
+    value.reset();
+}
+
 void EagerNodeTreeExecutorRender::try_storage()
 {
     for (auto&& value : storage) {
@@ -46,18 +59,232 @@ void EagerNodeTreeExecutorRender::remove_storage(
     EagerNodeTreeExecutor::remove_storage(key);
 }
 
+void EagerNodeTreeExecutorRender::prepare_tree(
+    NodeTree* tree,
+    Node* required_node)
+{
+    EagerNodeTreeExecutor::prepare_tree(tree, required_node);
+    if (compile_count() != planned_compilation) {
+        compute_output_lifetimes();
+        planned_compilation = compile_count();
+    }
+    plan_transient_resources();
+}
+
+void EagerNodeTreeExecutorRender::compute_output_lifetimes()
+{
+    std::unordered_map<Node*, size_t> positions;
+    for (ptrdiff_t i = 0; i < nodes_to_execute_count; ++i) {
+        positions[nodes_to_execute[i]] = i;
+    }
+
+    output_lifetimes.assign(output_states.size(), {});
+    output_is_transient.assign(output_states.size(), false);
+    recorded_descs.assign(output_states.size(), std::nullopt);
+
+    for (size_t i = 0; i < output_of_nodes_to_execute.size(); ++i) {
+        auto socket = output_of_nodes_to_execute[i];
+        auto producer = positions.find(socket->node);
+        if (producer == positions.end()) {
+            continue;
+        }
+
+        TransientResource lifetime;
+        lifetime.first = lifetime.last = producer->second;
+        // An output nothing reads is only released by finalize.
+        if (socket->directly_linked_sockets.empty()) {
+            lifetime.last = nodes_to_execute_count - 1;
+        }
+        bool transient = true;
+        for (auto linked : socket->directly_linked_sockets) {
+            auto consumer = linked->node;
+            if (consumer->typeinfo->ALWAYS_REQUIRED ||
+                std::string(consumer->typeinfo->id_name) == "func_storage_in") {
+                transient = false;
+            }
+            auto position = positions.find(consumer);
+            if (position != positions.end()) {
+                lifetime.last = std::max(lifetime.last, position->second);
+            }
+        }
+
+        // Nodes in an iteration zone run several times, their outputs live
+        // across iterations.
+        for (auto& zone : iteration_zones) {
+            if (zone.begin <= ptrdiff_t(lifetime.first) &&
+                ptrdiff_t(lifetime.first) <= zone.end) {
+                transient = false;
+            }
+        }
+
+        output_lifetimes[i] = lifetime;
+        output_is_transient[i] = transient;
+    }
+}
+
+// Transient outputs are planned from the descriptors their textures had in
+// the last execution, so the first execution after a compilation allocates
+// them as the nodes ask.
+void EagerNodeTreeExecutorRender::plan_transient_resources()
+{
+    release_slots();
+
+    std::unordered_map<nvrhi::TextureDesc, size_t> descriptor_keys;
+    std::vector<TransientResource> resources;
+    std::vector<size_t> outputs;
+    for (size_t i = 0; i < recorded_descs.size(); ++i) {
+        if (!output_is_transient[i] || !recorded_descs[i]) {
+            continue;
+        }
+        auto& desc = *recorded_descs[i];
+        auto resource = output_lifetimes[i];
+        resource.size = gpu_resource_size(desc);
+        // Keys are handed out per distinct descriptor, so textures that only
+        // share a hash are not taken as compatible.
+        resource.compatibility_key =
+            descriptor_keys.try_emplace(desc, descriptor_keys.size())
+                .first->second;
+        resources.push_back(resource);
+        outputs.push_back(i);
+    }
+
+    transient_plan = TransientResourcePlanner::plan(resources);
+
+    output_slots.assign(output_states.size(), no_slot);
+    slot_descs.resize(transient_plan.slot_sizes.size());
+    slot_textures.assign(transient_plan.slot_sizes.size(), nullptr);
+    slot_uses.assign(transient_plan.slot_sizes.size(), 0);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        auto slot = transient_plan.slots[i];
+        output_slots[outputs[i]] = slot;
+        slot_descs[slot] = *recorded_descs[outputs[i]];
+        ++slot_uses[slot];
+    }
+
+    texture_spans.clear();
+}
+
+// The texture a slot kept since its last resource died goes back to the
+// cache right before the producer of the next resource asks for a texture of
+// the same descriptor, which the cache then serves with it.
+void EagerNodeTreeExecutorRender::hand_over_slots(Node* node)
+{
+    for (auto&& output : node->get_outputs()) {
+        auto slot = output_slots[index_cache[output]];
+        if (slot == no_slot) {
+            continue;
+        }
+        --slot_uses[slot];
+        if (slot_textures[slot]) {
+            resource_allocator().destroy(slot_textures[slot]);
+            slot_textures[slot] = nullptr;
+        }
+    }
+}
+
+// A texture whose slot has resources left is held by the slot instead of
+// returned to the cache, so nothing else takes it in between.
+bool EagerNodeTreeExecutorRender::keep_in_slot(
+    NodeSocket* input,
+    entt::meta_any& value)
+{
+    for (auto linked : input->directly_linked_sockets) {
+        auto output = index_cache.find(linked);
+        if (output == index_cache.end() ||
+            output_slots[output->second] == no_slot) {
+            continue;
+        }
+        auto slot = output_slots[output->second];
+        auto texture = value.try_cast<nvrhi::TextureHandle>();
+        if (!slot_uses[slot] || slot_textures[slot] || !texture ||
+            !*texture || !((*texture)->getDesc() == slot_descs[slot])) {
+            return false;
+        }
+        slot_textures[slot] = *texture;
+        value.reset();
+        return true;
+    }
+    return false;
+}
+
+void EagerNodeTreeExecutorRender::release_slots()
+{
+    for (auto& texture : slot_textures) {
+        if (texture) {
+            resource_allocator().destroy(texture);
+            texture = nullptr;
+        }
+    }
+}
+
+void EagerNodeTreeExecutorRender::record_transient_outputs(Node* node)
+{
+    for (auto&& output : node->get_outputs()) {
+        auto index = index_cache[output];
+        if (!output_is_transient[index]) {
+            continue;
+        }
+
+        auto texture =
+            output_states[index].value.try_cast<nvrhi::TextureHandle>();
+        if (!texture || !*texture) {
+            recorded_descs[index] = std::nullopt;
+            continue;
+        }
+
+        auto& desc = (*texture)->getDesc();
+        recorded_descs[index] = desc;
+
+        // A texture is held from its first producer to its last consumer,
+        // also when it served several outputs through a slot.
+        auto& lifetime = output_lifetimes[index];
+        auto [span, inserted] =
+            texture_spans.try_emplace(texture->Get(), lifetime);
+        span->second.size = gpu_resource_size(desc);
+        span->second.first = std::min(span->second.first, lifetime.first);
+        span->second.last = std::max(span->second.last, lifetime.last);
+    }
+}
+
+// The peak is taken over the textures the transient outputs were actually
+// served with, a texture a slot kept between its resources counts as alive.
+void EagerNodeTreeExecutorRender::measure_transient_resources()
+{
+    std::vector<TransientResource> spans;
+    spans.reserve(texture_spans.size());
+    for (auto& span : texture_spans) {
+        spans.push_back(span.second);
+    }
+    auto peak = TransientResourcePlanner::plan(spans).peak_memory;
+
+    if (peak != transient_peak) {
+        log::info(
+            "Transient textures: %zu in %zu slots, %zu MiB peak, %zu MiB "
+            "planned, %zu MiB without aliasing",
+            spans.size(),
+            transient_plan.slot_sizes.size(),
+            peak >> 20,
+            transient_plan.aliased_memory >> 20,
+            transient_plan.unaliased_memory >> 20);
+    }
+    transient_peak = peak;
+}
+
 void EagerNodeTreeExecutorRender::finalize(NodeTree* tree)
 {
+    release_slots();
+    measure_transient_resources();
+
     for (int i = 0; i < input_states.size(); ++i) {
         if (input_states[i].is_last_used && !input_states[i].keep_alive) {
-            resource_allocator().destroy(input_states[i].value);
+            release(input_states[i].value);
             input_states[i].is_last_used = false;
         }
     }
 
     for (int i = 0; i < output_states.size(); ++i) {
         if (output_states[i].is_last_used) {
-            resource_allocator().destroy(output_states[i].value);
+            release(output_states[i].value);
             output_states[i].is_last_used = false;
         }
     }
@@ -68,6 +295,7 @@ void EagerNodeTreeExecutorRender::reset_allocator()
     for (auto&& value : storage) {
         resource_allocator().destroy(value.second);
     }
+    release_slots();
     resource_allocator().terminate();
     storage.clear();
 }
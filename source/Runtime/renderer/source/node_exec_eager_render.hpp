@@ -1,8 +1,11 @@
 #pragma once
 
+#include <optional>
 #include <set>
+#include <unordered_map>
 
 #include "hd_USTC_CG/render_global_payload.hpp"
+#include "internal/memory/TransientResourcePlanner.hpp"
 #include "node_exec_eager_render.hpp"
 #include "nodes/core/node_exec.hpp"
 #include "nodes/core/node_exec_eager.hpp"
@@ -17,15 +20,63 @@ class EagerNodeTreeExecutorRender : public EagerNodeTreeExecutor {
     void remove_storage(const std::set<std::string>::value_type& key) override;
 
    public:
+    void prepare_tree(NodeTree* tree, Node* required_node = nullptr) override;
     void finalize(NodeTree* tree) override;
 
     virtual void reset_allocator();
 
+    // The slots transient textures are served from in this execution,
+    // planned from the descriptors of the last one.
+    const TransientResourcePlan& transient_resource_plan() const
+    {
+        return transient_plan;
+    }
+
+    // Peak memory of the textures the transient outputs of the last execution
+    // were actually served with.
+    size_t transient_peak_memory() const
+    {
+        return transient_peak;
+    }
+
    private:
     ResourceAllocator& resource_allocator()
     {
         return global_payload.cast<RenderGlobalPayload&>().resource_allocator;
     }
+
+    // Hands the resource of a slot back to the allocator and empties the slot.
+    void release(entt::meta_any& value);
+
+    // Lifetimes of the outputs in the compiled order. Outputs kept in the
+    // storage or read by always required nodes are not transient.
+    void compute_output_lifetimes();
+    void plan_transient_resources();
+    void hand_over_slots(Node* node);
+    bool keep_in_slot(NodeSocket* input, entt::meta_any& value);
+    void release_slots();
+    void record_transient_outputs(Node* node);
+    void measure_transient_resources();
+
+    static constexpr size_t no_slot = SIZE_MAX;
+
+    size_t planned_compilation = 0;
+    std::vector<TransientResource> output_lifetimes;
+    std::vector<bool> output_is_transient;
+    // Descriptors of the textures of the transient outputs in the last
+    // execution, which the next plan is made from.
+    std::vector<std::optional<nvrhi::TextureDesc>> recorded_descs;
+
+    TransientResourcePlan transient_plan;
+    std::vector<size_t> output_slots;
+    std::vector<nvrhi::TextureDesc> slot_descs;
+    // The texture a slot holds between two of its resources.
+    std::vector<nvrhi::TextureHandle> slot_textures;
+    // Resources of a slot whose producer has not run yet.
+    std::vector<size_t> slot_uses;
+
+    std::unordered_map<nvrhi::ITexture*, TransientResource> texture_spans;
+    size_t transient_peak = 0;
 };
 
-USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
+USTC_CG_NAMESPACE_CLOSE_SCOPE
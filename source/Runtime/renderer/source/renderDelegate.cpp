@@ -231,6 +231,7 @@ HdResourceRegistrySharedPtr Hd_USTC_CG_RenderDelegate::GetResourceRegistry()
 
 void Hd_USTC_CG_RenderDelegate::CommitResources(HdChangeTracker* tracker)
 {
+    _renderParam->InstanceCollection->commit_resources();
 }
 
 HdRenderPassSharedPtr Hd_USTC_CG_RenderDelegate::CreateRenderPass(
@@ -20,14 +20,78 @@ Hd_USTC_CG_RenderInstanceCollection::Hd_USTC_CG_RenderInstanceCollection()
 
     vertex_pool.reserve(64 * 1024 * 3);
     index_pool.reserve(64 * 1024);
+
+    blas_command_list = RHI::get_device()->createCommandList();
 }
 
 Hd_USTC_CG_RenderInstanceCollection::~Hd_USTC_CG_RenderInstanceCollection()
 {
 }
 
+void Hd_USTC_CG_RenderInstanceCollection::flush_uploads()
+{
+    index_pool.flush();
+    vertex_pool.flush();
+    instance_pool.flush();
+    rt_instance_pool.flush();
+    mesh_pool.flush();
+    draw_indirect_pool.flush();
+}
+
+void Hd_USTC_CG_RenderInstanceCollection::queue_blas_build(
+    nvrhi::rt::IAccelStruct* blas,
+    const nvrhi::rt::AccelStructDesc& desc,
+    bool refit)
+{
+    std::lock_guard lock(blas_build_mutex);
+    blas_builds.push_back({ blas, desc, refit });
+}
+
+void Hd_USTC_CG_RenderInstanceCollection::commit_resources()
+{
+    std::vector<BLASBuild> builds;
+    {
+        std::lock_guard lock(blas_build_mutex);
+        builds.swap(blas_builds);
+    }
+
+    if (!builds.empty()) {
+        std::lock_guard lock(execution_launch_mutex);
+
+        blas_command_list->open();
+        vertex_pool.flush(blas_command_list);
+        index_pool.flush(blas_command_list);
+        for (auto& build : builds) {
+            // The pools may have been reallocated since the build was queued,
+            // the offsets stay valid.
+            for (auto& geometry : build.desc.bottomLevelGeometries) {
+                geometry.geometryData.triangles.vertexBuffer =
+                    vertex_pool.get_device_buffer();
+                geometry.geometryData.triangles.indexBuffer =
+                    index_pool.get_device_buffer();
+            }
+            auto flags = build.desc.buildFlags;
+            if (build.refit) {
+                flags = flags | nvrhi::rt::AccelStructBuildFlags::PerformUpdate;
+            }
+            blas_command_list->buildBottomLevelAccelStruct(
+                build.blas,
+                build.desc.bottomLevelGeometries.data(),
+                build.desc.bottomLevelGeometries.size(),
+                flags);
+        }
+        blas_command_list->close();
+        RHI::get_device()->executeCommandList(blas_command_list);
+
+        require_rebuild_tlas = true;
+    }
+
+    flush_uploads();
+}
+
 nvrhi::rt::IAccelStruct* Hd_USTC_CG_RenderInstanceCollection::get_tlas()
 {
+    flush_uploads();
     if (rt_instance_pool.compress()) {
         require_rebuild_tlas = true;
     }
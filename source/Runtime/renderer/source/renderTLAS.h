@@ -17,6 +17,16 @@ class HD_USTC_CG_API Hd_USTC_CG_RenderInstanceCollection {
     ~Hd_USTC_CG_RenderInstanceCollection();
 
     nvrhi::rt::IAccelStruct *get_tlas();
+    // Submits the writes recorded into the pools, one submission per pool.
+    void flush_uploads();
+
+    // Meshes queue their BLAS builds during Sync, they are all recorded in
+    // one command list together with the vertex and index uploads.
+    void queue_blas_build(
+        nvrhi::rt::IAccelStruct *blas,
+        const nvrhi::rt::AccelStructDesc &desc,
+        bool refit);
+    void commit_resources();
     DescriptorTableManager *get_descriptor_table() const
     {
         return bindlessData.descriptorTableManager.get();
@@ -45,6 +55,15 @@ class HD_USTC_CG_API Hd_USTC_CG_RenderInstanceCollection {
    private:
     nvrhi::rt::AccelStructHandle TLAS;
 
+    struct BLASBuild {
+        nvrhi::rt::AccelStructHandle blas;
+        nvrhi::rt::AccelStructDesc desc;
+        bool refit;
+    };
+    std::mutex blas_build_mutex;
+    std::vector<BLASBuild> blas_builds;
+    nvrhi::CommandListHandle blas_command_list;
+
     bool require_rebuild_tlas = true;
     void rebuild_tlas();
 };
@@ -36,6 +36,7 @@ void Hd_USTC_CG_Renderer::Render(HdRenderThread* renderThread)
 
         global_payload.resource_allocator.gc();
 
+        render_param->InstanceCollection->commit_resources();
         global_payload.InstanceCollection =
             render_param->InstanceCollection.get();
         global_payload.lens_system = render_param->lens_system;
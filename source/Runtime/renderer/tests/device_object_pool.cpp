@@ -106,6 +106,26 @@ TEST_F(MemoryPoolTest, data_io)
     EXPECT_EQ(data, read_data);
 }
 
+TEST_F(MemoryPoolTest, batched_write)
+{
+    auto handle = pool.allocate(100);
+    auto handle2 = pool.allocate(100);
+    std::vector<int> data(100);
+    for (int i = 0; i < 100; ++i) {
+        data[i] = i;
+        handle->write_data(&data[i], i);
+    }
+    handle2->write_data(data.data() + 50, 50, 50);
+    handle2->write_data(data.data(), 0, 50);
+    pool.flush();
+
+    std::vector<int> read_data(100);
+    handle->read_data(read_data.data());
+    EXPECT_EQ(data, read_data);
+    handle2->read_data(read_data.data());
+    EXPECT_EQ(data, read_data);
+}
+
 TEST_F(MemoryPoolTest, multi_threaded_allocation)
 {
     auto rng_engine = std::default_random_engine();
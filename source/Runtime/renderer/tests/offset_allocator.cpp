@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <random>
+
+#include "../source/internal/memory/DeviceMemoryPool.hpp"
+#include "../source/internal/memory/OffsetAllocator.hpp"
+
+using namespace USTC_CG;
+
+TEST(OffsetAllocator, reuse)
+{
+    OffsetAllocator allocator(100);
+
+    auto a = allocator.allocate(10);
+    auto b = allocator.allocate(20);
+    auto c = allocator.allocate(30);
+    ASSERT_TRUE(a && b && c);
+    EXPECT_EQ(a.offset, 0);
+    EXPECT_EQ(b.offset, 10);
+    EXPECT_EQ(c.offset, 30);
+
+    allocator.free(b);
+    auto d = allocator.allocate(15);
+    EXPECT_EQ(d.offset, 10);
+
+    EXPECT_FALSE(allocator.allocate(50));
+    auto e = allocator.allocate_at_end(50);
+    EXPECT_EQ(e.offset, 100);
+    EXPECT_EQ(allocator.capacity(), 150);
+}
+
+TEST(OffsetAllocator, coalescing)
+{
+    OffsetAllocator allocator(64);
+
+    std::vector<OffsetAllocator::Allocation> allocations;
+    for (int i = 0; i < 8; ++i) {
+        allocations.push_back(allocator.allocate(8));
+    }
+    EXPECT_EQ(allocator.statistics().free_block_count, 0);
+
+    // Freeing every other block leaves holes that can't be merged.
+    for (int i = 0; i < 8; i += 2) {
+        allocator.free(allocations[i]);
+    }
+    auto statistics = allocator.statistics();
+    EXPECT_EQ(statistics.free_block_count, 4);
+    EXPECT_EQ(statistics.free_size, 32);
+    EXPECT_EQ(statistics.largest_free_block, 8);
+    EXPECT_FALSE(allocator.allocate(16));
+
+    for (int i = 1; i < 8; i += 2) {
+        allocator.free(allocations[i]);
+    }
+    statistics = allocator.statistics();
+    EXPECT_EQ(statistics.free_block_count, 1);
+    EXPECT_EQ(statistics.largest_free_block, 64);
+    EXPECT_EQ(statistics.allocation_count, 0);
+
+    auto whole = allocator.allocate(64);
+    EXPECT_TRUE(whole);
+    EXPECT_EQ(whole.offset, 0);
+}
+
+TEST(OffsetAllocator, host_pool_compress)
+{
+    auto backend = std::make_unique<HostMemoryPoolBackend>();
+    auto host = backend.get();
+    DeviceMemoryPool<int> pool(std::move(backend));
+
+    auto rng_engine = std::default_random_engine();
+    auto rng = std::uniform_int_distribution(1, 100);
+    auto float_rng = std::uniform_real_distribution(0.0f, 1.0f);
+
+    std::vector<DeviceMemoryPool<int>::MemoryHandle> handles;
+    for (int i = 0; i < 1000; ++i) {
+        auto count = rng(rng_engine);
+        auto handle = pool.allocate(count);
+
+        std::vector<int> data(count);
+        std::iota(data.begin(), data.end(), i * 1000);
+        handle->write_data(data.data());
+
+        if (float_rng(rng_engine) < 0.5) {
+            handles.push_back(handle);
+        }
+    }
+
+    ASSERT_FALSE(pool.sanitize());
+    ASSERT_TRUE(pool.compress());
+    ASSERT_TRUE(pool.sanitize());
+    EXPECT_FALSE(pool.compress());
+    EXPECT_EQ(pool.statistics().free_block_count, 0);
+
+    for (auto& handle : handles) {
+        auto ints = reinterpret_cast<const int*>(host->data() + handle->offset);
+        for (size_t i = 1; i < handle->count(); ++i) {
+            ASSERT_EQ(ints[i], ints[0] + i);
+        }
+    }
+}
+
+TEST(OffsetAllocator, churn)
+{
+    auto rng_engine = std::default_random_engine();
+    auto rng = std::uniform_int_distribution(1, 4096);
+
+    constexpr int live_count = 4096;
+    constexpr int operation_count = 1 << 20;
+
+    OffsetAllocator allocator;
+    std::vector<OffsetAllocator::Allocation> live(live_count);
+    for (auto& allocation : live) {
+        allocation = allocator.allocate_at_end(rng(rng_engine));
+    }
+
+    for (int i = 0; i < operation_count; ++i) {
+        auto& allocation = live[i % live_count];
+        allocator.free(allocation);
+        auto size = rng(rng_engine);
+        allocation = allocator.allocate(size);
+        if (!allocation) {
+            allocation = allocator.allocate_at_end(size);
+        }
+    }
+
+    // Whatever is not free is held by the live allocations.
+    size_t live_size = 0;
+    for (auto& allocation : live) {
+        live_size += allocator.allocation_size(allocation);
+    }
+    auto statistics = allocator.statistics();
+    EXPECT_EQ(statistics.allocation_count, live_count);
+    EXPECT_EQ(statistics.capacity - statistics.free_size, live_size);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "../source/internal/memory/TransientResourcePlanner.hpp"
+
+using namespace USTC_CG;
+
+TEST(TransientResourcePlanner, chain)
+{
+    // A post processing chain, every pass reads the previous one's output.
+    std::vector<TransientResource> resources;
+    for (size_t i = 0; i < 8; ++i) {
+        resources.push_back({ i, i + 1, 100, 0 });
+    }
+
+    auto plan = TransientResourcePlanner::plan(resources);
+    EXPECT_EQ(plan.slot_sizes.size(), 2);
+    EXPECT_EQ(plan.peak_memory, 200);
+    EXPECT_EQ(plan.aliased_memory, 200);
+    EXPECT_EQ(plan.unaliased_memory, 800);
+
+    for (size_t i = 0; i + 1 < resources.size(); ++i) {
+        EXPECT_NE(plan.slots[i], plan.slots[i + 1]);
+    }
+}
+
+TEST(TransientResourcePlanner, incompatible_keys)
+{
+    std::vector<TransientResource> resources = {
+        { 0, 1, 100, 0 },
+        { 2, 3, 50, 1 },
+        { 4, 5, 100, 0 },
+    };
+
+    auto plan = TransientResourcePlanner::plan(resources);
+    EXPECT_EQ(plan.slots[0], plan.slots[2]);
+    EXPECT_NE(plan.slots[0], plan.slots[1]);
+    EXPECT_EQ(plan.slot_sizes.size(), 2);
+    EXPECT_EQ(plan.peak_memory, 100);
+    EXPECT_EQ(plan.aliased_memory, 150);
+}
+
+TEST(TransientResourcePlanner, overlapping)
+{
+    // Lifetimes that touch at one position can't share a slot.
+    std::vector<TransientResource> resources = {
+        { 0, 4, 10, 0 },
+        { 1, 2, 10, 0 },
+        { 2, 3, 10, 0 },
+        { 3, 6, 10, 0 },
+        { 5, 6, 10, 0 },
+    };
+
+    auto plan = TransientResourcePlanner::plan(resources);
+    EXPECT_EQ(plan.slot_sizes.size(), 3);
+    EXPECT_EQ(plan.peak_memory, 30);
+    EXPECT_EQ(plan.slots[1], plan.slots[3]);
+
+    for (size_t i = 0; i < resources.size(); ++i) {
+        for (size_t j = i + 1; j < resources.size(); ++j) {
+            bool overlap = resources[i].first <= resources[j].last &&
+                           resources[j].first <= resources[i].last;
+            if (overlap) {
+                EXPECT_NE(plan.slots[i], plan.slots[j]);
+            }
+        }
+    }
+}
+
+TEST(TransientResourcePlanner, empty)
+{
+    auto plan = TransientResourcePlanner::plan({});
+    EXPECT_TRUE(plan.slots.empty());
+    EXPECT_EQ(plan.peak_memory, 0);
+}
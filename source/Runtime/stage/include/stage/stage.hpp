@@ -2,6 +2,9 @@
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/stage.h>
 
+#include <string>
+#include <vector>
+
 #include "pxr/usd/usdGeom/cube.h"
 #include "pxr/usd/usdGeom/cylinder.h"
 #include "pxr/usd/usdGeom/mesh.h"
@@ -17,11 +20,17 @@ class WithDynamicLogicPrim;
 class STAGE_API Stage {
    public:
     Stage();
+    // Opens the stage at path, or creates it there when it does not exist.
+    explicit Stage(const std::string& path);
     ~Stage();
 
     void tick(float ellapsed_time);
     void finish_tick();
 
+    // Runs the node trees of the animatable prims at the given time,
+    // delta_time being the time elapsed since the previous evaluation.
+    void evaluate_at(pxr::UsdTimeCode time, float delta_time);
+
     pxr::UsdTimeCode get_current_time();
     void set_current_time(pxr::UsdTimeCode time);
 
@@ -69,5 +78,12 @@ class STAGE_API Stage {
 };
 
 STAGE_API std::unique_ptr<Stage> create_global_stage();
+STAGE_API std::unique_ptr<Stage> create_custom_global_stage(
+    const std::string& path);
+
+// Node configurations loaded for the trees of animatable prims, by default
+// geometry_nodes.json and basic_nodes.json. Only effective before the first
+// prim is evaluated.
+STAGE_API void set_node_configurations(std::vector<std::string> paths);
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
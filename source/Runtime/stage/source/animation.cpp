@@ -9,6 +9,10 @@ namespace animation {
 std::once_flag WithDynamicLogicPrim::init_once;
 std::shared_ptr<NodeTreeDescriptor> WithDynamicLogicPrim::node_tree_descriptor =
     nullptr;
+std::vector<std::string> WithDynamicLogicPrim::node_configurations = {
+    "geometry_nodes.json",
+    "basic_nodes.json"
+};
 
 WithDynamicLogicPrim::WithDynamicLogicPrim(const pxr::UsdPrim& prim)
     : prim(prim)
@@ -18,8 +22,9 @@ WithDynamicLogicPrim::WithDynamicLogicPrim(const pxr::UsdPrim& prim)
         std::shared_ptr<NodeSystem> node_system =
             create_dynamic_loading_system();
 
-        auto loaded = node_system->load_configuration("geometry_nodes.json");
-        loaded = node_system->load_configuration("basic_nodes.json");
+        for (auto& configuration : node_configurations) {
+            node_system->load_configuration(configuration);
+        }
         node_tree_descriptor = node_system->node_tree_descriptor();
     });
 
@@ -65,7 +70,14 @@ WithDynamicLogicPrim& WithDynamicLogicPrim::operator=(
     return *this;
 }
 
-void WithDynamicLogicPrim::update(float delta_time) const
+void WithDynamicLogicPrim::set_node_configurations(
+    std::vector<std::string> paths)
+{
+    node_configurations = std::move(paths);
+}
+
+void WithDynamicLogicPrim::update(float delta_time, pxr::UsdTimeCode time)
+    const
 {
     auto json_path = prim.GetAttribute(pxr::TfToken("node_json"));
     if (!json_path) {
@@ -88,6 +100,7 @@ void WithDynamicLogicPrim::update(float delta_time) const
 
     auto& payload = node_tree_executor->get_global_payload<GeomPayload&>();
     payload.delta_time = delta_time;
+    payload.current_time = time;
     payload.stage = prim.GetStage();
     payload.prim_path = prim.GetPath();
     payload.has_simulation = false;
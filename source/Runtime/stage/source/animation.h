@@ -11,7 +11,7 @@ namespace animation {
 class WithDynamicLogic {
    public:
     virtual ~WithDynamicLogic() = default;
-    virtual void update(float delta_time) const = 0;
+    virtual void update(float delta_time, pxr::UsdTimeCode time) const = 0;
 };
 
 class WithDynamicLogicPrim : public WithDynamicLogic {
@@ -22,9 +22,11 @@ class WithDynamicLogicPrim : public WithDynamicLogic {
     WithDynamicLogicPrim(const WithDynamicLogicPrim& prim);
     WithDynamicLogicPrim& operator=(const WithDynamicLogicPrim& prim);
 
-    void update(float delta_time) const override;
+    void update(float delta_time, pxr::UsdTimeCode time) const override;
     static bool is_animatable(const pxr::UsdPrim& prim);
 
+    static void set_node_configurations(std::vector<std::string> paths);
+
    private:
     mutable bool simulation_begun = false;
 
@@ -36,6 +38,7 @@ class WithDynamicLogicPrim : public WithDynamicLogic {
 
     static std::shared_ptr<NodeTreeDescriptor> node_tree_descriptor;
     static std::once_flag init_once;
+    static std::vector<std::string> node_configurations;
 };
 
 }  // namespace animation
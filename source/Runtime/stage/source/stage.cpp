@@ -15,15 +15,19 @@
 USTC_CG_NAMESPACE_OPEN_SCOPE
 #define SAVE_ALL_THE_TIME 0
 
-Stage::Stage()
+Stage::Stage() : Stage("../../Assets/stage.usdc")
 {
-    // if stage.usda exists, load it
-    stage = pxr::UsdStage::Open("../../Assets/stage.usdc");
+}
+
+Stage::Stage(const std::string& path)
+{
+    // if the stage exists, load it
+    stage = pxr::UsdStage::Open(path);
     if (stage) {
         return;
     }
 
-    stage = pxr::UsdStage::CreateNew("../../Assets/stage.usdc");
+    stage = pxr::UsdStage::CreateNew(path);
     stage->SetMetadata(pxr::UsdGeomTokens->metersPerUnit, 1.0);
     stage->SetMetadata(pxr::UsdGeomTokens->upAxis, pxr::TfToken("Z"));
 }
@@ -39,7 +43,12 @@ void Stage::tick(float ellapsed_time)
 {
     auto current = current_time_code.GetValue();
     current += ellapsed_time;
-    current_time_code = pxr::UsdTimeCode(current);
+    evaluate_at(pxr::UsdTimeCode(current), ellapsed_time);
+}
+
+void Stage::evaluate_at(pxr::UsdTimeCode time, float delta_time)
+{
+    current_time_code = time;
 
     // for each prim, if it is animatable, update it
     for (auto&& prim : stage->Traverse()) {
@@ -50,7 +59,8 @@ void Stage::tick(float ellapsed_time)
                     std::move(animation::WithDynamicLogicPrim(prim));
             }
 
-            animatable_prims[prim.GetPath()].update(ellapsed_time);
+            animatable_prims[prim.GetPath()].update(
+                delta_time, current_time_code);
         }
     }
 }
@@ -218,4 +228,14 @@ std::unique_ptr<Stage> create_global_stage()
     return std::make_unique<Stage>();
 }
 
+std::unique_ptr<Stage> create_custom_global_stage(const std::string& path)
+{
+    return std::make_unique<Stage>(path);
+}
+
+void set_node_configurations(std::vector<std::string> paths)
+{
+    animation::WithDynamicLogicPrim::set_node_configurations(std::move(paths));
+}
+
 USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,192 @@
+// Evaluates the node trees of the animatable prims of a stage over a frame
+// range, without a window, RHI or Hydra, and writes what they author to an
+// output layer.
+//
+//   USTC_CG_batch <stage> [--output <layer>] [--start <frame>]
+//                 [--end <frame>] [--fps <fps>] [--config <json>]...
+//
+// The output layer is added as a sublayer of the session layer and made the
+// edit target, so the input stage is left untouched. By default it is written
+// next to the stage as <stage>.batch.usda. Frames are time codes, and the
+// trees advance by 1 / fps seconds per frame.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "GCore/GOP.h"
+#include "Logger/Logger.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/editTarget.h"
+#include "pxr/usd/usd/stage.h"
+#include "stage/stage.hpp"
+
+using namespace USTC_CG;
+
+struct BatchOptions {
+    std::string stage_path;
+    std::string output_path;
+    std::vector<std::string> configurations;
+    double start = 0;
+    double end = 0;
+    bool has_start = false;
+    bool has_end = false;
+    double fps = 24;
+};
+
+static void print_usage()
+{
+    std::printf(
+        "Usage: USTC_CG_batch <stage> [--output <layer>] [--start <frame>]\n"
+        "                     [--end <frame>] [--fps <fps>]"
+        " [--config <json>]...\n");
+}
+
+static bool parse_options(int argc, char* argv[], BatchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--output" && has_value) {
+            options.output_path = argv[++i];
+        }
+        else if (arg == "--start" && has_value) {
+            options.start = std::atof(argv[++i]);
+            options.has_start = true;
+        }
+        else if (arg == "--end" && has_value) {
+            options.end = std::atof(argv[++i]);
+            options.has_end = true;
+        }
+        else if (arg == "--fps" && has_value) {
+            options.fps = std::atof(argv[++i]);
+        }
+        else if (arg == "--config" && has_value) {
+            options.configurations.push_back(argv[++i]);
+        }
+        else if (options.stage_path.empty() && arg.rfind("--", 0) != 0) {
+            options.stage_path = arg;
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.stage_path.empty() && options.fps > 0;
+}
+
+static pxr::SdfLayerRefPtr create_output_layer(const std::string& path)
+{
+    auto layer = pxr::SdfLayer::FindOrOpen(path);
+    if (layer) {
+        layer->Clear();
+        return layer;
+    }
+    return pxr::SdfLayer::CreateNew(path);
+}
+
+int main(int argc, char* argv[])
+{
+    log::ConsoleApplicationMode();
+
+    BatchOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+    if (!std::filesystem::exists(options.stage_path)) {
+        log::error("Stage %s does not exist.", options.stage_path.c_str());
+        return 1;
+    }
+    if (options.output_path.empty()) {
+        options.output_path = std::filesystem::path(options.stage_path)
+                                  .replace_extension(".batch.usda")
+                                  .string();
+    }
+    if (!options.configurations.empty()) {
+        set_node_configurations(options.configurations);
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto milliseconds = [](clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    auto load_begin = clock::now();
+    auto stage = create_custom_global_stage(options.stage_path);
+    auto usd_stage = stage->get_usd_stage();
+    // Geometry components author their scratch prims to this stage.
+    init(stage.get());
+
+    auto output = create_output_layer(options.output_path);
+    if (!output) {
+        log::error("Cannot create %s.", options.output_path.c_str());
+        return 1;
+    }
+    usd_stage->GetSessionLayer()->InsertSubLayerPath(output->GetIdentifier());
+    usd_stage->SetEditTarget(pxr::UsdEditTarget(output));
+
+    if (!options.has_start) {
+        options.start = usd_stage->GetStartTimeCode();
+    }
+    if (!options.has_end) {
+        options.end = std::max(options.start, usd_stage->GetEndTimeCode());
+    }
+    output->SetStartTimeCode(options.start);
+    output->SetEndTimeCode(options.end);
+    output->SetFramesPerSecond(options.fps);
+    output->SetTimeCodesPerSecond(options.fps);
+
+    std::printf(
+        "Loaded %s in %.2f ms\n",
+        options.stage_path.c_str(),
+        milliseconds(clock::now() - load_begin));
+
+    float delta_time = float(1 / options.fps);
+    std::vector<double> frame_times;
+    for (double frame = options.start; frame <= options.end; frame += 1) {
+        auto frame_begin = clock::now();
+        stage->evaluate_at(pxr::UsdTimeCode(frame), delta_time);
+        stage->finish_tick();
+        frame_times.push_back(milliseconds(clock::now() - frame_begin));
+        std::printf("Frame %g: %.2f ms\n", frame, frame_times.back());
+    }
+
+    // The scratch prims of the geometry components are authored through the
+    // edit target as well. They are not results, so they are not written.
+    auto scratch_buffer =
+        output->GetPrimAtPath(pxr::SdfPath("/scratch_buffer"));
+    if (scratch_buffer) {
+        output->RemoveRootPrim(scratch_buffer);
+    }
+
+    auto save_begin = clock::now();
+    bool saved = output->Save();
+    double save_time = milliseconds(clock::now() - save_begin);
+
+    if (!frame_times.empty()) {
+        double total = 0;
+        for (double time : frame_times) {
+            total += time;
+        }
+        std::printf(
+            "%zu frames in %.2f ms, %.2f ms on average, %.2f ms at most\n",
+            frame_times.size(),
+            total,
+            total / frame_times.size(),
+            *std::max_element(frame_times.begin(), frame_times.end()));
+    }
+    if (!saved) {
+        log::error("Cannot save %s.", options.output_path.c_str());
+        return 1;
+    }
+    std::printf(
+        "Wrote %s in %.2f ms\n", options.output_path.c_str(), save_time);
+
+    stage.reset();
+    init(nullptr);
+    return 0;
+}